@@ -21,6 +21,9 @@
 #include "xrt.h"
 #include "ert.h"
 
+#include <atomic>
+#include <cstdint>
+
 /**
  * class command - Command API expected by sws and kds command monitor
  */
@@ -29,6 +32,24 @@ namespace xrt_core {
 class command : public std::enable_shared_from_this<command>
 {
 public:
+  /**
+   * struct timestamps - command life cycle times
+   *
+   * @submit: command was submitted by host
+   * @start: command was started on a CU (sws) or handed to the
+   *   device scheduler (kds)
+   * @complete: command completion was observed by the scheduler
+   *
+   * Times are xrt_core::time_ns() and are recorded only when command
+   * latency instrumentation is enabled, 0 means not recorded.
+   */
+  struct timestamps
+  {
+    std::atomic<uint64_t> submit {0};
+    std::atomic<uint64_t> start {0};
+    std::atomic<uint64_t> complete {0};
+  };
+
   /**
    * command() - construct a command object
    */
@@ -77,8 +98,37 @@ public:
   virtual void
   notify(ert_cmd_state) = 0;
 
+  /**
+   * get_next() - intrusive link used by command scheduler queues
+   *
+   * A command is in at most one scheduler queue at a time, the link
+   * allows the command to be queued without allocating a node.
+   */
+  command*
+  get_next() const
+  {
+    return m_next;
+  }
+
+  void
+  set_next(command* cmd)
+  {
+    m_next = cmd;
+  }
+
+  /**
+   * get_timestamps() - life cycle times for latency instrumentation
+   */
+  timestamps&
+  get_timestamps()
+  {
+    return m_timestamps;
+  }
+
 private:
   unsigned long m_uid;
+  command* m_next = nullptr;
+  timestamps m_timestamps;
 };
 
 
@@ -0,0 +1,177 @@
+/**
+ * Copyright (C) 2021 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+#define XRT_CORE_COMMON_SOURCE // in same dll as core_common
+
+#include "command_latency.h"
+#include "command.h"
+#include "core/common/config_reader.h"
+#include "core/common/device.h"
+#include "core/common/message.h"
+#include "core/common/time.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <utility>
+
+namespace {
+
+using key_type = std::pair<unsigned int, std::string>; // device id, kernel name
+
+// class registry - histograms of all kernels and devices
+//
+// Histograms are created when a kernel is constructed and are
+// never removed, so recording need not synchronize with the
+// registry.  The histograms are reported when the process exits.
+class registry
+{
+  std::mutex m_mutex;
+  std::map<key_type, std::unique_ptr<xrt_core::command_latency::histograms>> m_histograms;
+
+  xrt_core::command_latency::histograms*
+  get_or_create(const key_type& key)
+  {
+    auto& hist = m_histograms[key];
+    if (!hist)
+      hist = std::make_unique<xrt_core::command_latency::histograms>();
+    return hist.get();
+  }
+
+public:
+  ~registry()
+  {
+    try {
+      auto msg = report();
+      if (!msg.empty())
+        xrt_core::message::send(xrt_core::message::severity_level::info, "XRT", msg);
+    }
+    catch (...) {
+    }
+  }
+
+  xrt_core::command_latency::histograms*
+  get(unsigned int devid, const std::string& kname)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto dev = get_or_create({devid, ""});
+    auto hist = get_or_create({devid, kname});
+    hist->device = dev;
+    return hist;
+  }
+
+  std::string
+  report()
+  {
+    static const char* stage_names[] = {
+      "submit->start", "start->complete", "complete->notify"
+    };
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    std::ostringstream ostr;
+    for (const auto& entry : m_histograms) {
+      auto& hist = entry.second;
+      if (!hist->stages[0].count())
+        continue;
+
+      if (ostr.tellp() == 0)
+        ostr << "Command latency (ns)\n";
+      ostr << "device[" << entry.first.first << "] ";
+      ostr << (entry.first.second.empty() ? "all kernels" : "kernel(" + entry.first.second + ")") << "\n";
+      for (unsigned int idx = 0; idx < xrt_core::command_latency::num_stages; ++idx) {
+        auto& stage = hist->stages[idx];
+        ostr << "  " << stage_names[idx]
+             << " count(" << stage.count() << ")"
+             << " mean(" << stage.mean() << ")"
+             << " p50(" << stage.percentile(50) << ")"
+             << " p90(" << stage.percentile(90) << ")"
+             << " p99(" << stage.percentile(99) << ")"
+             << " p99.9(" << stage.percentile(99.9) << ")"
+             << " max(" << stage.max() << ")\n";
+      }
+    }
+    return ostr.str();
+  }
+};
+
+static registry&
+get_registry()
+{
+  static registry reg;
+  return reg;
+}
+
+static void
+record(xrt_core::command_latency::histograms* hist, uint64_t submit, uint64_t start, uint64_t complete, uint64_t notify)
+{
+  using namespace xrt_core::command_latency;
+  hist->stages[submit_to_start].record(start - submit);
+  hist->stages[start_to_complete].record(complete - start);
+  hist->stages[complete_to_notify].record(notify - complete);
+}
+
+} // namespace
+
+namespace xrt_core { namespace command_latency {
+
+bool
+enabled()
+{
+  static bool value = xrt_core::config::get_command_latency();
+  return value;
+}
+
+histograms*
+get(const xrt_core::device* device, const std::string& kname)
+{
+  if (!enabled())
+    return nullptr;
+
+  return get_registry().get(device->get_device_id(), kname);
+}
+
+void
+record(histograms* hist, command* cmd)
+{
+  auto& ts = cmd->get_timestamps();
+  auto submit = ts.submit.load(std::memory_order_relaxed);
+  if (!hist || !submit)
+    return;
+
+  // Clamp stages that were not observed, or were observed out of
+  // order by different threads, to zero length
+  auto notify = time_ns();
+  auto complete = ts.complete.load(std::memory_order_relaxed);
+  if (!complete || complete > notify)
+    complete = notify;
+  auto start = ts.start.load(std::memory_order_relaxed);
+  if (!start || start > complete)
+    start = complete;
+  if (submit > start)
+    submit = start;
+
+  ::record(hist, submit, start, complete, notify);
+  if (hist->device)
+    ::record(hist->device, submit, start, complete, notify);
+}
+
+std::string
+report()
+{
+  return get_registry().report();
+}
+
+}} // command_latency, xrt_core
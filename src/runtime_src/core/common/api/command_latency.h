@@ -0,0 +1,102 @@
+/**
+ * Copyright (C) 2021 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef xrt_core_command_latency_h_
+#define xrt_core_command_latency_h_
+
+#include "core/common/config.h"
+#include "core/common/latency_histogram.h"
+#include <string>
+
+namespace xrt_core {
+
+class device;
+class command;
+
+/**
+ * Command latency instrumentation
+ *
+ * Commands record their life cycle times (see command::timestamps)
+ * and upon completion the stage latencies are added to histograms
+ * of the command's kernel and of the kernel's device.
+ *
+ * Instrumentation is enabled with Runtime.command_latency in xrt.ini,
+ * the histograms are reported when the process exits and can be
+ * reported at any time with report().
+ */
+namespace command_latency {
+
+enum stage : unsigned int
+{
+  submit_to_start,
+  start_to_complete,
+  complete_to_notify,
+  num_stages
+};
+
+/**
+ * struct histograms - latency histograms for each command stage
+ *
+ * @device: histograms of the device for kernel histograms, nullptr
+ *  for device histograms
+ */
+struct histograms
+{
+  latency_histogram stages[num_stages];
+  histograms* device = nullptr;
+};
+
+/**
+ * enabled() - check if command latency instrumentation is enabled
+ */
+XRT_CORE_COMMON_EXPORT
+bool
+enabled();
+
+/**
+ * get() - get histograms for kernel on device
+ *
+ * @device: device on which the kernel executes
+ * @kname: name of the kernel
+ * Return: histograms that live until the process exits, or nullptr
+ *  if latency instrumentation is disabled
+ */
+XRT_CORE_COMMON_EXPORT
+histograms*
+get(const xrt_core::device* device, const std::string& kname);
+
+/**
+ * record() - record latencies of a completed command
+ *
+ * @hist: histograms of the command's kernel
+ * @cmd: the completed command
+ *
+ * Host notify is the time of this call.
+ */
+XRT_CORE_COMMON_EXPORT
+void
+record(histograms* hist, command* cmd);
+
+/**
+ * report() - get current latency histograms as formatted text
+ */
+XRT_CORE_COMMON_EXPORT
+std::string
+report();
+
+}} // command_latency, xrt_core
+
+#endif
@@ -0,0 +1,134 @@
+/**
+ * Copyright (C) 2021 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef xrt_core_cu_dispatch_h_
+#define xrt_core_cu_dispatch_h_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace xrt_core { namespace sws {
+
+/**
+ * CU dispatch policy of the software scheduler
+ *
+ * Selects which of the ready CUs of a command is started.
+ *
+ * @first: first ready CU in index order
+ * @round_robin: first ready CU after the most recently started CU
+ * @least_outstanding: ready CU with fewest running commands
+ * @memory_affinity: ready CU whose connectivity covers the most
+ *   buffer arguments of the command, ties resolved as least_outstanding
+ *
+ * All but @first search the CUs starting after the most recently
+ * started CU, so that ties do not favor low CU indices.
+ */
+enum class cu_policy { first, round_robin, least_outstanding, memory_affinity };
+
+/**
+ * struct arg_banks - memory banks connected to a CU buffer argument
+ *
+ * @regidx: index of 64 bit argument address in command register map
+ * @banks: base address and size of each connected bank
+ */
+struct arg_banks
+{
+  uint32_t regidx;
+  std::vector<std::pair<uint64_t, uint64_t>> banks;
+};
+
+// Per CU argument connectivity, indexed by CU index
+using cu_arg_banks = std::vector<std::vector<arg_banks>>;
+
+/**
+ * arg_affinity() - Number of buffer arguments located in a memory bank
+ *   connected to the CU
+ *
+ * @args: argument connectivity of the CU
+ * @regmap: command register map holding the argument addresses
+ * @size: number of words in @regmap
+ */
+inline size_t
+arg_affinity(const std::vector<arg_banks>& args, const uint32_t* regmap, size_t size)
+{
+  size_t count = 0;
+  for (auto& arg : args) {
+    if (arg.regidx + 1 >= size)
+      continue;
+    auto addr = uint64_t(regmap[arg.regidx]) | (uint64_t(regmap[arg.regidx + 1]) << 32);
+    for (auto& bank : arg.banks) {
+      if (addr >= bank.first && addr - bank.first < bank.second) {
+        ++count;
+        break;
+      }
+    }
+  }
+  return count;
+}
+
+/**
+ * select_cu() - Select a ready CU per dispatch policy
+ *
+ * @policy: dispatch policy
+ * @cus: CUs the command can be started on
+ * @next: CU index where the search starts, ignored by cu_policy::first
+ * @ready: callable, true if the CU with index is ready
+ * @running: callable, number of commands running on the CU with index
+ * @affinity: callable, arg_affinity() of the command for the CU with
+ *   index, called by cu_policy::memory_affinity only
+ * Return: Index of selected CU, Bitmap::npos if no CU is ready
+ */
+template <typename Bitmap, typename Ready, typename Running, typename Affinity>
+inline size_t
+select_cu(cu_policy policy, const Bitmap& cus, size_t next,
+          Ready&& ready, Running&& running, Affinity&& affinity)
+{
+  if (policy == cu_policy::first)
+    return cus.find_if(ready);
+
+  size_t best = Bitmap::npos;
+  size_t best_affinity = 0;
+  size_t best_running = 0;
+  auto first = cus.find_next_wrap(next);
+  for (auto cuidx = first; cuidx != Bitmap::npos; ) {
+    if (ready(cuidx)) {
+      if (policy == cu_policy::round_robin)
+        return cuidx;
+
+      size_t aff = (policy == cu_policy::memory_affinity) ? affinity(cuidx) : 0;
+      size_t run = running(cuidx);
+      if (best == Bitmap::npos || aff > best_affinity
+          || (aff == best_affinity && run < best_running)) {
+        best = cuidx;
+        best_affinity = aff;
+        best_running = run;
+      }
+
+      if (policy == cu_policy::least_outstanding && !run)
+        break;
+    }
+    cuidx = cus.find_next_wrap(cuidx + 1);
+    if (cuidx == first)
+      break;
+  }
+  return best;
+}
+
+}} // sws, xrt_core
+
+#endif
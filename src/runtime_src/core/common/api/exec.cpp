@@ -93,6 +93,19 @@ managed_start(command* cmd)
     sws::managed_start(cmd);
 }
 
+// Schedule a batch of commands for execution on either sws or kds.
+void
+managed_start(const std::vector<command*>& cmds)
+{
+  if (cmds.empty())
+    return;
+
+  if (kds_enabled())
+    kds::managed_start(cmds);
+  else
+    sws::managed_start(cmds);
+}
+
 // Schedule a command for execution on either sws or kds. Use poll
 // execution, meaning host must explicitly call unmanaged_wait() to
 // wait for command completion
@@ -18,6 +18,7 @@
 #define xrt_core_exec_h_
 
 #include "core/common/config.h"
+#include <cstdint>
 #include <vector>
 #include <memory>
 
@@ -34,6 +35,9 @@ namespace sws {
 void
 managed_start(command* cmd);
 
+void
+managed_start(const std::vector<command*>& cmds);
+
 inline void
 unmanaged_start(command* cmd)
 {
@@ -52,6 +56,27 @@ stop();
 void
 init(xrt_core::device* device);
 
+// struct cu_stats - dispatch statistics of a CU
+//
+// @started: commands started on the CU
+// @completed: commands completed by the CU
+// @busy_ns: time the CU has had commands running, not including
+//   the period it is currently busy
+struct cu_stats
+{
+  uint64_t started = 0;
+  uint64_t completed = 0;
+  uint64_t busy_ns = 0;
+};
+
+// Get dispatch statistics of each CU of a device, indexed by CU
+// index.  Empty if sws is not initialized for the device.  The
+// statistics are read while the scheduler runs, so counts of
+// different CUs are not a consistent snapshot.
+XRT_CORE_COMMON_EXPORT
+std::vector<cu_stats>
+get_cu_stats(const xrt_core::device* device);
+
 } // sws
 
 /**
@@ -62,6 +87,9 @@ namespace kds {
 void
 managed_start(command* cmd);
 
+void
+managed_start(const std::vector<command*>& cmds);
+
 void
 unmanaged_start(command* cmd);
 
@@ -88,6 +116,17 @@ namespace exec {
 void
 managed_start(command* cmd);
 
+// Schedule a batch of commands for execution on either sws or kds.
+// All commands must be associated with the same device.  The batch
+// is submitted with one call to the scheduler and the execution
+// monitor is kicked once for all commands.  Each command is notified
+// of completion as with managed_start() of a single command.  If
+// submission fails, commands that did not reach the device are
+// notified with ERT_CMD_STATE_ABORT once the scheduler no longer
+// references them, and the error is rethrown.
+void
+managed_start(const std::vector<command*>& cmds);
+
 // Schedule a command for execution on either sws or kds. Use poll
 // execution, meaning host must explicitly call unmanaged_wait() to
 // wait for command completion.  This function starts / schedules
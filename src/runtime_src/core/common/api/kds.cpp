@@ -18,14 +18,18 @@
 #include "exec.h"
 #include "ert.h"
 #include "command.h"
+#include "command_latency.h"
 #include "core/common/device.h"
 #include "core/common/thread.h"
 #include "core/common/debug.h"
+#include "core/common/time.h"
 
 #include <memory>
 #include <cstring>
 #include <cerrno>
 #include <algorithm>
+#include <atomic>
+#include <cassert>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -68,33 +72,185 @@ notify_host(xrt_core::command* cmd)
   notify_host(cmd, get_command_state(cmd));
 }
 
-  
+// Latency instrumentation, record time right before a command is
+// handed to the device scheduler or when its completion was observed.  The
+// time is passed in since one exec_wait covers many commands.
+inline uint64_t
+latency_time_ns()
+{
+  return xrt_core::command_latency::enabled() ? xrt_core::time_ns() : 0;
+}
+
+inline void
+stamp_start(xrt_core::command* cmd, uint64_t ns)
+{
+  if (ns)
+    cmd->get_timestamps().start.store(ns, std::memory_order_relaxed);
+}
+
+inline void
+stamp_complete(xrt_core::command* cmd, uint64_t ns)
+{
+  if (ns)
+    cmd->get_timestamps().complete.store(ns, std::memory_order_relaxed);
+}
+
+
+// class submit_queue - lock free multiple producer single consumer queue
+//
+// Producers push commands onto the queue using the intrusive link of
+// the command, the single consumer drains all queued commands at
+// once.  Push is a compare-and-swap of the queue head, drain is an
+// atomic exchange of the head followed by reversal of the drained
+// list to restore submission order.
+//
+// No memory is allocated by the queue, a command can be in at most
+// one queue at a time.
+class submit_queue
+{
+  std::atomic<xrt_core::command*> m_head {nullptr};
+
+public:
+  // Push a single command
+  void
+  push(xrt_core::command* cmd)
+  {
+    push(cmd, cmd);
+  }
+
+  // Push a chain of commands linked from last to first, e.g. first
+  // is the oldest command in the chain, last the newest
+  void
+  push(xrt_core::command* first, xrt_core::command* last)
+  {
+    auto head = m_head.load(std::memory_order_relaxed);
+    do {
+      first->set_next(head);
+    } while (!m_head.compare_exchange_weak(head, last));
+  }
+
+  bool
+  empty() const
+  {
+    return m_head.load() == nullptr;
+  }
+
+  // Drain all queued commands in submission order into argument
+  // vector
+  void
+  drain(command_queue_type& cmds)
+  {
+    auto cmd = m_head.exchange(nullptr);
+    if (!cmd)
+      return;
+
+    auto size = cmds.size();
+    for (; cmd; cmd = cmd->get_next())
+      cmds.push_back(cmd);
+    std::reverse(cmds.begin() + size, cmds.end());
+  }
+};
+
 // class kds_device - kds book keeping data for command scheduling
 //
 // @device: The core device used for shim level calls
 // @exec_wait_mutex: Synchronize acces to exec_wait
-// @work_mutex: Syncrhonize monitor thread with launched commands
-// @work_cond: Kick off monitor thread when there are new commands
+// @work_mutex: Synchronize idle monitor thread with launched commands
+// @work_cond: Kick off idle monitor thread when there are new commands
+// @submitted_cmds: Lock free queue of launched commands
+// @abandoned_cmds: Commands that failed submission after being queued
+// @abandoned_count: Number of abandoned commands not yet purged
 // @monitor_thread: Thread for asynchronous monitoring of command execution
 // @exec_wait_call_count:  Count of number of calls to exec wait
+// @idle: Monitor thread is waiting for new commands
 // @stop: Stop the monitor thread
 //
 // This class is per xrt_core::device. The class constructor starts a
 // command monitor thread that manages command execution.  It also
 // provides a thread safe interface to shim level exec_wait which can
 // be called explicitly to wait for command completion.
+//
+// Launching a command does not take any lock unless the monitor
+// thread is idle and must be woken up.
 class kds_device
 {
   xrt_core::device* device;
   std::mutex exec_wait_mutex;
   std::mutex work_mutex;
   std::condition_variable work_cond;
-  command_queue_type submitted_cmds;
+  submit_queue submitted_cmds;
+  command_queue_type abandoned_cmds;
+  std::atomic<size_t> abandoned_count {0};
   uint64_t exec_wait_call_count = 0;
-  bool stop = false;
+  std::atomic<bool> idle {false};
+  std::atomic<bool> stop {false};
 
   // thread can be constructed only after data members are initialized
-  std::thread monitor_thread;  
+  std::thread monitor_thread;
+
+  // Kick the monitor thread if it is waiting for work.  The launching
+  // thread has pushed to submitted_cmds prior to checking idle, and
+  // the monitor thread sets idle prior to checking submitted_cmds, so
+  // at least one of them sees the other.
+  void
+  wake_monitor()
+  {
+    if (!idle)
+      return;
+
+    std::lock_guard<std::mutex> lk(work_mutex);
+    work_cond.notify_one();
+  }
+
+  // Record commands that were queued for monitoring, but failed
+  // submission.  The monitor thread purges these commands and
+  // notifies them as aborted.  Until then the commands are not done
+  // and cannot be relaunched while still linked in submitted_cmds.
+  //
+  // The command state cannot tell if a command was submitted, the
+  // driver may have reset the packet state, so the caller must pass
+  // only commands that never reached the device.
+  template <typename Iterator>
+  void
+  abandon(Iterator first, Iterator last)
+  {
+    std::lock_guard<std::mutex> lk(work_mutex);
+    abandoned_cmds.insert(abandoned_cmds.end(), first, last);
+    abandoned_count = abandoned_cmds.size();
+    work_cond.notify_one();
+  }
+
+  // Remove abandoned commands from running commands and notify them
+  // as aborted.  An abandoned command may not yet have been drained
+  // from submitted_cmds, in which case it is retained and purged in
+  // a later iteration.
+  void
+  purge_abandoned(command_queue_type& running_cmds)
+  {
+    command_queue_type purged;
+    {
+      std::lock_guard<std::mutex> lk(work_mutex);
+      auto itr = std::remove_if(abandoned_cmds.begin(), abandoned_cmds.end(),
+                                [&running_cmds, &purged](xrt_core::command* cmd) {
+                                  auto ritr = std::find(running_cmds.begin(), running_cmds.end(), cmd);
+                                  if (ritr == running_cmds.end())
+                                    return false;
+                                  running_cmds.erase(ritr);
+                                  purged.push_back(cmd);
+                                  return true;
+                                });
+      abandoned_cmds.erase(itr, abandoned_cmds.end());
+      abandoned_count = abandoned_cmds.size();
+    }
+
+    // Lock must not be held while notifying, callbacks may launch
+    // new commands.  The command never reached the device so its
+    // packet can be updated here.
+    for (auto cmd : purged) {
+      cmd->get_ert_packet()->state = ERT_CMD_STATE_ABORT;
+      notify_host(cmd, ERT_CMD_STATE_ABORT);
+    }
+  }
 
   // monitor_loop() - Manage running commands and notify on completion
   //
@@ -106,57 +262,65 @@ class kds_device
   void
   monitor_loop()
   {
-    std::vector<xrt_core::command*> busy_cmds;
-    std::vector<xrt_core::command*> running_cmds;
+    command_queue_type running_cmds;
 
     while (1) {
 
-      // Larger wait synchronized with launch()
-      {
+      // Larger wait synchronized with launch() when there is no work
+      if (running_cmds.empty()) {
         std::unique_lock<std::mutex> lk(work_mutex);
-        while (!stop && running_cmds.empty() && submitted_cmds.empty())
+        idle = true;
+        while (!stop && submitted_cmds.empty() && !abandoned_count)
           work_cond.wait(lk);
+        idle = false;
       }
 
       if (stop)
         return;
 
+      // Purge abandoned commands before waiting, they will never
+      // complete and exec_wait could otherwise block indefinitely.
+      if (abandoned_count) {
+        submitted_cmds.drain(running_cmds);
+        purge_abandoned(running_cmds);
+        if (running_cmds.empty())
+          continue;
+      }
+
       // Finer wait
       exec_wait();
 
       // Drain submitted commands.  It is important that this comes
-      // after exec_wait and is synchronized with launch() that added
-      // to submitted_cmds.
+      // after exec_wait.
       //
       // Scenario if before exec_wait is that a new command was added
-      // to submitted_cmds and exec_buf immediately after the critical
-      // section above and that the command completion happens in the
-      // exec_wait call. If submitted_cmds was drained, in for example
-      // above critical section, before the call to exec_wait it would
-      // not be in running_cmds and would not be notified of
-      // completion.
+      // to submitted_cmds and exec_buf immediately after the drain
+      // and that the command completion happens in the exec_wait
+      // call. If submitted_cmds was drained before the call to
+      // exec_wait it would not be in running_cmds and would not be
+      // notified of completion.
       //
       // The sequence is very important.  It must be guaranteed that
       // exec_wait will never return for a command that is not yet
       // in either running_cmds or submitted_cmds.
-      {
-        std::lock_guard<std::mutex> lk(work_mutex);
-        std::copy(submitted_cmds.begin(), submitted_cmds.end(), std::back_inserter(running_cmds));
-        submitted_cmds.clear();
-      }
-      // At this point running_cmds is guaranteed to contain the
-      // command(s) for which exec_wait returned.
+      submitted_cmds.drain(running_cmds);
+      auto complete_ns = latency_time_ns();
 
-      // Preserve order of processing
-      for (auto cmd : running_cmds) {
-        if (completed(cmd))
+      // At this point running_cmds is guaranteed to contain the
+      // command(s) for which exec_wait returned.  The shim does not
+      // report which commands completed, so running commands must be
+      // checked, but this is done in place preserving order.
+      size_t busy = 0;
+      for (size_t idx = 0; idx < running_cmds.size(); ++idx) {
+        auto cmd = running_cmds[idx];
+        if (completed(cmd)) {
+          stamp_complete(cmd, complete_ns);
           notify_host(cmd);
+        }
         else
-          busy_cmds.push_back(cmd);
+          running_cmds[busy++] = cmd;
       }
-
-      running_cmds.swap(busy_cmds);
-      busy_cmds.clear();
+      running_cmds.resize(busy);
     } // while (1)
   }
 
@@ -188,7 +352,10 @@ public:
   // Destructor stops and joins monitor thread
   ~kds_device()
   {
-    stop = true;
+    {
+      std::lock_guard<std::mutex> lk(work_mutex);
+      stop = true;
+    }
     work_cond.notify_one();
     monitor_thread.join();
   }
@@ -222,7 +389,12 @@ public:
       return;
     }
 
-    while (device->exec_wait(1000)==0) {}
+    // Return on timeout if there are abandoned commands or monitor
+    // is stopping, the caller re-checks its own commands.
+    while (device->exec_wait(1000)==0) {
+      if (abandoned_count || stop)
+        break;
+    }
 
     // synchronize this thread with total call count
     thread_exec_wait_call_count = ++exec_wait_call_count;
@@ -237,6 +409,7 @@ public:
     auto pkt = cmd->get_ert_packet();
     while (pkt->state < ERT_CMD_STATE_COMPLETED)
       exec_wait();
+    stamp_complete(const_cast<xrt_core::command*>(cmd), latency_time_ns());
 
     // notify_host is not strictly necessary for unmanaged
     // command execution but provides a central place to update
@@ -252,6 +425,9 @@ public:
   void
   exec_buf(xrt_core::command* cmd)
   {
+    // The command must not be touched once submitted, it may
+    // complete and be reused or freed before exec_buf returns.
+    stamp_start(cmd, latency_time_ns());
     device->exec_buf(cmd->get_exec_bo());
   }
 
@@ -266,30 +442,75 @@ public:
   {
     XRT_DEBUGF("xrt_core::kds::command(%d) [new->submitted->running]\n", cmd->get_uid());
 
+    // Stamp while the command is still exclusively owned here
+    stamp_start(cmd, latency_time_ns());
+
     // Store command so completion can be tracked.  Make sure this is
     // done prior to exec_buf as exec_wait can otherwise be missed.
     // See detailed explanation in monitor loop.
-    {
-      std::lock_guard<std::mutex> lk(work_mutex);
-      submitted_cmds.push_back(cmd);
-    }
+    submitted_cmds.push(cmd);
 
     // Submit the command
     try {
-      exec_buf(cmd);
+      device->exec_buf(cmd->get_exec_bo());
     }
     catch (...) {
-      // Remove the pending command
-      std::lock_guard<std::mutex> lk(work_mutex);
+      // The pending command cannot be removed from the lock free
+      // queue, let the monitor thread purge it.
       assert(get_command_state(cmd)==ERT_CMD_STATE_NEW);
-      if (!submitted_cmds.empty())
-        submitted_cmds.pop_back();
+      abandon(&cmd, &cmd + 1);
       throw;
     }
 
     // This is somewhat expensive, it is better to have this after the
     // exec_buf call so that actual execution doesn't have to wait.
-    work_cond.notify_one();
+    wake_monitor();
+  }
+
+  // launch() - Submit a batch of commands for managed execution
+  //
+  // Same as launch() of a single command, but the commands are
+  // queued for monitoring with one atomic operation, submitted with
+  // a single shim level call, and the monitor thread is kicked once
+  // for the entire batch.
+  void
+  launch(const command_queue_type& cmds)
+  {
+    XRT_DEBUGF("xrt_core::kds::batch(%d) [new->submitted->running]\n", cmds.size());
+
+    std::vector<xclBufferHandle> bos;
+    bos.reserve(cmds.size());
+    std::transform(cmds.begin(), cmds.end(), std::back_inserter(bos),
+                   [](const xrt_core::command* cmd) { return cmd->get_exec_bo(); });
+
+    // Stamp while the commands are still exclusively owned here
+    if (auto start_ns = latency_time_ns()) {
+      for (auto cmd : cmds)
+        stamp_start(cmd, start_ns);
+    }
+
+    // Link the commands newest to oldest and queue them as a chain.
+    for (size_t idx = 1; idx < cmds.size(); ++idx)
+      cmds[idx]->set_next(cmds[idx - 1]);
+    submitted_cmds.push(cmds.front(), cmds.back());
+
+    // Submit the commands
+    try {
+      device->exec_buf_batch(bos.data(), bos.size());
+    }
+    catch (const xrt_core::exec_buf_batch_error& ex) {
+      // Commands prior to the failing one were submitted and remain
+      // monitored, the monitor purges and notifies the rest.
+      abandon(cmds.begin() + std::min(ex.submitted(), cmds.size()), cmds.end());
+      throw;
+    }
+    catch (...) {
+      // None of the commands were submitted
+      abandon(cmds.begin(), cmds.end());
+      throw;
+    }
+
+    wake_monitor();
   }
 }; // kds_device
 
@@ -362,6 +583,15 @@ managed_start(xrt_core::command* cmd)
   kdev->launch(cmd);
 }
 
+// Start managed execution of a batch of commands. All commands
+// must be associated with the same device.
+void
+managed_start(const std::vector<xrt_core::command*>& cmds)
+{
+  auto kdev = get_kds_device(cmds.front());
+  kdev->launch(cmds);
+}
+
 // Alias for managed_start
 void
 schedule(xrt_core::command* cmd)
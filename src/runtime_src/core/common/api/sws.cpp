@@ -24,24 +24,38 @@
 
 #include "exec.h"
 #include "command.h"
+#include "command_latency.h"
+#include "cu_dispatch.h"
 #include "ert.h"
 #include "xclbin.h"
+#include "core/common/bitmap.h"
 #include "core/common/device.h"
+#include "core/common/config_reader.h"
 #include "core/common/debug.h"
+#include "core/common/message.h"
 #include "core/common/task.h"
 #include "core/common/thread.h"
+#include "core/common/time.h"
 #include "core/common/xclbin_parser.h"
+#include <algorithm>
+#include <atomic>
 #include <limits>
 #include <bitset>
+#include <chrono>
+#include <deque>
 #include <vector>
 #include <list>
 #include <map>
 #include <mutex>
 #include <condition_variable>
+#include <thread>
 #include <cstring>
 
 #ifdef _WIN32
 # pragma warning( disable : 4996 4458 4267 4244 )
+#else
+# include <sys/eventfd.h>
+# include <unistd.h>
 #endif
 
 namespace {
@@ -69,16 +83,18 @@ using size_type   = uint32_t;
 using addr_type   = uint32_t;
 using value_type  = uint32_t;
 using cmd_ptr     = xrt_core::command*;
+using ns_type     = uint64_t;
 
 ////////////////////////////////////////////////////////////////
 // Constants
 ////////////////////////////////////////////////////////////////
 const size_type MAX_CUS = 128;
-using cu_bitset_type = std::bitset<MAX_CUS>;
+using cu_bitset_type = xrt_core::bitmap<MAX_CUS>;
 
 const size_type no_index = std::numeric_limits<size_type>::max();
 
 const size_type MAX_SLOTS = 128;
+using slot_bitset_type = xrt_core::bitmap<MAX_SLOTS>;
 
 // FFA  handling
 const value_type AP_START    = 0x1;
@@ -87,9 +103,39 @@ const value_type AP_IDLE     = 0x4;
 const value_type AP_READY    = 0x8;
 const value_type AP_CONTINUE = 0x10;
 
+// Adaptive CU polling.
+//
+// A CU is first polled when it has been running for a fraction of
+// its observed average run time.  Each poll that does not see the CU
+// done doubles the poll interval, starting at MIN_POLL_INTERVAL and
+// capped at a fraction of the observed run time but no more than
+// MAX_POLL_INTERVAL.  The scheduler spins rather than sleeps when the
+// next poll is closer than SPIN_THRESHOLD, which is in the order of
+// the timer slack of a condition variable wait.
+const ns_type MIN_POLL_INTERVAL = 1000;     // 1us
+const ns_type MAX_POLL_INTERVAL = 1000000;  // 1ms
+const ns_type SPIN_THRESHOLD    = 50000;    // 50us
+const ns_type no_deadline = std::numeric_limits<ns_type>::max();
+
 // profiling hook
 static bool cu_trace_enabled = false;
 
+// Monotonic time in ns used for poll scheduling
+static ns_type
+now_ns()
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>
+    (std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Add to a counter that only the scheduler thread writes, other
+// threads may read it at any time
+static void
+add_relaxed(std::atomic<uint64_t>& counter, uint64_t value)
+{
+  counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
 ////////////////////////////////////////////////////////////////
 // Command completion for unmanaged commands
 ////////////////////////////////////////////////////////////////
@@ -116,10 +162,11 @@ class exec_core;
 // @m_ecmd: xrt command packet data
 // @m_kcmd: xrt command packet data cast to start kernel cmd
 // @m_exec: execution core on which this command executes
-// @m_cus: bitset representing the CUs ths cmd can execute on
+// @m_cus: bitmap representing the CUs ths cmd can execute on
 // @m_state: current state of this command
 // @slotidx: command queue slot when command is submitted
 // @cuidx: index of CU executing this command
+// @start_ns: time when command was started on CU
 ////////////////////////////////////////////////////////////////
 class xocl_cmd
 {
@@ -138,6 +185,7 @@ private:
 public:
   size_type slotidx = no_index;
   size_type cuidx = no_index;
+  ns_type start_ns = 0;
 
   xocl_cmd(exec_core* ec, cmd_ptr cmd)
     : m_cmd(cmd), m_ecmd(m_cmd->get_ert_packet()), m_exec(ec), m_state(ERT_CMD_STATE_NEW)
@@ -145,11 +193,9 @@ public:
     static size_type count = 0;
     m_uid = count++;
     if (m_ecmd->type==ERT_CU) {
-      m_cus |= m_kcmd->cu_mask;
-      for (size_type i=0; i<m_kcmd->extra_cu_masks; ++i) {
-        cu_bitset_type mask(m_kcmd->data[i]);
-        m_cus |= (mask<<sizeof(value_type)*8*i);
-      }
+      m_cus.set_word32(0, m_kcmd->cu_mask);
+      for (size_type i=0; i<m_kcmd->extra_cu_masks; ++i)
+        m_cus.set_word32(i + 1, m_kcmd->data[i]);
     }
   }
 
@@ -166,18 +212,26 @@ public:
   }
 
   // Notify host of command completion
+  //
+  // Any number of threads may be in unmanaged_wait for commands
+  // completed by different schedulers, so wake all of them.
   void
   notify_host() const
   {
+    if (xrt_core::command_latency::enabled())
+      m_cmd->get_timestamps().complete.store(xrt_core::time_ns(), std::memory_order_relaxed);
     auto retain = m_cmd->shared_from_this();
     m_cmd->notify(ERT_CMD_STATE_COMPLETED);
-    s_cmd_complete_cond.notify_one();
+    s_cmd_complete_cond.notify_all();
   }
 
   // Notify of start of cu with idx
   void
   notify_start(value_type cuidx)
   {
+    if (xrt_core::command_latency::enabled())
+      m_cmd->get_timestamps().start.store(xrt_core::time_ns(), std::memory_order_relaxed);
+
     if (!cu_trace_enabled)
       return;
 
@@ -278,6 +332,13 @@ public:
     return m_cus.test(cu_idx);
   }
 
+  // CUs this command can execute on
+  const cu_bitset_type&
+  get_cus() const
+  {
+    return m_cus;
+  }
+
   // Get the execution core for this command object
   exec_core*
   get_exec() const
@@ -295,18 +356,6 @@ public:
 
 using xcmd_ptr = std::shared_ptr<xocl_cmd>;
 
-////////////////////////////////////////////////////////////////
-// List of new pending xocl_cmd objects
-//
-// @s_pending_cmds: populated from user space with new commands for buffer objects
-// @s_num_pending: number of pending commands
-//
-// Scheduler copies pending commands to its private queue when necessary
-////////////////////////////////////////////////////////////////
-static std::vector<xcmd_ptr> s_pending_cmds;
-static std::mutex s_pending_mutex;
-static std::atomic<unsigned int> s_num_pending {0};
-
 ////////////////////////////////////////////////////////////////
 // class xocl_cu represents a compute unit on a device
 //
@@ -316,6 +365,16 @@ static std::atomic<unsigned int> s_num_pending {0};
 // @addr: base address of this CU
 // @ctrlreg: state of the CU (value of AXI-lite control register)
 // @done_counter: number of command that have completed (<=running_queue.size())
+// @next_poll_ns: earliest time at which the CU should be polled again
+// @poll_interval_ns: current backoff interval between polls
+// @last_poll_ns: time of last poll or of CU start if not yet polled
+// @expected_ns: moving average of observed command run time
+// @irq_handle: interrupt notification handle if CU interrupts are used
+// @num_polls, @num_done, @num_irqs, @poll_latency_ns: statistics
+// @num_started, @busy_ns, @busy_since_ns, @created_ns: utilization statistics
+//
+// num_started, num_done, and busy_ns are readable from any thread
+// through get_stats().
 //
 // The CU supports HLS data flow model where running_queue represents
 // all the commands that have been started on this CU. The CU is polled
@@ -325,11 +384,18 @@ static std::atomic<unsigned int> s_num_pending {0};
 //
 // New commands can be pushed to the running_queue when the CU has
 // asserted AP_READY (=> AP_START is low)
+//
+// The CU is not polled on every scheduler iteration.  The first poll
+// of a started CU is deferred to a fraction of the CU's average run
+// time, and subsequent polls back off exponentially until the CU is
+// done.  The poll latency statistics is an upper bound on the time
+// added to command completion by polling, it is the time from the
+// previous poll (or start) until the poll that saw the CU done.
 ////////////////////////////////////////////////////////////////
 class xocl_cu
 {
 private:
-  std::queue<xocl_cmd*> running_queue;
+  std::deque<xocl_cmd*> running_queue;
   xrt_core::device* xdev = nullptr;
   size_type cuidx = 0;
   addr_type addr = 0;
@@ -338,22 +404,78 @@ private:
   mutable size_type done_cnt = 0;
   mutable size_type run_cnt = 0;
 
+  mutable ns_type next_poll_ns = 0;
+  mutable ns_type poll_interval_ns = MIN_POLL_INTERVAL;
+  mutable ns_type last_poll_ns = 0;
+  mutable ns_type expected_ns = 0;
+
+  xclInterruptNotifyHandle irq_handle;
+  bool irq_enabled = false;
+
+  mutable uint64_t num_polls = 0;
+  mutable std::atomic<uint64_t> num_done{0};
+  mutable uint64_t num_irqs = 0;
+  mutable uint64_t poll_latency_ns = 0;
+
+  std::atomic<uint64_t> num_started{0};
+  mutable std::atomic<ns_type> busy_ns{0};
+  ns_type busy_since_ns = 0;
+  ns_type created_ns = now_ns();
+
+  // Upper bound of the poll backoff interval
+  ns_type
+  max_poll_interval() const
+  {
+    return std::min(std::max(expected_ns / 8, MIN_POLL_INTERVAL), MAX_POLL_INTERVAL);
+  }
+
+  // Check if CU is due for polling
+  bool
+  poll_due(ns_type now) const
+  {
+    return now >= next_poll_ns;
+  }
+
   void
-  poll() const
+  poll(ns_type now) const
   {
     XRT_ASSERT(running_queue.size(),"cu wasn't started");
     ctrlreg = 0;
 
     xdev->xread(addr,&ctrlreg,4);
+    ++num_polls;
     XRT_DEBUGF("sws cu(%d) poll(0x%x) done(%d) run(%d)\n",cuidx,ctrlreg,done_cnt,run_cnt);
     if (ctrlreg & (AP_DONE | AP_IDLE))  { // AP_IDLE check in sw emulation
+      auto xcmd = running_queue[done_cnt];
+      auto runtime = now - xcmd->start_ns;
+      expected_ns = expected_ns ? (expected_ns * 7 + runtime) / 8 : runtime;
+      poll_latency_ns += now - std::max(last_poll_ns, xcmd->start_ns);
+      add_relaxed(num_done, 1);
+
       ++done_cnt;
-      --run_cnt;
+      if (--run_cnt == 0)
+        add_relaxed(busy_ns, now - busy_since_ns);
       XRT_ASSERT(done_cnt <= running_queue.size(),"too many dones");
+
+      // clear interrupt status (toggle on write)
+      if (irq_enabled) {
+        value_type isr = 0x1;
+        xdev->xwrite(addr + 0xC,&isr,4);
+      }
+
       // acknowledge done
       value_type cont = AP_CONTINUE;
       xdev->xwrite(addr,&cont,4);
+
+      // data flow CU may have more commands completing, poll again
+      next_poll_ns = now;
+      poll_interval_ns = MIN_POLL_INTERVAL;
     }
+    else {
+      poll_interval_ns = std::min(poll_interval_ns * 2, max_poll_interval());
+      next_poll_ns = now + poll_interval_ns;
+    }
+    last_poll_ns = now;
   }
 
 public:
@@ -361,6 +483,120 @@ public:
     : xdev(dev), cuidx(index), addr(baseaddr)
   {}
 
+  ~xocl_cu()
+  {
+    if (irq_enabled) {
+      try {
+        xdev->close_ip_interrupt_notify(irq_handle);
+      }
+      catch (...) {
+      }
+    }
+
+    if (!num_done)
+      return;
+
+    auto lifetime_ns = std::max<ns_type>(now_ns() - created_ns, 1);
+    xrt_core::message::send
+      (xrt_core::message::severity_level::debug, "XRT",
+       "sws cu(%d) starts(%llu) utilization(%.1f%%) completions(%llu) polls(%llu) "
+       "polls/completion(%.2f) interrupts(%llu) avg run time(%lluns) avg poll latency(%lluns)",
+       cuidx, static_cast<unsigned long long>(num_started),
+       100.0 * busy_ns.load() / lifetime_ns,
+       static_cast<unsigned long long>(num_done),
+       static_cast<unsigned long long>(num_polls),
+       static_cast<double>(num_polls) / num_done,
+       static_cast<unsigned long long>(num_irqs),
+       static_cast<unsigned long long>(expected_ns),
+       static_cast<unsigned long long>(poll_latency_ns / num_done));
+  }
+
+  // Enable CU interrupt notification
+  //
+  // @return
+  //  True if the shim supports CU interrupts, false otherwise
+  bool
+  enable_interrupt()
+  {
+    try {
+      irq_handle = xdev->open_ip_interrupt_notify(cuidx);
+      xdev->enable_ip_interrupt(irq_handle);
+      irq_enabled = true;
+    }
+    catch (const std::exception&) {
+      irq_enabled = false;
+    }
+    return irq_enabled;
+  }
+
+  // Check if CU interrupt notification is enabled
+  bool
+  has_interrupt() const
+  {
+    return irq_enabled;
+  }
+
+  // Block until CU raises an interrupt, wake is signaled, or timeout
+  // expires
+  //
+  // Commands added while waiting signal wake, so the wait does not
+  // delay their dispatch.  The timeout is the poll backoff interval
+  // rounded up to the 1ms resolution of the wait, it bounds the
+  // latency of a missed interrupt.
+  //
+  // When the CU interrupts, the interrupt is re-enabled and the CU is
+  // made due for polling.
+  //
+  // If waiting fails the CU falls back to being polled only.
+  void
+  wait_interrupt(xclInterruptNotifyHandle wake)
+  {
+    auto timeout_ms = static_cast<int32_t>((max_poll_interval() + 999999) / 1000000);
+    try {
+      if (xdev->wait_ip_interrupt(irq_handle, timeout_ms, wake) == std::cv_status::timeout)
+        return;
+      xdev->enable_ip_interrupt(irq_handle);
+      ++num_irqs;
+    }
+    catch (const std::exception& ex) {
+      xrt_core::message::send
+        (xrt_core::message::severity_level::warning, "XRT",
+         std::string("sws disabling interrupts for cu: ") + ex.what());
+      xdev->close_ip_interrupt_notify(irq_handle);
+      irq_enabled = false;
+    }
+    next_poll_ns = 0;
+  }
+
+  // Dispatch statistics of this CU, busy time covers completed busy
+  // periods only
+  xrt_core::sws::cu_stats
+  get_stats() const
+  {
+    xrt_core::sws::cu_stats st;
+    st.started = num_started.load(std::memory_order_relaxed);
+    st.completed = num_done.load(std::memory_order_relaxed);
+    st.busy_ns = busy_ns.load(std::memory_order_relaxed);
+    return st;
+  }
+
+  // Number of commands running (not done) on this CU
+  size_type
+  running() const
+  {
+    return run_cnt;
+  }
+
+  // Time when this CU should be polled next
+  //
+  // @return
+  //  Time for next poll, 0 if CU has completed commands
+  ns_type
+  next_poll() const
+  {
+    return done_cnt ? 0 : next_poll_ns;
+  }
+
   // Check if CU is ready to start another command
   //
   // The CU is ready when AP_START is low
@@ -371,8 +607,11 @@ public:
   ready() const
   {
     if ( (ctrlreg & AP_START) || (is_sw_emulation() && run_cnt) ) {
-      XRT_DEBUGF("sws ready() is polling cu(%d)\n",cuidx);
-      poll();
+      auto now = now_ns();
+      if (poll_due(now)) {
+        XRT_DEBUGF("sws ready() is polling cu(%d)\n",cuidx);
+        poll(now);
+      }
     }
 
     return is_sw_emulation()
@@ -388,8 +627,11 @@ public:
   get_done() const
   {
     if (!done_cnt) {
-      XRT_DEBUGF("sws get_done() is polling cu(%d)\n",cuidx);
-      poll();
+      auto now = now_ns();
+      if (poll_due(now)) {
+        XRT_DEBUGF("sws get_done() is polling cu(%d)\n",cuidx);
+        poll(now);
+      }
     }
 
     return done_cnt
@@ -404,7 +646,7 @@ public:
     if (!done_cnt)
       return;
 
-    running_queue.pop();
+    running_queue.pop_front();
     --done_cnt;
     XRT_DEBUGF("sws pop_done() popped cu(%d) done(%d) run(%d)\n",cuidx,done_cnt,run_cnt);
   }
@@ -432,6 +674,10 @@ public:
     else {
       // write register map consecutively from CU base
       regmap[0] = 0; // clear ctrl register stale data if cmd reuse
+      if (irq_enabled && size > 2) {
+        regmap[1] = 0x1; // global interrupt enable
+        regmap[2] = 0x1; // ap_done interrupt enable
+      }
       xdev->xwrite(addr,regmap,size*4);
     }
 
@@ -446,23 +692,64 @@ public:
     else
       xdev->xwrite(addr,regmap,4);
 
-    running_queue.push(xcmd);
+    // first poll is deferred to a fraction of expected run time
+    auto now = now_ns();
+    xcmd->start_ns = now;
+    if (!run_cnt) {
+      poll_interval_ns = MIN_POLL_INTERVAL;
+      next_poll_ns = now + expected_ns * 3 / 4;
+      last_poll_ns = now;
+      busy_since_ns = now;
+    }
+
+    running_queue.push_back(xcmd);
     ++run_cnt;
+    add_relaxed(num_started, 1);
     XRT_DEBUGF("started cu(%d) xcmd(%d) done(%d) run(%d)\n",cuidx,xcmd->get_uid(),done_cnt,run_cnt);
   }
 };
 
 
+using xrt_core::sws::cu_policy;
+using xrt_core::sws::arg_banks;
+using xrt_core::sws::cu_arg_banks;
+
+// CU dispatch policy from Runtime.sws_cu_policy
+static cu_policy
+get_cu_policy()
+{
+  static cu_policy policy = [] {
+    auto value = xrt_core::config::get_sws_cu_policy();
+    if (value == "first")
+      return cu_policy::first;
+    if (value == "round_robin")
+      return cu_policy::round_robin;
+    if (value == "least_outstanding")
+      return cu_policy::least_outstanding;
+    if (value == "memory_affinity")
+      return cu_policy::memory_affinity;
+    xrt_core::message::send
+      (xrt_core::message::severity_level::warning, "XRT",
+       "Unknown sws_cu_policy '" + value + "', using 'first'");
+    return cu_policy::first;
+  }();
+  return policy;
+}
+
 ////////////////////////////////////////////////////////////////
 // class exec_core: core data struct for command execution on a device
 //
 // @xdev: the xrt device on which to execute
 // @scheduler: scheduler that manages this execution core
 // @submit_queue: queue holding command that have been submitted by scheduler
-// @slot_status: bitset representing free/busy slots in submit_queue
+// @slot_status: bitmap representing free/busy slots in submit_queue
 // @cu_usage: list of CUs managed by this execution core (device)
 // @num_slots: number of slots in submit queue
 // @num_cus: number of CUs on device
+// @cu_mask: bitmap of valid CU indices on device
+// @cu_banks: per CU argument connectivity for memory_affinity policy
+// @policy: CU dispatch policy
+// @next_cuidx: CU index where next policy search starts
 //
 // The submit queue reflects the hardware command queue such that
 // number of slots is limitted.  Once submit queue is full, the
@@ -487,7 +774,7 @@ class exec_core
   // Commands submitted to this device, the queue is slot based
   // and a slot becomes free when its command is started on a CU
   xocl_cmd* submit_queue[MAX_SLOTS] = {nullptr}; // reflects ERT CQ # slots
-  std::bitset<MAX_SLOTS> slot_status;
+  slot_bitset_type slot_status;
 
   // Compute units on this device
   std::vector<std::unique_ptr<xocl_cu>> cu_usage;
@@ -495,13 +782,61 @@ class exec_core
   size_type num_slots = 0;
   size_type num_cus = 0;
 
+  cu_bitset_type cu_mask;
+  cu_arg_banks cu_banks;
+  cu_policy policy = cu_policy::first;
+  size_type next_cuidx = 0;
+
+  // Number of buffer arguments of command that are located in a
+  // memory bank connected to the CU
+  size_type
+  arg_affinity(const xocl_cmd* xcmd, size_type cuidx) const
+  {
+    if (cuidx >= cu_banks.size() || xcmd->opcode() == ERT_EXEC_WRITE)
+      return 0;
+    return static_cast<size_type>
+      (xrt_core::sws::arg_affinity(cu_banks[cuidx], xcmd->regmap_data(), xcmd->regmap_size()));
+  }
+
+  // Select a ready CU for the command per dispatch policy
+  //
+  // @return
+  //  Index of selected CU, no_index if no CU is ready
+  size_type
+  select_cu(const xocl_cmd* xcmd) const
+  {
+    auto cuidx = xrt_core::sws::select_cu
+      (policy, xcmd->get_cus() & cu_mask, next_cuidx,
+       [this](size_t idx) { return cu_usage[idx]->ready(); },
+       [this](size_t idx) { return cu_usage[idx]->running(); },
+       [this, xcmd](size_t idx) { return arg_affinity(xcmd, static_cast<size_type>(idx)); });
+    return (cuidx == cu_bitset_type::npos) ? no_index : static_cast<size_type>(cuidx);
+  }
+
 public:
-  exec_core(xrt_core::device* xdev, xocl_scheduler* xs, size_t slots, const std::vector<addr_type>& cu_amap)
+  exec_core(xrt_core::device* xdev, xocl_scheduler* xs, size_t slots,
+            const std::vector<addr_type>& cu_amap, cu_arg_banks&& banks)
     : m_xdev(xdev), m_scheduler(xs), num_slots(slots), num_cus(cu_amap.size())
+    , cu_banks(std::move(banks)), policy(get_cu_policy())
   {
     cu_usage.reserve(cu_amap.size());
-    for (size_type idx=0; idx<cu_amap.size(); ++idx)
+    for (size_type idx=0; idx<cu_amap.size(); ++idx) {
       cu_usage.push_back(std::make_unique<xocl_cu>(xdev,idx,cu_amap[idx]));
+      cu_mask.set(idx);
+    }
+
+    // CUs for which shim doesn't support interrupts are only polled
+    if (xrt_core::config::get_sws_cu_interrupt() && !is_emulation()) {
+      for (auto& cu : cu_usage)
+        cu->enable_interrupt();
+    }
+  }
+
+  // Get the CU with specified index
+  xocl_cu*
+  get_cu(size_type cuidx) const
+  {
+    return cu_usage[cuidx].get();
   }
 
   // Scheduler mananging this execution core
@@ -518,14 +853,11 @@ public:
   size_type
   acquire_slot_idx()
   {
-    // ffz
-    for (size_type idx=0; idx<num_slots; ++idx) {
-      if (!slot_status.test(idx)) {
-        slot_status.set(idx);
-        return idx;
-      }
-    }
-    return no_index;
+    auto idx = slot_status.find_first_zero(num_slots);
+    if (idx == slot_bitset_type::npos)
+      return no_index;
+    slot_status.set(idx);
+    return static_cast<size_type>(idx);
   }
 
   // Release a slot index
@@ -545,9 +877,6 @@ public:
   bool
   submit(xocl_cmd* xcmd)
   {
-    if (slot_status.all())
-      return false;
-
     auto slot_idx = acquire_slot_idx();
     if (slot_idx==no_index)
       return false;
@@ -558,23 +887,21 @@ public:
     return true;
   }
 
-  // Start a command on first available ready CU
+  // Start a command on a ready CU selected by dispatch policy
   //
   // @return
   //  True if started successfully, false otherwise
   bool
   penguin_start(xocl_cmd* xcmd)
   {
-    // Find a ready CU
-    for (size_type cuidx=0; cuidx<num_cus; ++cuidx) {
-      auto& cu = cu_usage[cuidx];
-      if (xcmd->has_cu(cuidx) && cu->ready()) {
-        xcmd->cuidx = cuidx;
-        cu->start(xcmd);
-        return true;
-      }
-    }
-    return false;
+    auto cuidx = select_cu(xcmd);
+    if (cuidx == no_index)
+      return false;
+
+    xcmd->cuidx = cuidx;
+    next_cuidx = cuidx + 1;
+    cu_usage[cuidx]->start(xcmd);
+    return true;
   }
 
   // Start a command on first available ready CU
@@ -619,12 +946,95 @@ public:
   {
     return penguin_query(xcmd);
   }
+
+  // Dispatch statistics of each CU
+  std::vector<xrt_core::sws::cu_stats>
+  get_cu_stats() const
+  {
+    std::vector<xrt_core::sws::cu_stats> stats;
+    stats.reserve(cu_usage.size());
+    for (auto& cu : cu_usage)
+      stats.push_back(cu->get_stats());
+    return stats;
+  }
+
+  // Time when the CU running a command should be polled next
+  ns_type
+  next_poll(xocl_cmd* xcmd) const
+  {
+    return cu_usage[xcmd->cuidx]->next_poll();
+  }
+};
+
+////////////////////////////////////////////////////////////////
+// class irq_wakeup: Wakes a scheduler blocked on a CU interrupt
+//
+// An eventfd that is polled along with the CU interrupt.  CU
+// interrupts are supported on Linux only, elsewhere the handle is
+// never waited on.  If the eventfd cannot be created the handle is
+// invalid and ignored by the wait, which then relies on its timeout.
+////////////////////////////////////////////////////////////////
+class irq_wakeup
+{
+#ifndef _WIN32
+  int m_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+#endif
+
+public:
+  irq_wakeup() = default;
+  irq_wakeup(const irq_wakeup&) = delete;
+  irq_wakeup& operator=(const irq_wakeup&) = delete;
+
+  ~irq_wakeup()
+  {
+#ifndef _WIN32
+    if (m_fd >= 0)
+      ::close(m_fd);
+#endif
+  }
+
+  xclInterruptNotifyHandle
+  handle() const
+  {
+#ifndef _WIN32
+    return m_fd;
+#else
+    return nullptr;
+#endif
+  }
+
+  void
+  signal()
+  {
+#ifndef _WIN32
+    uint64_t one = 1;
+    if (m_fd >= 0 && ::write(m_fd, &one, sizeof(one)) < 0)
+      return;  // counter already signaled
+#endif
+  }
+
+  void
+  clear()
+  {
+#ifndef _WIN32
+    uint64_t value = 0;
+    if (m_fd >= 0 && ::read(m_fd, &value, sizeof(value)) < 0)
+      return;  // not signaled
+#endif
+  }
 };
 
 ////////////////////////////////////////////////////////////////
 // class xocl_scheduler: The scheduler data structure
 //
+// @m_mutex: synchronizes pending commands and scheduler wait
+// @m_pending_cmds: populated from user space with new commands
+// @m_queued_cmds: scratch list used when harvesting pending commands
 // @m_command_queue: all the commands managed by scheduler
+// @m_next_poll_ns: earliest time any running CU should be polled
+// @m_irq_cu: CU to wait on for interrupt if sole command is running on it
+// @m_irq_wakeup: signaled by new commands while blocked on m_irq_cu
+// @m_irq_waiting: scheduler is blocked on m_irq_cu
 //
 // The scheduler babysits all commands launched by user. It
 // transitions the commands from state to state until the command
@@ -637,7 +1047,17 @@ public:
 // client of xocl_cu, no locking is necessary is any of the data
 // structures.  Exception is the pending command list which is copied
 // to the scheduler command queue, the pending list is populated by
-// user thread, and harvested by scheduler thread.
+// user thread, and harvested by scheduler thread.  The pending list
+// is per scheduler, so schedulers for different devices do not
+// contend with each other.
+//
+// When no command changed state in an iteration, the scheduler
+// sleeps until the earliest time a running CU is due for polling, or
+// until new commands are added.  If the only outstanding command is
+// running on a CU with interrupts enabled, the scheduler blocks on
+// the CU interrupt instead, and new commands wake it through an
+// eventfd polled along with the interrupt.  The fixed Runtime.polling_throttle sleep
+// overrides both when set.
 ////////////////////////////////////////////////////////////////
 class xocl_scheduler
 {
@@ -645,30 +1065,45 @@ class xocl_scheduler
   std::condition_variable    m_work;
 
   bool                       m_stop = false;
+  std::vector<xcmd_ptr>      m_pending_cmds;
+  std::vector<xcmd_ptr>      m_queued_cmds;
   std::list<xcmd_ptr>        m_command_queue;
 
   // if command has completed in the iteration
   bool                       m_cmd_completed = false;
 
+  // when to poll next and for what to wait if nothing has completed
+  ns_type                    m_next_poll_ns = no_deadline;
+  xocl_cu*                   m_irq_cu = nullptr;
+  irq_wakeup                 m_irq_wakeup;
+  bool                       m_irq_waiting = false;
+
+  // Wake the scheduler if it is blocked on a CU interrupt, called
+  // with m_mutex held
+  void
+  wake_irq_wait()
+  {
+    if (!m_irq_waiting)
+      return;
+    m_irq_waiting = false;
+    m_irq_wakeup.signal();
+  }
+
   // Copy pending commands into command queue.
   void
   queue_cmds()
   {
-    std::lock_guard<std::mutex> lk(s_pending_mutex);
-    for (auto itr=s_pending_cmds.begin(); itr!=s_pending_cmds.end(); ) {
-      auto xcmd = (*itr);
-      auto exec = xcmd->get_exec();
-      if (exec->get_scheduler()==this) {
-        XRT_DEBUGF("xcmd(%d) [new->queued]\n",xcmd->get_uid());
-        itr = s_pending_cmds.erase(itr);
-        xcmd->set_int_state(ERT_CMD_STATE_QUEUED);
-        m_command_queue.push_back(std::move(xcmd));
-      }
-      else {
-        ++itr;
-      }
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_queued_cmds.swap(m_pending_cmds);
+    }
+
+    for (auto& xcmd : m_queued_cmds) {
+      XRT_DEBUGF("xcmd(%d) [new->queued]\n",xcmd->get_uid());
+      xcmd->set_int_state(ERT_CMD_STATE_QUEUED);
+      m_command_queue.push_back(std::move(xcmd));
     }
-    s_num_pending = s_pending_cmds.size();
+    m_queued_cmds.clear();
   }
 
   // Transition command to submitted state if possible
@@ -733,14 +1168,16 @@ class xocl_scheduler
     auto end = m_command_queue.end();
     auto nitr = m_command_queue.begin();
     m_cmd_completed = false;
+    m_next_poll_ns = no_deadline;
+    m_irq_cu = nullptr;
     for (auto itr=nitr; itr!=end; itr=nitr) {
       auto& xcmd = (*itr);
       if (xcmd->get_state() == ERT_CMD_STATE_QUEUED)
         queued_to_submitted(xcmd);
       if (xcmd->get_state() == ERT_CMD_STATE_SUBMITTED)
         submitted_to_running(xcmd);
-      if (xcmd->get_state() == ERT_CMD_STATE_RUNNING)
-        running_to_complete(xcmd);
+      if (xcmd->get_state() == ERT_CMD_STATE_RUNNING && !running_to_complete(xcmd))
+        m_next_poll_ns = std::min(m_next_poll_ns, xcmd->get_exec()->next_poll(xcmd.get()));
       if (xcmd->get_state() == ERT_CMD_STATE_COMPLETED) {
         complete_to_free(xcmd);
         nitr = m_command_queue.erase(itr);
@@ -751,6 +1188,17 @@ class xocl_scheduler
 
       nitr = ++itr;
     }
+
+    if (m_command_queue.size() != 1)
+      return;
+
+    auto& xcmd = m_command_queue.front();
+    if (xcmd->get_state() != ERT_CMD_STATE_RUNNING)
+      return;
+
+    auto cu = xcmd->get_exec()->get_cu(xcmd->cuidx);
+    if (cu->has_interrupt() && cu->running() == 1)
+      m_irq_cu = cu;
   }
 
   // Wait until something interesting happens
@@ -758,21 +1206,50 @@ class xocl_scheduler
   wait()
   {
     std::unique_lock<std::mutex> lk(m_mutex);
-    while (!m_stop && !s_num_pending && m_command_queue.empty())
+    while (!m_stop && m_pending_cmds.empty() && m_command_queue.empty())
       m_work.wait(lk);
 
     if (m_stop) {
-      if (!m_command_queue.empty() || s_num_pending)
+      if (!m_command_queue.empty() || !m_pending_cmds.empty())
         throw std::runtime_error("software scheduler stopping while there are active commands");
     }
 
-    if (s_num_pending || m_cmd_completed)
+    if (!m_pending_cmds.empty() || m_cmd_completed)
       return;
 
     // Sleep if no new pending commands or no running command have completed
     // throttle polling for cu completion
-    if (auto us = xrt_core::config::get_polling_throttle())
+    if (auto us = xrt_core::config::get_polling_throttle()) {
+      lk.unlock();
       std::this_thread::sleep_for(std::chrono::microseconds(us));
+      return;
+    }
+
+    // Spin if a CU is due for polling soon, a timed wait is too
+    // coarse grained to not add latency to short running kernels
+    auto now = now_ns();
+    if (m_next_poll_ns == no_deadline || m_next_poll_ns < now + SPIN_THRESHOLD) {
+      lk.unlock();
+      std::this_thread::yield();
+      return;
+    }
+
+    // Block on CU interrupt, commands added while blocked wake the
+    // wait.  The flag is set while m_mutex is held, so add() either
+    // sees it or has already added its command before this check.
+    if (m_irq_cu) {
+      m_irq_waiting = true;
+      lk.unlock();
+      m_irq_cu->wait_interrupt(m_irq_wakeup.handle());
+      lk.lock();
+      m_irq_waiting = false;
+      m_irq_wakeup.clear();
+      return;
+    }
+
+    // Sleep until a CU is due for polling or new commands are added
+    m_work.wait_for(lk, std::chrono::nanoseconds(m_next_poll_ns - now),
+                    [this] { return m_stop || !m_pending_cmds.empty(); });
   }
 
 
@@ -787,10 +1264,24 @@ class xocl_scheduler
 
 public:
 
-  // Wake up the scheduler if it is waiting
+  // Add a new command to this scheduler and wake up the scheduler
+  // if it is waiting
+  void
+  add(xcmd_ptr xcmd)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_pending_cmds.push_back(std::move(xcmd));
+    wake_irq_wait();
+    m_work.notify_one();
+  }
+
+  // Add a batch of new commands to this scheduler
   void
-  notify()
+  add(const std::vector<xcmd_ptr>& xcmds)
   {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_pending_cmds.insert(m_pending_cmds.end(), xcmds.begin(), xcmds.end());
+    wake_irq_wait();
     m_work.notify_one();
   }
 
@@ -808,25 +1299,124 @@ public:
   {
     std::lock_guard<std::mutex> lk(m_mutex);
     m_stop = true;
+    wake_irq_wait();
     m_work.notify_one();
   }
 
 };
 
 ////////////////////////////////////////////////////////////////
-// One static scheduler currently on a single thread
-static xocl_scheduler s_global_scheduler;
-static std::thread s_scheduler_thread;
+// class scheduler_thread: A scheduler running on its own thread
+//
+// The thread is started on construction and the scheduler is
+// stopped and joined on destruction.
+////////////////////////////////////////////////////////////////
+class scheduler_thread
+{
+  xocl_scheduler m_scheduler;
+  std::thread m_thread;
+
+public:
+  scheduler_thread()
+    : m_thread(xrt_core::thread(&xocl_scheduler::run, &m_scheduler))
+  {}
+
+  ~scheduler_thread()
+  {
+    m_scheduler.stop();
+    m_thread.join();
+  }
+
+  xocl_scheduler*
+  get_scheduler()
+  {
+    return &m_scheduler;
+  }
+};
+
+////////////////////////////////////////////////////////////////
+// By default one global scheduler on a single thread manages all
+// devices.  If Runtime.sws_per_device is enabled, each device is
+// managed by its own scheduler on its own thread.
+static std::unique_ptr<scheduler_thread> s_global_scheduler;
+static std::map<const xrt_core::device*, std::unique_ptr<scheduler_thread>> s_device_scheduler;
 static bool s_running=false;
 
 // Each device has a execution core
 static std::map<const xrt_core::device*, std::unique_ptr<exec_core>> s_device_exec_core;
 
-// Thread routine for scheduler loop
-static void
-scheduler_loop()
+// Get the scheduler that should manage the device
+static xocl_scheduler*
+get_scheduler(const xrt_core::device* xdev)
+{
+  if (!xrt_core::config::get_sws_per_device())
+    return s_global_scheduler->get_scheduler();
+
+  auto& sched = s_device_scheduler[xdev];
+  if (!sched)
+    sched = std::make_unique<scheduler_thread>();
+  return sched->get_scheduler();
+}
+
+// Get the memory banks connected to buffer arguments of each CU
+//
+// Used only by the memory_affinity policy.  A CU is identified by
+// its base address, which maps it to its IP_LAYOUT index and in turn
+// to its connectivity.  Argument register offsets come from the
+// kernel meta data.
+static cu_arg_banks
+get_cu_arg_banks(xrt_core::device* xdev, const ::ip_layout* ip_layout,
+                 const char* xml_data, size_t xml_size,
+                 const std::vector<addr_type>& cu_amap)
 {
-  s_global_scheduler.run();
+  cu_arg_banks cu_banks;
+  if (get_cu_policy() != cu_policy::memory_affinity || !ip_layout)
+    return cu_banks;
+
+  auto conn = xdev->get_axlf_section<const ::connectivity*>(CONNECTIVITY);
+  auto mem_topology = xdev->get_axlf_section<const ::mem_topology*>(MEM_TOPOLOGY);
+  if (!conn || !mem_topology)
+    return cu_banks;
+
+  cu_banks.resize(cu_amap.size());
+  for (size_type cuidx = 0; cuidx < cu_amap.size(); ++cuidx) {
+    for (int32_t ipidx = 0; ipidx < ip_layout->m_count; ++ipidx) {
+      auto& ip = ip_layout->m_ip_data[ipidx];
+      if (ip.m_type != IP_KERNEL || ip.m_base_address != cu_amap[cuidx])
+        continue;
+
+      std::string ipname = reinterpret_cast<const char*>(ip.m_name);
+      auto kname = ipname.substr(0, ipname.find(':'));
+      auto args = xrt_core::xclbin::get_kernel_arguments(xml_data, xml_size, kname);
+
+      for (int32_t count = 0; count < conn->m_count; ++count) {
+        auto& cxn = conn->m_connection[count];
+        if (cxn.m_ip_layout_index != ipidx || cxn.mem_data_index >= mem_topology->m_count)
+          continue;
+
+        auto& mem = mem_topology->m_mem_data[cxn.mem_data_index];
+        if (!mem.m_used || mem.m_type == MEM_STREAMING || mem.m_type == MEM_STREAMING_CONNECTION)
+          continue;
+
+        auto itr = std::find_if(args.begin(), args.end(), [&cxn](const auto& arg) {
+          return arg.index == static_cast<size_t>(cxn.arg_index)
+            && arg.type == xrt_core::xclbin::kernel_argument::argtype::global;
+        });
+        if (itr == args.end())
+          continue;
+
+        auto regidx = static_cast<size_type>(itr->offset / sizeof(value_type));
+        auto& arg_banks_list = cu_banks[cuidx];
+        auto ab = std::find_if(arg_banks_list.begin(), arg_banks_list.end(),
+                               [regidx](const auto& a) { return a.regidx == regidx; });
+        if (ab == arg_banks_list.end())
+          ab = arg_banks_list.insert(arg_banks_list.end(), arg_banks{regidx, {}});
+        ab->banks.emplace_back(mem.m_base_address, mem.m_size * 1024);
+      }
+      break;
+    }
+  }
+  return cu_banks;
 }
 
 } // namespace
@@ -841,11 +1431,33 @@ managed_start(xrt_core::command* cmd)
   auto& exec = s_device_exec_core[device];
   auto xcmd = xocl_cmd::create(exec.get(),cmd);
   auto scheduler = exec->get_scheduler();
+  scheduler->add(std::move(xcmd));
+}
 
-  std::lock_guard<std::mutex> lk(s_pending_mutex);
-  s_pending_cmds.push_back(xcmd);
-  ++s_num_pending;
-  scheduler->notify();
+// Batched variant of managed_start. The commands are added to the
+// pending list under one lock and scheduler is notified once.
+void
+managed_start(const std::vector<xrt_core::command*>& cmds)
+{
+  auto device = cmds.front()->get_device();
+
+  auto& exec = s_device_exec_core[device];
+  std::vector<xcmd_ptr> xcmds;
+  try {
+    xcmds.reserve(cmds.size());
+    for (auto cmd : cmds)
+      xcmds.push_back(xocl_cmd::create(exec.get(),cmd));
+  }
+  catch (...) {
+    // Nothing was scheduled, abort all commands of the batch
+    for (auto cmd : cmds) {
+      cmd->get_ert_packet()->state = ERT_CMD_STATE_ABORT;
+      cmd->notify(ERT_CMD_STATE_ABORT);
+    }
+    throw;
+  }
+  auto scheduler = exec->get_scheduler();
+  scheduler->add(xcmds);
 }
 
 // The software scheduler manages all command execution but upper
@@ -867,7 +1479,8 @@ start()
   if (s_running)
     throw std::runtime_error("software command scheduler is already started");
 
-  s_scheduler_thread = xrt_core::thread(scheduler_loop);
+  if (!xrt_core::config::get_sws_per_device())
+    s_global_scheduler = std::make_unique<scheduler_thread>();
   s_running = true;
 }
 
@@ -877,12 +1490,21 @@ stop()
   if (!s_running)
     return;
 
-  s_global_scheduler.stop();
-  s_scheduler_thread.join();
+  s_device_scheduler.clear();
+  s_global_scheduler.reset();
 
   s_running = false;
 }
 
+std::vector<cu_stats>
+get_cu_stats(const xrt_core::device* xdev)
+{
+  auto itr = s_device_exec_core.find(xdev);
+  if (itr == s_device_exec_core.end())
+    return {};
+  return itr->second->get_cu_stats();
+}
+
 void
 init(xrt_core::device* xdev)
 {
@@ -913,7 +1535,9 @@ init(xrt_core::device* xdev)
   s_device_exec_core.erase(xdev);
   s_device_exec_core.insert
     (std::make_pair
-     (xdev,std::make_unique<exec_core>(xdev,&s_global_scheduler,slots,amap)));
+     (xdev,std::make_unique<exec_core>
+      (xdev,get_scheduler(xdev),slots,amap,
+       get_cu_arg_banks(xdev,ip_layout,xml_data,xml_size,amap))));
 }
 
 }} // sws,xrt
@@ -23,20 +23,31 @@
 #include "core/include/experimental/xrt_aie.h"
 #include "native_profile.h"
 #include "bo.h"
+#include "enqueue.h"
 
 #include "device_int.h"
 #include "kernel_int.h"
+#include "core/common/config_reader.h"
 #include "core/common/device.h"
 #include "core/common/memalign.h"
 #include "core/common/message.h"
 #include "core/common/query_requests.h"
 #include "core/common/system.h"
+#include "core/common/task.h"
+#include "core/common/thread.h"
 #include "core/common/unistd.h"
 #include "core/common/xclbin_parser.h"
 
+#include <algorithm>
+#include <condition_variable>
 #include <cstdlib>
+#include <exception>
 #include <map>
+#include <mutex>
 #include <set>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 #ifdef _WIN32
 # pragma warning( disable : 4244 4100 4996 4505 )
@@ -128,6 +139,7 @@ namespace xrt {
 // [ubuf]: host side buffer allocated and managed by user
 // [kbuf]: host side buffer allocated and managed by kernel driver
 // [sub]:  sub buffer
+// [arena]: small buffer carved out of a shared arena slab
 //
 // Add new sub classes as needed, for example p2p, cma, svm.
 //
@@ -206,7 +218,7 @@ public:
     return device.get();
   }
 
-  xclBufferExportHandle
+  virtual xclBufferExportHandle
   export_buffer() const
   {
     return device->export_bo(handle);
@@ -250,7 +262,8 @@ public:
     try {
       auto m2m = xrt_core::device_query<xrt_core::query::m2m>(get_device());
       if (xrt_core::query::m2m::to_bool(m2m)) {
-        device->copy_bo(get_xcl_handle(), src->get_xcl_handle(), sz, dst_offset, src_offset);
+        device->copy_bo(get_xcl_handle(), src->get_xcl_handle(), sz,
+                        dst_offset + get_offset(), src_offset + src->get_offset());
         return;
       }
     }
@@ -260,7 +273,8 @@ public:
     // try copying with kdma
     try {
       xrt_core::kernel_int::copy_bo_with_kdma
-        (device, sz, get_xcl_handle(), dst_offset, src->get_xcl_handle(), src_offset);
+        (device, sz, get_xcl_handle(), dst_offset + get_offset(),
+         src->get_xcl_handle(), src_offset + src->get_offset());
       return;
     }
     catch (const std::exception& ex) {
@@ -270,7 +284,8 @@ public:
 
     // special case sw emulation on imported buffers
     if (is_sw_emulation() && (is_imported() || src->is_imported())) {
-      device->copy_bo(get_xcl_handle(), src->get_xcl_handle(), sz, dst_offset, src_offset);
+      device->copy_bo(get_xcl_handle(), src->get_xcl_handle(), sz,
+                      dst_offset + get_offset(), src_offset + src->get_offset());
       return;
     }
       
@@ -281,10 +296,12 @@ public:
   void
   copy_with_export(const bo_impl* src, size_t sz, size_t src_offset, size_t dst_offset)
   {
-    // export bo from other device and create an import bo to copy from
-    auto src_export_handle = src->export_buffer();
+    // export bo from other device and create an import bo to copy from,
+    // the handle is exported directly since arena buffers do not support
+    // export of the shared slab to end user
+    auto src_export_handle = src->device->export_bo(src->handle);
     auto src_import_bo = xrt::bo(device->get_user_handle(), src_export_handle);
-    copy(src_import_bo.get_handle().get(), sz, src_offset, dst_offset);
+    copy(src_import_bo.get_handle().get(), sz, src_offset + src->get_offset(), dst_offset);
   }
 
   void
@@ -629,8 +646,346 @@ public:
   }
 };
 
+// class bo_arena - Sub-allocator for small buffers
+//
+// Small buffers are carved out of large slab buffers allocated from
+// the driver.  There is one arena per device, memory group, and
+// buffer type.  Each slab serves one power of two size class, so a
+// freed chunk is simply pushed on the free list of its size class.
+// The smallest size class is the page size and chunks are aligned
+// to their size class, so an arena buffer has the same alignment as
+// a buffer allocated directly from the driver.
+//
+// The arena does not participate in ownership of the device. If the
+// device is closed before the arena is destructed, then the slabs
+// have already been released by the driver.
+class bo_arena
+{
+public:
+  struct slab
+  {
+    xclBufferHandle handle = XRT_NULL_BO;
+    xrt_core::aligned_ptr_type hbuf;  // null for device only buffers
+    uint64_t addr = 0;
+    int32_t grpid = 0;
+    bo::flags flags = bo::flags::normal;
+  };
+
+  struct chunk
+  {
+    const slab* owner;
+    size_t offset;
+    size_t size_class;
+  };
+
+private:
+  std::weak_ptr<xrt_core::device> m_device;
+  unsigned int m_flags;
+  unsigned int m_grp;
+  size_t m_min_size;
+  size_t m_slab_size;
+
+  std::mutex m_mutex;
+  std::vector<std::unique_ptr<slab>> m_slabs;
+  std::vector<std::vector<chunk>> m_free;  // free chunks per size class
+
+  // Allocate a new slab and carve it into chunks of specified
+  // size class.  Must be called with the arena lock held.
+  void
+  add_slab(size_t cls)
+  {
+    auto device = m_device.lock();
+    if (!device)
+      throw xrt_core::error(-ENODEV, "device of buffer arena is closed");
+
+    // Slab size is rounded down to whole chunks so that every chunk
+    // offset is a multiple of the chunk size regardless of the
+    // configured Runtime.bo_arena_size
+    auto chunk_size = m_min_size << cls;
+    auto num_chunks = std::max<size_t>(m_slab_size / chunk_size, 1);
+    auto slab_size = num_chunks * chunk_size;
+
+    auto sl = std::make_unique<slab>();
+    if (m_flags & XCL_BO_FLAGS_DEV_ONLY) {
+      sl->handle = device->alloc_bo(slab_size, XCL_BO_FLAGS_DEV_ONLY | m_grp);
+    }
+    else {
+      sl->hbuf = xrt_core::aligned_alloc(m_min_size, slab_size);
+      sl->handle = device->alloc_bo(sl->hbuf.get(), slab_size, m_flags | m_grp);
+    }
+
+    xclBOProperties prop;
+    device->get_bo_properties(sl->handle, &prop);
+    sl->addr = prop.paddr;
+    sl->grpid = prop.flags & XRT_BO_FLAGS_MEMIDX_MASK;
+    sl->flags = static_cast<bo::flags>(prop.flags & ~XRT_BO_FLAGS_MEMIDX_MASK);
+
+    // Push highest offset first so chunks are handed out from offset 0
+    auto& free = m_free[cls];
+    for (size_t idx = num_chunks; idx > 0; --idx)
+      free.push_back({sl.get(), (idx - 1) * chunk_size, cls});
+
+    m_slabs.push_back(std::move(sl));
+  }
+
+public:
+  bo_arena(const std::shared_ptr<xrt_core::device>& device, unsigned int flags, unsigned int grp,
+           size_t min_size, size_t max_size, size_t slab_size)
+    : m_device(device), m_flags(flags), m_grp(grp), m_min_size(min_size), m_slab_size(slab_size)
+  {
+    size_t classes = 1;
+    while ((m_min_size << (classes - 1)) < max_size)
+      ++classes;
+    m_free.resize(classes);
+  }
+
+  ~bo_arena()
+  {
+    auto device = m_device.lock();
+    if (!device)
+      return;
+
+    for (auto& sl : m_slabs) {
+      try {
+        device->free_bo(sl->handle);
+      }
+      catch (...) {
+      }
+    }
+  }
+
+  bool
+  expired() const
+  {
+    return m_device.expired();
+  }
+
+  chunk
+  alloc(size_t sz)
+  {
+    size_t cls = 0;
+    while ((m_min_size << cls) < sz)
+      ++cls;
+
+    std::lock_guard<std::mutex> lk(m_mutex);
+    auto& free = m_free.at(cls);
+    if (free.empty())
+      add_slab(cls);
+    auto ch = free.back();
+    free.pop_back();
+    return ch;
+  }
+
+  void
+  release(const chunk& ch)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_free[ch.size_class].push_back(ch);
+  }
+};
+
+// class buffer_arena - Buffer carved out of an arena slab
+//
+// The buffer shares the driver handle of its slab and returns its
+// chunk to the arena when destructed.  Address, group, and flags are
+// known from the slab, so no driver calls are needed to create or
+// destroy an arena buffer.
+class buffer_arena : public bo_impl
+{
+  std::shared_ptr<bo_arena> m_arena;  // participate in ownership of arena
+  bo_arena::chunk m_chunk;
+  void* m_hbuf = nullptr;
+
+public:
+  buffer_arena(std::shared_ptr<xrt_core::device> dev, std::shared_ptr<bo_arena> arena, size_t sz)
+    : bo_impl(sz)
+    , m_arena(std::move(arena))
+    , m_chunk(m_arena->alloc(sz))
+  {
+    auto owner = m_chunk.owner;
+    device = std::move(dev);
+    handle = owner->handle;
+    addr = owner->addr + m_chunk.offset;
+    grpid = owner->grpid;
+    flags = owner->flags;
+    if (owner->hbuf)
+      m_hbuf = static_cast<char*>(owner->hbuf.get()) + m_chunk.offset;
+  }
+
+  ~buffer_arena()
+  {
+    m_arena->release(m_chunk);
+  }
+
+  virtual xclBufferExportHandle
+  export_buffer() const
+  {
+    throw xrt_core::error(-EINVAL, "arena buffers cannot be exported");
+  }
+
+  virtual size_t
+  get_offset() const
+  {
+    return m_chunk.offset;
+  }
+
+  virtual void*
+  get_hbuf() const
+  {
+    if (!m_hbuf)
+      throw xrt_core::error(-EINVAL, "device only buffer has no host buffer");
+    return m_hbuf;
+  }
+
+  virtual bool
+  is_sub_buffer() const
+  {
+    return true;
+  }
+};
+
+// class bo_async_impl - State of an asynchronous buffer sync
+//
+// The async object shares ownership of the buffer object so that
+// the buffer stays alive while the sync is in progress.  If the
+// async object is enqueued in an event graph, then the event is
+// notified when the sync completes.
+class bo_async_impl
+{
+  std::shared_ptr<bo_impl> m_bo;
+  mutable std::mutex m_mutex;
+  mutable std::condition_variable m_sync_done;
+  mutable std::shared_ptr<xrt::event_impl> m_event;
+  std::exception_ptr m_error;
+  bool m_done = false;
+
+  void
+  rethrow_if_error() const
+  {
+    if (m_error)
+      std::rethrow_exception(m_error);
+  }
+
+public:
+  explicit
+  bo_async_impl(std::shared_ptr<bo_impl> bo)
+    : m_bo(std::move(bo))
+  {}
+
+  // Perform the sync, called by a DMA worker thread
+  void
+  sync(xclBOSyncDirection dir, size_t sz, size_t offset)
+  {
+    std::exception_ptr error;
+    try {
+      m_bo->sync(dir, sz, offset);
+    }
+    catch (...) {
+      error = std::current_exception();
+    }
+
+    std::shared_ptr<xrt::event_impl> event;
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      m_error = error;
+      m_done = true;
+      event = std::move(m_event);
+    }
+    m_sync_done.notify_all();
+
+    if (event)
+      xrt_core::enqueue::done(event.get());
+  }
+
+  void
+  wait() const
+  {
+    std::unique_lock<std::mutex> lk(m_mutex);
+    while (!m_done)
+      m_sync_done.wait(lk);
+    rethrow_if_error();
+  }
+
+  bool
+  wait(const std::chrono::milliseconds& timeout_ms) const
+  {
+    std::unique_lock<std::mutex> lk(m_mutex);
+    if (!m_sync_done.wait_for(lk, timeout_ms, [this] { return m_done; }))
+      return false;
+    rethrow_if_error();
+    return true;
+  }
+
+  bool
+  ready() const
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_done;
+  }
+
+  // Event notification is used when an async sync is enqueued in an
+  // event graph.  If the sync is already done the event is notified
+  // immediately.
+  void
+  set_event(const std::shared_ptr<xrt::event_impl>& event) const
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      if (!m_done) {
+        m_event = event;
+        return;
+      }
+    }
+    xrt_core::enqueue::done(event.get());
+  }
+};
+
 } // namespace xrt
 
+namespace {
+
+// class dma_engine - Worker threads performing asynchronous syncs
+//
+// The workers are started on first use of an asynchronous sync
+// and stopped when the process exits.
+class dma_engine
+{
+  xrt_core::task::queue m_queue;
+  std::vector<std::thread> m_workers;
+
+public:
+  dma_engine()
+  {
+    auto workers = xrt_core::config::get_dma_threads();
+    if (!workers)
+      workers = 2;
+    for (unsigned int idx = 0; idx < workers; ++idx)
+      m_workers.emplace_back(xrt_core::thread(xrt_core::task::worker, std::ref(m_queue)));
+  }
+
+  ~dma_engine()
+  {
+    m_queue.stop();
+    for (auto& worker : m_workers)
+      worker.join();
+  }
+
+  void
+  submit(std::shared_ptr<xrt::bo_async_impl> async, xclBOSyncDirection dir, size_t sz, size_t offset)
+  {
+    m_queue.addWork([async, dir, sz, offset] { async->sync(dir, sz, offset); });
+  }
+};
+
+static dma_engine&
+get_dma_engine()
+{
+  static dma_engine engine;
+  return engine;
+}
+
+} // namespace
+
 // Implementation details
 namespace {
 
@@ -741,9 +1096,61 @@ alloc_nodma(xclDeviceHandle dhdl, size_t sz, xrtBufferFlags, xrtMemoryGroup grp,
   }
 }
 
+// Arenas are shared per device, buffer type, and memory group.  An
+// arena is removed when its device has been closed, buffers still
+// carved from the arena keep it alive.
+static std::shared_ptr<xrt::bo_arena>
+get_arena(const std::shared_ptr<xrt_core::device>& device, xrtBufferFlags type, xrtMemoryGroup grp)
+{
+  using key_type = std::tuple<const xrt_core::device*, xrtBufferFlags, xrtMemoryGroup>;
+  static std::mutex mutex;
+  static std::map<key_type, std::shared_ptr<xrt::bo_arena>> arenas;
+  std::lock_guard<std::mutex> lk(mutex);
+
+  auto key = std::make_tuple(device.get(), type, grp);
+  auto itr = arenas.find(key);
+  if (itr != arenas.end() && !(*itr).second->expired())
+    return (*itr).second;
+
+  auto arena = std::make_shared<xrt::bo_arena>
+    (device, type, grp, get_alignment(),
+     xrt_core::config::get_bo_arena_threshold(),
+     xrt_core::config::get_bo_arena_size());
+  arenas[key] = arena;
+  return arena;
+}
+
+// Small buffers are carved out of an arena when enabled through
+// Runtime.bo_arena_threshold.  Returns nullptr if the buffer type
+// is not supported by the arena.
+static std::shared_ptr<xrt::bo_impl>
+alloc_arena(xclDeviceHandle dhdl, size_t sz, xrtBufferFlags flags, xrtMemoryGroup grp)
+{
+  auto type = flags & ~XRT_BO_FLAGS_MEMIDX_MASK;
+#ifdef XRT_EDGE
+  if (type != XCL_BO_FLAGS_DEV_ONLY)
+    return nullptr;
+#else
+  if (type != 0 && type != XCL_BO_FLAGS_DEV_ONLY)
+    return nullptr;
+#endif
+
+  auto device = xrt_core::get_userpf_device(dhdl);
+  if (is_nodma(device.get()))
+    return nullptr;
+
+  auto arena = get_arena(device, type, grp);
+  return std::make_shared<xrt::buffer_arena>(std::move(device), std::move(arena), sz);
+}
+
 static std::shared_ptr<xrt::bo_impl>
 alloc(xclDeviceHandle dhdl, size_t sz, xrtBufferFlags flags, xrtMemoryGroup grp)
 {
+  if (sz && sz <= xrt_core::config::get_bo_arena_threshold()) {
+    if (auto boh = alloc_arena(dhdl, sz, flags, grp))
+      return boh;
+  }
+
   auto type = flags & ~XRT_BO_FLAGS_MEMIDX_MASK;
   switch (type) {
   case 0:
@@ -851,7 +1258,8 @@ fill_copy_pkt(const xrt::bo& dst, const xrt::bo& src, size_t sz,
 #ifndef _WIN32
   const auto& dst_boh = dst.get_handle();
   const auto& src_boh = src.get_handle();
-  ert_fill_copybo_cmd(pkt, src_boh->get_xcl_handle(), dst_boh->get_xcl_handle(), src_offset, dst_offset, sz);
+  ert_fill_copybo_cmd(pkt, src_boh->get_xcl_handle(), dst_boh->get_xcl_handle(),
+                      src_offset + src_boh->get_offset(), dst_offset + dst_boh->get_offset(), sz);
 #else
   throw std::runtime_error("ert_fill_copybo_cmd not implemented on windows");
 #endif
@@ -951,6 +1359,51 @@ sync(xclBOSyncDirection dir, size_t size, size_t offset)
     });
 }
 
+bo::async_handle
+bo::
+async(xclBOSyncDirection dir, size_t size, size_t offset)
+{
+  return xdp::native::profiling_wrapper("xrt::bo::async",
+    [this, dir, size, offset]{
+      auto async = std::make_shared<bo_async_impl>(handle);
+      get_dma_engine().submit(async, dir, size, offset);
+      return async_handle(async);
+    });
+}
+
+void
+bo::async_handle::
+wait() const
+{
+  xdp::native::profiling_wrapper("xrt::bo::async_handle::wait", [this]{
+    handle->wait();
+  });
+}
+
+bool
+bo::async_handle::
+wait(const std::chrono::milliseconds& timeout_ms) const
+{
+  return xdp::native::profiling_wrapper("xrt::bo::async_handle::wait",
+    [this, &timeout_ms]{
+      return handle->wait(timeout_ms);
+    });
+}
+
+bool
+bo::async_handle::
+ready() const
+{
+  return handle->ready();
+}
+
+void
+bo::async_handle::
+set_event(const std::shared_ptr<event_impl>& event) const
+{
+  handle->set_event(event);
+}
+
 void*
 bo::
 map()
@@ -24,13 +24,16 @@
 
 #include <memory>
 #include <vector>
-#include <queue>
+#include <deque>
+#include <array>
 #include <unordered_set>
 #include <set>
 #include <functional>
 #include <algorithm>
+#include <atomic>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 
 #ifdef _WIN32
 # pragma warning( disable : 4244 )
@@ -61,7 +64,7 @@ class event_impl : public std::enable_shared_from_this<event_impl>
   event_queue::task m_task;
   event_queue_impl* m_event_queue = nullptr;
   std::vector<event_impl*> m_chain;
-  unsigned int m_wait_count = 0;
+  std::atomic<unsigned int> m_wait_count {0};
   unsigned int m_uid = 0;
   bool m_done = false;
 
@@ -69,6 +72,9 @@ public:
   // Chain this event to argument event.  This increments
   // the wait count on the argument event, which cannot
   // proceed to execute before this event has completed.
+  //
+  // The lock protects the chain against concurrent completion
+  // of this event, the wait count itself is atomic.
   void
   chain(event_impl* ev)
   {
@@ -83,6 +89,8 @@ public:
   // decrements the wait_count and if zero, submits the event
   // for execution through its associated event queue, where
   // it will be picked up by an event handler and executed.
+  // The decrement is lock free, exactly one caller observes
+  // the count reaching zero.
   //
   // Return: true if wait_count is zero and event was submitted
   // for execution, false otherwise
@@ -160,7 +168,7 @@ public:
     : m_task(std::move(t))
     , m_wait_count(1)
   {
-    static unsigned int count = 0;
+    static std::atomic<unsigned int> count {0};
     m_uid = count++;
     XRT_DEBUGF("event_impl::event_impl(%d)\n", m_uid);
     for (auto& ev : deps)
@@ -175,6 +183,75 @@ public:
   }
 };
 
+// class event_worker - work deque of an event handler
+//
+// Each event handler owns a deque of events that are ready to be
+// executed.  The handler executes events from the front of its own
+// deque, idle handlers steal events from the back of other handlers'
+// deques.  A retired worker no longer accepts events, this prevents
+// events from being pushed to the deque of a handler that is being
+// destructed.
+class event_worker
+{
+  std::mutex m_mutex;
+  std::deque<event_impl*> m_deque;
+  bool m_retired = false;
+
+public:
+  event_queue_impl* m_event_queue;
+  std::atomic<bool> m_stop {false};
+
+  explicit
+  event_worker(event_queue_impl* evq)
+    : m_event_queue(evq)
+  {}
+
+  bool
+  push(event_impl* ev)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_retired)
+      return false;
+    m_deque.push_back(ev);
+    return true;
+  }
+
+  event_impl*
+  pop()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_deque.empty())
+      return nullptr;
+    auto ev = m_deque.front();
+    m_deque.pop_front();
+    return ev;
+  }
+
+  event_impl*
+  steal()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_deque.empty())
+      return nullptr;
+    auto ev = m_deque.back();
+    m_deque.pop_back();
+    return ev;
+  }
+
+  // Retire this worker and return events that were not executed
+  std::deque<event_impl*>
+  retire()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_retired = true;
+    return std::move(m_deque);
+  }
+};
+
+// Worker of the event handler running on the current thread.  Used
+// to submit events chained by a handler to the handler's own deque.
+static thread_local event_worker* current_worker = nullptr;
+
 // class event_queue_impl - insulated implemention of an xrt::event_queue
 //
 // Manages enqueued tasks in form of events that form an event graph
@@ -183,12 +260,16 @@ public:
 // When an event is enqueued it is added to the set of events to
 // retain ownership of the event. As part of enqueuing the event, the
 // event is associated with the event queue by attempting to submit
-// it.
+// it.  The set is sharded to avoid contention between enqueuing
+// threads and completing events.
 //
 // If all event dependencies have been satisfied, the event moves to
-// submitted state where it added the event queues task queue.  The
-// task queue is serviced by one or more event handlers that execute
-// the events in first-in-first-out order.
+// submitted state where it added to the work deque of an event
+// handler.  An event submitted from an event handler thread is added
+// to that handler's deque, other events are distributed round robin
+// over the handlers.  Events submitted before any handler is
+// associated with the queue are added to a shared deque.  Idle
+// handlers steal work from other handlers before going to sleep.
 //
 // An event queue is associated with one or more event handlers, which
 // participate in ownership of the queue.
@@ -203,33 +284,102 @@ class event_queue_impl
     bool operator() (const event_ptr& lhs, const event_impl* rhs) const { return lhs.get() < rhs; }
     bool operator() (const event_impl* lhs, const event_ptr& rhs) const { return lhs < rhs.get(); }
   };
-  
-  std::queue<event_impl*> m_queue;                           // task queue
-  std::set<std::shared_ptr<event_impl>, event_cmp> m_events; // enqueued events
+
+  struct event_shard
+  {
+    std::mutex m_mutex;
+    std::set<std::shared_ptr<event_impl>, event_cmp> m_events; // enqueued events
+  };
+
+  using worker_list = std::vector<std::shared_ptr<event_worker>>;
+
+  static constexpr size_t num_shards = 16;
+  std::array<event_shard, num_shards> m_shards;
+
+  event_worker m_shared {this};                // events submitted with no handlers
+  std::shared_ptr<const worker_list> m_workers; // copy on write, atomic access
+  std::mutex m_workers_mutex;                   // serialize writers of m_workers
+  std::atomic<unsigned int> m_next {0};         // round robin submission
+
+  // Idle handlers sleep when no events are pending
+  std::atomic<unsigned int> m_pending {0};
+  std::atomic<unsigned int> m_sleeping {0};
   std::mutex m_mutex;
   std::condition_variable m_work;
 
+  event_shard&
+  get_shard(const event_impl* ev)
+  {
+    return m_shards[(reinterpret_cast<uintptr_t>(ev) >> 6) % num_shards];
+  }
+
+  std::shared_ptr<const worker_list>
+  get_workers() const
+  {
+    return std::atomic_load(&m_workers);
+  }
+
+  // Wake up one sleeping handler if any
+  void
+  wake_one()
+  {
+    if (!m_sleeping)
+      return;
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_work.notify_one();
+  }
+
+  // Steal an event from another handler
+  event_impl*
+  steal(const event_worker* self)
+  {
+    auto workers = get_workers();
+    auto sz = workers->size();
+    auto start = m_next.load();
+    for (size_t idx = 0; idx < sz; ++idx) {
+      auto& worker = (*workers)[(start + idx) % sz];
+      if (worker.get() == self)
+        continue;
+      if (auto ev = worker->steal())
+        return ev;
+    }
+    return nullptr;
+  }
+
 public:
+  event_queue_impl()
+    : m_workers(std::make_shared<worker_list>())
+  {}
+
   // Enqueue an event and try submit it.
   void
   enqueue(const std::shared_ptr<event_impl>& event)
   {
     {
-      std::lock_guard<std::mutex> lk(m_mutex);
-      m_events.insert(event);
+      auto& shard = get_shard(event.get());
+      std::lock_guard<std::mutex> lk(shard.m_mutex);
+      shard.m_events.insert(event);
     }
     event->submit(this);
   }
 
-  // Submit argument event by inserting it in the queue that is
-  // serviced by event handlers.  Notify the handlers that work
-  // is ready.
+  // Submit argument event by inserting it in the deque of an
+  // event handler.  Notify a sleeping handler that work is ready.
   void
   submit(event_impl* ev)
   {
-    std::lock_guard<std::mutex> lk(m_mutex);
-    m_queue.push(ev);
-    m_work.notify_one();
+    ++m_pending;
+    auto worker = current_worker;
+    if (!worker || worker->m_event_queue != this || !worker->push(ev)) {
+      auto workers = get_workers();
+      worker = workers->empty()
+        ? &m_shared
+        : (*workers)[m_next++ % workers->size()].get();
+      if (!worker->push(ev))
+        m_shared.push(ev);
+    }
+
+    wake_one();
   }
 
   // Upon completion, the event is removed from the ownership
@@ -238,10 +388,42 @@ public:
   void
   remove(event_impl* ev)
   {
-    std::lock_guard<std::mutex> lk(m_mutex);
-    auto itr = m_events.find(ev);
-    if (itr != m_events.end())
-      m_events.erase(itr);
+    auto& shard = get_shard(ev);
+    std::lock_guard<std::mutex> lk(shard.m_mutex);
+    auto itr = shard.m_events.find(ev);
+    if (itr != shard.m_events.end())
+      shard.m_events.erase(itr);
+  }
+
+  // Associate a new event handler with this queue
+  std::shared_ptr<event_worker>
+  add_worker()
+  {
+    auto worker = std::make_shared<event_worker>(this);
+    std::lock_guard<std::mutex> lk(m_workers_mutex);
+    auto workers = std::make_shared<worker_list>(*get_workers());
+    workers->push_back(worker);
+    std::atomic_store(&m_workers, std::shared_ptr<const worker_list>(std::move(workers)));
+    return worker;
+  }
+
+  // Disassociate an event handler from this queue.  Events that
+  // were not executed by the handler are moved to the shared deque
+  // where they are picked up by remaining or future handlers.
+  void
+  remove_worker(const std::shared_ptr<event_worker>& worker)
+  {
+    {
+      std::lock_guard<std::mutex> lk(m_workers_mutex);
+      auto workers = std::make_shared<worker_list>(*get_workers());
+      workers->erase(std::remove(workers->begin(), workers->end(), worker), workers->end());
+      std::atomic_store(&m_workers, std::shared_ptr<const worker_list>(std::move(workers)));
+    }
+
+    for (auto ev : worker->retire()) {
+      m_shared.push(ev);
+      wake_one();
+    }
   }
 
   // Notify any waiting for work from this queue. Used by event
@@ -254,27 +436,34 @@ public:
     m_work.notify_all();
   }
 
-  // Get work from the queue.  This function is used by
-  // event handlers to wait for event that are ready to
-  // be executed.  The function pops of events from the
-  // front of the queue.
+  // Get work for argument worker.  This function is used by event
+  // handlers to get events that are ready to be executed.  Events
+  // are taken from the handler's own deque, then from the shared
+  // deque, and finally stolen from other handlers.  If no events
+  // are pending the handler waits for work.
   event_impl*
-  get_work()
+  get_work(event_worker* worker)
   {
+    auto ev = worker->pop();
+    if (!ev)
+      ev = m_shared.pop();
+    if (!ev)
+      ev = steal(worker);
+    if (ev) {
+      --m_pending;
+      return ev;
+    }
+
     std::unique_lock<std::mutex> lk(m_mutex);
     // notify() need to be able to wake up handlers waiting
     // for tasks, so wait is deliberately not using 'while'
-    if (m_queue.empty())
+    ++m_sleeping;
+    if (!m_pending && !worker->m_stop)
       m_work.wait(lk);
+    --m_sleeping;
 
-    // return null task if no real ones
-    if (m_queue.empty())
-      return nullptr;
-
-    // first in first out
-    auto e = std::move(m_queue.front());
-    m_queue.pop();
-    return e;
+    // return null task, caller will try again
+    return nullptr;
   }
 };
   
@@ -283,10 +472,9 @@ bool
 event_impl::
 submit()
 {
-  std::lock_guard<std::mutex> lk(m_mutex);
   if (--m_wait_count)
     return false;
-  
+
   m_event_queue->submit(this);
   return true;
 }
@@ -317,24 +505,28 @@ done()
 // be executed.
 //
 // The handler is associated with exactly one event queue and shares
-// ownership of this event queue.  Upon destruction of the event
-// handler, the event queue is requested to wake up the waiting thread
-// routine, which then gracefully exits.
+// ownership of this event queue.  The handler owns a work deque that
+// is registered with the event queue.  Upon destruction of the event
+// handler, the work deque is removed from the queue and the queue is
+// requested to wake up the waiting thread routine, which then
+// gracefully exits.
 class event_handler_impl
 {
-  std::atomic<bool> m_stop {false};
+  event_queue m_retain;                  // retain ownership of event queue
+  event_queue_impl* m_event_queue;       // convienience
+  std::shared_ptr<event_worker> m_worker;
   std::thread m_handler;
-  event_queue m_retain;            // retain ownership of event queue
-  event_queue_impl* m_event_queue; // convienience
 
   // Thread run routine that consumes and executes events
   // that are ready to be executed.
   void
   run()
   {
-    while (!m_stop)
-      if (auto e = m_event_queue->get_work())
+    current_worker = m_worker.get();
+    while (!m_worker->m_stop)
+      if (auto e = m_event_queue->get_work(m_worker.get()))
         e->execute();
+    current_worker = nullptr;
   }
   
 public:
@@ -342,6 +534,7 @@ public:
   event_handler_impl(const event_queue& q)
     : m_retain(q)
     , m_event_queue(q.get_impl())
+    , m_worker(m_event_queue->add_worker())
   {
     m_handler = std::thread(&event_handler_impl::run, this);
   }
@@ -349,14 +542,16 @@ public:
   // Destruct event handler requesting event queue to notify waiting
   // workers.  While all workers are notified, only the ones that are
   // being stopped will actually exit so while an event queue can have
-  // multiple handlers, handlers can exit one by one.  When last handler
-  // is destructed the retained event queue is effectively deleted if
-  // noone else shares ownership.
+  // multiple handlers, handlers can exit one by one.  Events pending
+  // in the handler's deque are handed back to the queue.  When last
+  // handler is destructed the retained event queue is effectively
+  // deleted if noone else shares ownership.
   ~event_handler_impl()
   {
-    m_stop = true;
+    m_worker->m_stop = true;
     m_event_queue->notify();
     m_handler.join();
+    m_event_queue->remove_worker(m_worker);
   }
 };
 
@@ -24,10 +24,12 @@
 #include "kernel_int.h"
 
 #include "command.h"
+#include "command_latency.h"
 #include "exec.h"
 #include "bo.h"
 #include "device_int.h"
 #include "enqueue.h"
+#include "core/common/bitmap.h"
 #include "core/common/bo_cache.h"
 #include "core/common/config_reader.h"
 #include "core/common/device.h"
@@ -35,6 +37,7 @@
 #include "core/common/error.h"
 #include "core/common/message.h"
 #include "core/common/system.h"
+#include "core/common/time.h"
 #include "core/common/xclbin_parser.h"
 #include "core/include/ert.h"
 #include "core/include/ert_fa.h"
@@ -267,7 +270,9 @@ struct device_type
 
   device_type(xrtDeviceHandle dhdl)
     : core_device(xrt_core::device_int::get_core_device(dhdl))
-    , exec_buffer_cache(core_device->get_device_handle(), 128)
+    , exec_buffer_cache(core_device->get_device_handle(),
+                        xrt_core::config::get_exec_bo_cache(),
+                        xrt_core::config::get_exec_bo_prewarm())
     , uid(create_uid())
   {
     XRT_DEBUGF("device_type::device_type(%d)\n", uid);
@@ -275,7 +280,9 @@ struct device_type
 
   device_type(const std::shared_ptr<xrt_core::device>& cdev)
     : core_device(cdev)
-    , exec_buffer_cache(core_device->get_device_handle(), 128)
+    , exec_buffer_cache(core_device->get_device_handle(),
+                        xrt_core::config::get_exec_bo_cache(),
+                        xrt_core::config::get_exec_bo_prewarm())
     , uid(create_uid())
   {
     XRT_DEBUGF("device_type::device_type(%d)\n", uid);
@@ -284,13 +291,27 @@ struct device_type
   ~device_type()
   {
     XRT_DEBUGF("device_type::~device_type(%d)\n", uid);
+    auto st = exec_buffer_cache.get_stats();
+    if (!st.hits && !st.misses)
+      return;
+
+    try {
+      xrt_core::message::send
+        (xrt_core::message::severity_level::debug, "XRT",
+         "exec bo cache device(%u) hits(%llu) misses(%llu) high water(%llu)",
+         uid, static_cast<unsigned long long>(st.hits),
+         static_cast<unsigned long long>(st.misses),
+         static_cast<unsigned long long>(st.high_water));
+    }
+    catch (...) {
+    }
   }
 
   template <typename CommandType>
   xrt_core::bo_cache::cmd_bo<CommandType>
-  create_exec_buf()
+  create_exec_buf(size_t bytes)
   {
-    return exec_buffer_cache.alloc<CommandType>();
+    return exec_buffer_cache.alloc<CommandType>(bytes);
   }
 
   xrt_core::device*
@@ -574,6 +595,57 @@ private:
 // Remove when c++17
 constexpr int32_t ip_context::connectivity::no_memidx;
 
+// class batch_completion - Completion accounting for a batch of commands
+//
+// Commands started as part of a batch share one batch_completion
+// object.  Each command decrements the outstanding count when it
+// completes, and waiters on the batch are notified once when the
+// last command in the batch completes.
+class batch_completion
+{
+  mutable std::mutex m_mutex;
+  mutable std::condition_variable m_done;
+  size_t m_outstanding = 0;
+
+public:
+  void
+  reset(size_t count)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_outstanding = count;
+  }
+
+  bool
+  done() const
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_outstanding == 0;
+  }
+
+  void
+  notify()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (--m_outstanding == 0)
+      m_done.notify_all();
+  }
+
+  void
+  wait() const
+  {
+    std::unique_lock<std::mutex> lk(m_mutex);
+    while (m_outstanding)
+      m_done.wait(lk);
+  }
+
+  bool
+  wait(const std::chrono::milliseconds& timeout_ms) const
+  {
+    std::unique_lock<std::mutex> lk(m_mutex);
+    return m_done.wait_for(lk, timeout_ms, [this] { return m_outstanding == 0; });
+  }
+};
+
 // class kernel_command - Immplements command API expected by schedulers
 //
 // The kernel command is
@@ -583,11 +655,25 @@ public:
   using execbuf_type = xrt_core::bo_cache::cmd_bo<ert_start_kernel_cmd>;
   using callback_function_type = std::function<void(ert_cmd_state)>;
   using callback_list = std::vector<callback_function_type>;
+  using latency_histograms = xrt_core::command_latency::histograms;
+
+  // Record submit time and clear stale times of previous execution
+  void
+  stamp_submit()
+  {
+    if (!m_latency)
+      return;
+    auto& ts = get_timestamps();
+    ts.start = 0;
+    ts.complete = 0;
+    ts.submit = xrt_core::time_ns();
+  }
 
 public:
-  kernel_command(const std::shared_ptr<device_type>& dev)
+  kernel_command(const std::shared_ptr<device_type>& dev, size_t bytes = xrt_core::bo_cache::mBOSize)
     : m_device(dev)
-    , m_execbuf(m_device->create_exec_buf<ert_start_kernel_cmd>())
+    , m_execbuf(m_device->create_exec_buf<ert_start_kernel_cmd>(bytes))
+    , m_execbuf_size(bytes)
     , m_done(true)
   {
     static unsigned int count = 0;
@@ -599,22 +685,23 @@ public:
   {
     XRT_DEBUGF("kernel_command::~kernel_command(%d)\n", m_uid);
     // This is problematic, bo_cache should return managed BOs
-    m_device->exec_buffer_cache.release(m_execbuf);
+    m_device->exec_buffer_cache.release(m_execbuf, m_execbuf_size);
+  }
+
+  // Set histograms to which command latencies are recorded
+  void
+  set_latency_histograms(latency_histograms* hist)
+  {
+    m_latency = hist;
   }
 
   void
   encode_compute_units(const std::bitset<128>& cumask, size_t num_cumasks)
   {
     auto ecmd = get_ert_cmd<ert_packet*>();
-    std::fill(ecmd->data, ecmd->data + num_cumasks, 0);
-
-    for (size_t cu_idx = 0; cu_idx < 128; ++cu_idx) {
-      if (!cumask.test(cu_idx))
-        continue;
-      auto mask_idx = cu_idx / 32;
-      auto idx_in_mask = cu_idx - mask_idx * 32;
-      ecmd->data[mask_idx] |= (1 << idx_in_mask);
-    }
+    xrt_core::bitmap<128> words(cumask);
+    for (size_t mask_idx = 0; mask_idx < num_cumasks; ++mask_idx)
+      ecmd->data[mask_idx] = words.get_word32(mask_idx);
   }
 
   // Cast underlying exec buffer to its requested type
@@ -723,6 +810,7 @@ public:
         throw std::runtime_error("bad command state, can't launch");
       m_managed = (m_callbacks && !m_callbacks->empty());
       m_done = false;
+      stamp_submit();
     }
     if (m_managed)
       xrt_core::exec::managed_start(this);
@@ -730,6 +818,33 @@ public:
       xrt_core::exec::unmanaged_start(this);
   }
 
+  // Prepare the command for execution as part of a batch
+  //
+  // Batched commands are always managed, the batch is notified
+  // when the command completes.  The command must subsequently be
+  // submitted for execution by the batch.
+  void
+  prepare_batch(std::shared_ptr<batch_completion> batch)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (!m_done)
+      throw std::runtime_error("bad command state, can't launch");
+    m_managed = true;
+    m_done = false;
+    m_batch = std::move(batch);
+    stamp_submit();
+  }
+
+  // Revert command preparation if the batch failed before the
+  // command was handed to the scheduler.
+  void
+  unprepare_batch()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_done = true;
+    m_batch = nullptr;
+  }
+
   // Wait for command completion
   ert_cmd_state
   wait() const
@@ -789,17 +904,23 @@ public:
   {
     bool complete = false;
     bool callbacks = false;
+    std::shared_ptr<batch_completion> batch;
     if (s>=ERT_CMD_STATE_COMPLETED) {
       std::lock_guard<std::mutex> lk(m_mutex);
       XRT_DEBUGF("kernel_command::notify() m_uid(%d) m_state(%d)\n", m_uid, s);
+      if (m_latency)
+        xrt_core::command_latency::record(m_latency, this);
       complete = m_done = true;
       callbacks = (m_callbacks && !m_callbacks->empty());
+      batch = std::move(m_batch);
       if (m_event)
         xrt_core::enqueue::done(m_event.get());
     }
 
     if (complete) {
       m_exec_done.notify_all();
+      if (batch)
+        batch->notify();
       if (callbacks)
         run_callbacks(s);
 
@@ -813,7 +934,10 @@ public:
 private:
   std::shared_ptr<device_type> m_device;
   mutable std::shared_ptr<xrt::event_impl> m_event;
+  std::shared_ptr<batch_completion> m_batch; // batch if started with batch
+  latency_histograms* m_latency = nullptr;   // latency histograms if instrumented
   execbuf_type m_execbuf; // underlying execution buffer
+  size_t m_execbuf_size;  // requested size of execution buffer
   unsigned int m_uid = 0;
   bool m_managed = false;
   bool m_done = false;
@@ -1119,6 +1243,7 @@ class kernel_impl
   size_t num_cumasks = 1;              // Required number of command cu masks
   uint32_t protocol = 0;               // Default opcode
   uint32_t uid;                        // internal unique id for debug
+  xrt_core::command_latency::histograms* latency; // command latency histograms, nullptr if disabled
 
   // Compute data for FAST_ADAPTER descriptor use (see ert_fa.h)
   //
@@ -1256,6 +1381,7 @@ public:
     , name(nm.substr(0,nm.find(":")))                          // filter instance names
     , vctx(ip_context::open_virtual_cu(device->core_device.get(), xclbin_id))
     , uid(create_uid())
+    , latency(xrt_core::command_latency::get(device->core_device.get(), name))
   {
     XRT_DEBUGF("kernel_impl::kernel_impl(%d)\n" , uid);
 
@@ -1349,6 +1475,13 @@ public:
     return num_cumasks;
   }
 
+  // Size of exec buffer required for a start kernel command
+  size_t
+  get_exec_buf_size() const
+  {
+    return sizeof(ert_start_kernel_cmd) + (num_cumasks + regmap_size) * sizeof(uint32_t);
+  }
+
   const std::vector<ipctx>&
   get_ips() const
   {
@@ -1361,6 +1494,12 @@ public:
     return IP_CONTROL(protocol);
   }
 
+  xrt_core::command_latency::histograms*
+  get_latency_histograms() const
+  {
+    return latency;
+  }
+
   // Group id is the memory bank index where a global buffer
   // can be allocated for use with this kernel.   If the kernel
   // contains imcompatible compute units, then these are
@@ -1647,12 +1786,13 @@ public:
     , ips(kernel->get_ips())
     , cumask(kernel->get_cumask())
     , core_device(kernel->get_core_device())      // cache core device
-    , cmd(std::make_shared<kernel_command>(kernel->get_device()))
+    , cmd(std::make_shared<kernel_command>(kernel->get_device(), kernel->get_exec_buf_size()))
     , data(kernel->initialize_command(cmd.get())) // default encodes CUs
     , uid(create_uid())
     , arg_setter(make_arg_setter())
   {
     XRT_DEBUGF("run_impl::run_impl(%d)\n" , uid);
+    cmd->set_latency_histograms(kernel->get_latency_histograms());
   }
 
   // Clones a run impl, so that the clone can be executed concurrently
@@ -1662,12 +1802,14 @@ public:
     , ips(rhs->ips)
     , cumask(rhs->cumask)
     , core_device(rhs->core_device)
-    , cmd(std::make_shared<kernel_command>(kernel->get_device()))
+    , cmd(std::make_shared<kernel_command>(kernel->get_device(), kernel->get_exec_buf_size()))
     , data(clone_command_data(rhs))
     , uid(create_uid())
     , arg_setter(make_arg_setter())
+    , encode_cumasks(rhs->encode_cumasks)
   {
     XRT_DEBUGF("run_impl::run_impl(%d)\n" , uid);
+    cmd->set_latency_histograms(kernel->get_latency_histograms());
   }
 
   ~run_impl()
@@ -1759,9 +1901,9 @@ public:
     }
   }
 
-  // start() - start the run object (execbuf)
+  // prepare() - prepare command packet for execution
   void
-  start()
+  prepare()
   {
     // If this run object's cus were filtered compared to kernel cus
     // then update the command packet encoded cus.
@@ -1775,10 +1917,37 @@ public:
     pkt->state = ERT_CMD_STATE_NEW;
 
     XRT_DEBUG_CALL(debug_cmd_packet(kernel->get_name(), pkt));
+  }
 
+  // start() - start the run object (execbuf)
+  void
+  start()
+  {
+    prepare();
     cmd->run();
   }
 
+  kernel_command*
+  get_cmd() const
+  {
+    return cmd.get();
+  }
+
+  // copy_cumask() - use the compute units of another run object
+  //
+  // Used by run templates to propagate CU filtering of the template
+  // to its clones.  The command packet is re-encoded on next start.
+  void
+  copy_cumask(const run_impl* rhs)
+  {
+    if (cumask == rhs->cumask)
+      return;
+
+    ips = rhs->ips;
+    cumask = rhs->cumask;
+    encode_cumasks = true;
+  }
+
   // wait() - wait for execution to complete
   ert_cmd_state
   wait(const std::chrono::milliseconds& timeout_ms) const
@@ -1801,6 +1970,200 @@ public:
   }
 };
 
+// class run_batch_impl - The internals of an xrt::run_batch
+//
+// A batch is a group of run objects that are started together with
+// one submission to the command scheduler.  All runs in a batch must
+// be associated with the same device.  The batch is complete when
+// all its runs have completed.
+class run_batch_impl
+{
+  std::vector<std::shared_ptr<run_impl>> runs;   // runs in this batch
+  std::vector<xrt_core::command*> cmds;          // commands of runs
+  std::shared_ptr<batch_completion> completion;  // batch completion
+
+public:
+  run_batch_impl()
+    : completion(std::make_shared<batch_completion>())
+  {}
+
+  void
+  add(const std::shared_ptr<run_impl>& run)
+  {
+    if (!runs.empty() && runs.front()->get_kernel()->get_core_device() != run->get_kernel()->get_core_device())
+      throw xrt_core::error(EINVAL, "All runs in a batch must be on the same device");
+    runs.push_back(run);
+    cmds.push_back(run->get_cmd());
+  }
+
+  size_t
+  size() const
+  {
+    return runs.size();
+  }
+
+  void
+  start()
+  {
+    if (runs.empty())
+      return;
+
+    if (!completion->done())
+      throw std::runtime_error("bad batch state, can't launch");
+
+    // Prepare all commands before submitting any so that a failure
+    // leaves the batch in a state where it can be restarted.
+    size_t prepared = 0;
+    try {
+      for (auto& run : runs) {
+        run->prepare();
+        run->get_cmd()->prepare_batch(completion);
+        ++prepared;
+      }
+    }
+    catch (...) {
+      for (size_t idx = 0; idx < prepared; ++idx)
+        runs[idx]->get_cmd()->unprepare_batch();
+      throw;
+    }
+
+    completion->reset(runs.size());
+
+    // If submission fails, commands that were not submitted are
+    // notified as aborted by the scheduler once it no longer
+    // references them, so the batch completes and can be restarted.
+    xrt_core::exec::managed_start(cmds);
+  }
+
+  ert_cmd_state
+  wait(const std::chrono::milliseconds& timeout_ms) const
+  {
+    if (timeout_ms.count())
+      completion->wait(timeout_ms);
+    else
+      completion->wait();
+
+    // Report first run that is not successfully completed if any
+    for (auto& run : runs) {
+      auto state = run->state();
+      if (state != ERT_CMD_STATE_COMPLETED)
+        return state;
+    }
+    return ERT_CMD_STATE_COMPLETED;
+  }
+};
+
+// class run_template_impl - The internals of an xrt::run_template
+//
+// A run template freezes the command packet of a run object whose
+// arguments have been set.  The template owns a fixed number of clones
+// of the run, each with its own exec buffer allocated up front, that
+// are used round robin when the template is started.  This allows the
+// same logical run to have many executions in flight.
+//
+// Arguments changed in the template are recorded with a generation
+// number.  When a clone is started, only the arguments that changed
+// since the clone was last synchronized are copied into its command
+// packet, everything else, including the encoded CUs, is reused as is.
+class run_template_impl
+{
+  struct slot
+  {
+    std::shared_ptr<run_impl> run;  // clone of template run
+    uint64_t synced = 0;            // generation synchronized with template
+    bool started = false;           // clone has been started at least once
+  };
+
+  std::shared_ptr<run_impl> tmpl;   // template run, arguments set here
+  std::vector<uint64_t> arg_gen;    // generation of last change per arg index
+  uint64_t cumask_gen = 0;          // generation of last change of cumask
+  uint64_t generation = 0;          // current generation
+  std::vector<slot> slots;          // pool of clones
+  size_t next = 0;                  // next slot to use
+
+  void
+  mark_dirty(size_t index)
+  {
+    if (index >= arg_gen.size())
+      arg_gen.resize(index + 1, 0);
+    arg_gen[index] = ++generation;
+  }
+
+  // Copy changed arguments from template to clone
+  void
+  sync(slot& s)
+  {
+    if (s.synced == generation)
+      return;
+
+    if (cumask_gen > s.synced)
+      s.run->copy_cumask(tmpl.get());
+
+    auto kernel = tmpl->get_kernel();
+    for (size_t index = 0; index < arg_gen.size(); ++index) {
+      if (arg_gen[index] <= s.synced)
+        continue;
+      auto& arg = kernel->get_arg(index);
+      s.run->set_arg_value(arg, tmpl->get_arg_value(arg));
+    }
+
+    s.synced = generation;
+  }
+
+public:
+  run_template_impl(std::shared_ptr<run_impl> run, size_t depth)
+    : tmpl(std::move(run))
+  {
+    if (!depth)
+      throw xrt_core::error(EINVAL, "run template depth must be at least one");
+
+    slots.resize(depth);
+    for (auto& s : slots)
+      s.run = std::make_shared<run_impl>(tmpl.get());
+  }
+
+  size_t
+  depth() const
+  {
+    return slots.size();
+  }
+
+  void
+  set_arg_at_index(size_t index, const void* value, size_t bytes)
+  {
+    tmpl->set_arg_at_index(index, value, bytes);
+    mark_dirty(index);
+  }
+
+  void
+  set_arg_at_index(size_t index, const xrt::bo& bo)
+  {
+    auto cumask = tmpl->get_cumask();
+    tmpl->set_arg_at_index(index, bo);
+    if (cumask != tmpl->get_cumask())
+      cumask_gen = generation + 1;
+    mark_dirty(index);
+  }
+
+  // start() - start next clone in the pool
+  //
+  // If the next clone is still running from a previous start, then
+  // wait for it to complete before it is reused.
+  std::shared_ptr<run_impl>
+  start()
+  {
+    auto& s = slots[next];
+    if (s.started)
+      s.run->wait(std::chrono::milliseconds(0));
+
+    sync(s);
+    s.run->start();
+    s.started = true;
+    next = (next + 1) % slots.size();
+    return s.run;
+  }
+};
+
 // struct run_update_type - RTP update
 //
 // Asynchronous runtime update of kernel arguments.  Each argument is
@@ -1830,7 +2193,7 @@ public:
   run_update_type(run_impl* r)
     : run(r)
     , kernel(run->get_kernel())
-    , cmd(std::make_shared<kernel_command>(kernel->get_device()))
+    , cmd(std::make_shared<kernel_command>(kernel->get_device(), kernel->get_exec_buf_size()))
   {
     auto kcmd = cmd->get_ert_cmd<ert_init_kernel_cmd*>();
     auto rcmd = run->get_ert_cmd<ert_start_kernel_cmd*>();
@@ -2343,6 +2706,87 @@ get_ert_packet() const
   });
 }
 
+run_batch::
+run_batch()
+  : handle(std::make_shared<run_batch_impl>())
+{}
+
+run_batch::
+run_batch(const std::vector<xrt::run>& runs)
+  : handle(std::make_shared<run_batch_impl>())
+{
+  for (auto& run : runs)
+    handle->add(run.get_handle());
+}
+
+void
+run_batch::
+add(const xrt::run& run)
+{
+  handle->add(run.get_handle());
+}
+
+size_t
+run_batch::
+size() const
+{
+  return handle->size();
+}
+
+void
+run_batch::
+start()
+{
+  xdp::native::profiling_wrapper("xrt::run_batch::start", [this]{
+    handle->start();
+  });
+}
+
+ert_cmd_state
+run_batch::
+wait(const std::chrono::milliseconds& timeout_ms) const
+{
+  return xdp::native::profiling_wrapper("xrt::run_batch::wait",
+    [this, &timeout_ms] {
+      return handle->wait(timeout_ms);
+    });
+}
+
+run_template::
+run_template(const xrt::run& run, size_t depth)
+  : handle(std::make_shared<run_template_impl>(run.get_handle(), depth))
+{}
+
+size_t
+run_template::
+depth() const
+{
+  return handle->depth();
+}
+
+void
+run_template::
+set_arg_at_index(int index, const void* value, size_t bytes)
+{
+  handle->set_arg_at_index(index, value, bytes);
+}
+
+void
+run_template::
+set_arg_at_index(int index, const xrt::bo& glb)
+{
+  handle->set_arg_at_index(index, glb);
+}
+
+xrt::run
+run_template::
+start()
+{
+  return xdp::native::profiling_wrapper("xrt::run_template::start", [this]{
+    return xrt::run(handle->start());
+  });
+}
+
 kernel::
 kernel(const xrt::device& xdev, const xrt::uuid& xclbin_id, const std::string& name, cu_access_mode mode)
   : handle(xdp::native::profiling_wrapper("xrt::kernel::kernel",
@@ -22,10 +22,15 @@
 
 #include "core/common/debug.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <vector>
-#include <functional>
-#include <algorithm>
 
 #ifdef _WIN32
 # pragma warning( disable : 4244 )
@@ -37,16 +42,153 @@ namespace {
 
 namespace xrt {
 
+// class pipeline_impl - insulated implementation of xrt::pipeline
+//
+// Stages are stored in a deque such that references returned by
+// add_stage remain valid when more stages are added.
+//
+// Bounded pipelining is implemented by event dependencies.  Each
+// stage keeps a ring of the events of its most recent iterations.
+// Stage function of iteration 'i' is enqueued with a dependency on
+// the previous stage of iteration 'i' and on the same stage of
+// iteration 'i - stage depth'.  The pipeline itself keeps a ring of
+// the completion events of the last stage, execute() waits for the
+// oldest iteration to complete before a new iteration is started.
+//
+// Statistics and error state are shared with enqueued stage
+// functions, which may still be in flight when the pipeline is
+// destructed.
 class pipeline_impl : public std::enable_shared_from_this<pipeline_impl>
 {
+  using clock = std::chrono::steady_clock;
+
+  // Statistics are updated from event handler threads
+  struct stage_stats
+  {
+    std::mutex mutex;
+    uint64_t iterations = 0;
+    clock::duration total_latency {0};
+    clock::duration max_latency {0};
+    clock::time_point first_start = clock::time_point::max();
+    clock::time_point last_done;
+
+    void
+    record(clock::time_point start, clock::time_point done)
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      ++iterations;
+      auto latency = done - start;
+      total_latency += latency;
+      max_latency = std::max(max_latency, latency);
+      first_start = std::min(first_start, start);
+      last_done = std::max(last_done, done);
+    }
+  };
+
+  // First exception thrown by a stage function, updated from event
+  // handler threads.  Once set, stage functions are skipped by
+  // throwing the exception again before they are called.
+  struct error_state
+  {
+    std::mutex mutex;
+    std::exception_ptr error;
+    std::atomic<bool> failed {false};
+
+    void
+    set(std::exception_ptr ex)
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      if (error)
+        return;
+      error = ex;
+      failed = true;
+    }
+
+    std::exception_ptr
+    get()
+    {
+      if (!failed)
+        return nullptr;
+      std::lock_guard<std::mutex> lk(mutex);
+      return error;
+    }
+
+    void
+    check()
+    {
+      if (auto ex = get())
+        std::rethrow_exception(ex);
+    }
+  };
+
+  struct stage_entry
+  {
+    pipeline::stage stage;
+    std::vector<xrt::event> ring;   // events of most recent iterations
+    std::shared_ptr<stage_stats> stats = std::make_shared<stage_stats>();
+
+    explicit
+    stage_entry(pipeline::stage&& s)
+      : stage(std::move(s))
+    {}
+  };
+
   event_queue m_queue;
   unsigned long m_uid;
-  std::vector<pipeline::stage> m_stages;
+  unsigned int m_max_inflight;
+  unsigned long m_iteration = 0;
+  bool m_statistics = false;
+  std::shared_ptr<error_state> m_errors = std::make_shared<error_state>();
+  std::deque<stage_entry> m_stages;
+  std::vector<xrt::event> m_inflight; // last stage event per ring slot
+  std::mutex m_mutex;                 // serialize execute()
+
+  static double
+  to_us(clock::duration d)
+  {
+    return std::chrono::duration<double, std::micro>(d).count();
+  }
+
+  // Number of concurrent iterations of argument stage
+  unsigned int
+  get_stage_depth(const stage_entry& entry) const
+  {
+    auto depth = entry.stage.get_max_inflight();
+    if (!depth || (m_max_inflight && depth > m_max_inflight))
+      depth = m_max_inflight;
+    return depth;
+  }
+
+  // Enqueue a stage for an iteration.  The stage function is skipped
+  // if the pipeline has failed.  With statistics enabled a
+  // bookkeeping event records completion of a started stage.
+  xrt::event
+  enqueue_stage(stage_entry& entry, const std::vector<xrt::event>& deps, unsigned int slot)
+  {
+    auto errors = m_errors;
+    auto on_error = [errors](std::exception_ptr ex) { errors->set(ex); };
+    if (!m_statistics)
+      return entry.stage.enqueue(m_queue, deps, slot, [errors] { errors->check(); }, on_error);
+
+    auto start = std::make_shared<clock::time_point>();
+    auto on_start = [errors, start] {
+      errors->check();
+      *start = clock::now();
+    };
+    auto event = entry.stage.enqueue(m_queue, deps, slot, on_start, on_error);
+    auto stats = entry.stats;
+    return m_queue.enqueue_with_waitlist([stats, start] {
+      if (*start != clock::time_point())
+        stats->record(*start, clock::now());
+    }, {event});
+  }
 
 public:
   // Construct the pipeline implementation
-  pipeline_impl(const xrt::event_queue& q)
+  pipeline_impl(const xrt::event_queue& q, unsigned int max_inflight)
     : m_queue(q)
+    , m_max_inflight(max_inflight)
+    , m_inflight(max_inflight)
   {
     static unsigned int count = 0;
     m_uid = count++;
@@ -62,16 +204,77 @@ public:
   xrt::event
   execute(xrt::event event)
   {
-    for (auto& s : m_stages)
-      event = s.enqueue(m_queue, {event});
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_errors->check();
+    auto iteration = m_iteration++;
+    unsigned int slot = m_max_inflight ? iteration % m_max_inflight : 0;
+
+    // back-pressure, wait for oldest iteration using this slot
+    if (m_max_inflight)
+      m_inflight[slot].wait();
+
+    for (auto& entry : m_stages) {
+      std::vector<xrt::event> deps {event};
+      auto depth = get_stage_depth(entry);
+      if (depth) {
+        if (entry.ring.size() != depth)
+          entry.ring.resize(depth);
+        deps.push_back(entry.ring[iteration % depth]);
+      }
+
+      event = enqueue_stage(entry, deps, slot);
+
+      if (depth)
+        entry.ring[iteration % depth] = event;
+    }
+
+    if (m_max_inflight)
+      m_inflight[slot] = event;
+
     return event;
   }
 
-  const pipeline::stage&
+  pipeline::stage&
   add_stage(pipeline::stage&& s)
   {
-    m_stages.push_back(std::move(s));
-    return m_stages.back(); // bug, cannot return reference (vector resize)
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_stages.emplace_back(std::move(s));
+    return m_stages.back().stage;
+  }
+
+  std::exception_ptr
+  get_error() const
+  {
+    return m_errors->get();
+  }
+
+  void
+  enable_statistics(bool enable)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_statistics = enable;
+  }
+
+  std::vector<pipeline::stage_statistics>
+  get_statistics()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    std::vector<pipeline::stage_statistics> result;
+    for (auto& entry : m_stages) {
+      auto& stats = *entry.stats;
+      std::lock_guard<std::mutex> slk(stats.mutex);
+      pipeline::stage_statistics value;
+      value.iterations = stats.iterations;
+      if (stats.iterations) {
+        value.avg_latency_us = to_us(stats.total_latency) / stats.iterations;
+        value.max_latency_us = to_us(stats.max_latency);
+        auto elapsed = to_us(stats.last_done - stats.first_start);
+        if (elapsed > 0)
+          value.throughput = stats.iterations * 1000000.0 / elapsed;
+      }
+      result.push_back(value);
+    }
+    return result;
   }
 };
 
@@ -85,7 +288,12 @@ namespace xrt {
 
 pipeline::
 pipeline(const xrt::event_queue& q)
-  : m_impl(std::make_shared<pipeline_impl>(q))
+  : m_impl(std::make_shared<pipeline_impl>(q, 0))
+{}
+
+pipeline::
+pipeline(const xrt::event_queue& q, unsigned int max_inflight)
+  : m_impl(std::make_shared<pipeline_impl>(q, max_inflight))
 {}
 
 xrt::event
@@ -95,13 +303,34 @@ execute(xrt::event event)
   return m_impl->execute(event);
 }
 
-const pipeline::stage&
+pipeline::stage&
 pipeline::
 add_stage(pipeline::stage&& s)
 {
   return m_impl->add_stage(std::move(s));
 }
 
+void
+pipeline::
+enable_statistics(bool enable)
+{
+  m_impl->enable_statistics(enable);
+}
+
+std::vector<pipeline::stage_statistics>
+pipeline::
+get_statistics() const
+{
+  return m_impl->get_statistics();
+}
+
+std::exception_ptr
+pipeline::
+get_error() const
+{
+  return m_impl->get_error();
+}
+
 
   
   
@@ -33,6 +33,7 @@
 #include "native_profile.h"
 
 #include <fstream>
+#include <memory>
 #include <set>
 #include <vector>
 
@@ -41,6 +42,10 @@
 # pragma warning( disable : 4244 4267 4996)
 #else
 # include <linux/uuid.h>
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <unistd.h>
 #endif
 
 namespace {
@@ -88,6 +93,35 @@ read_xclbin(const std::string& fnm)
   return header;
 }
 
+// Map xclbin file read-only into memory.  Returns nullptr if the
+// file cannot be mapped in which case caller should read the file.
+static std::shared_ptr<const char>
+map_xclbin(const std::string& fnm, size_t& size)
+{
+#ifndef _WIN32
+  int fd = open(fnm.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return nullptr;
+
+  struct stat st;
+  if (fstat(fd, &st) || static_cast<size_t>(st.st_size) < sizeof(axlf)) {
+    close(fd);
+    return nullptr;
+  }
+
+  size = st.st_size;
+  auto addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);  // mapping stays valid
+  if (addr == MAP_FAILED)
+    return nullptr;
+
+  auto length = size;
+  return {static_cast<const char*>(addr), [length](const char* p) { munmap(const_cast<char*>(p), length); }};
+#else
+  return nullptr;
+#endif
+}
+
 static std::vector<char>
 copy_axlf(const axlf* top)
 {
@@ -512,17 +546,51 @@ public:
 //
 // A full xclbin is constructed from a file on disk or from a complete
 // binary images for file content
+//
+// Sections are referenced in place in the xclbin image through an
+// index built from the section headers.  When constructed from a
+// file with Runtime.xclbin_mmap, the image is memory mapped and the
+// section data is not read until it is accessed.
 class xclbin_full : public xclbin_impl
 {
-  std::vector<char> m_axlf;  // complete copy of xclbin raw data
+  std::vector<char> m_axlf;            // complete copy of xclbin raw data
+  std::shared_ptr<const char> m_map;   // or memory mapped xclbin file
+  size_t m_map_size = 0;
   const axlf* m_top;
   uuid m_uuid;
+
+  // sections created for sw_emu or copied for alignment
   std::map<axlf_section_kind, std::vector<char>> m_axlf_sections;
 
+  // section data by kind, referencing image or m_axlf_sections
+  std::map<axlf_section_kind, std::pair<const char*, size_t>> m_section_index;
+
+  const char*
+  get_image() const
+  {
+    return m_map ? m_map.get() : m_axlf.data();
+  }
+
+  size_t
+  get_image_size() const
+  {
+    return m_map ? m_map_size : m_axlf.size();
+  }
+
+  void
+  add_section(axlf_section_kind kind, std::vector<char> data)
+  {
+    auto pos = m_axlf_sections.emplace(kind, std::move(data));
+    auto& sdata = (pos.first)->second;
+    m_section_index.emplace(kind, std::make_pair(sdata.data(), sdata.size()));
+  }
+
   void
   init_axlf()
   {
-    const axlf* tmp = reinterpret_cast<const axlf*>(m_axlf.data());
+    if (get_image_size() < sizeof(axlf))
+      throw std::runtime_error("Invalid xclbin");
+    const axlf* tmp = reinterpret_cast<const axlf*>(get_image());
     if (strncmp(tmp->m_magic, "xclbin2", 7)) // Future: Do not hardcode "xclbin2"
       throw std::runtime_error("Invalid xclbin");
     m_top = tmp;
@@ -540,26 +608,45 @@ class xclbin_full : public xclbin_impl
       if (!hdr && is_sw_emulation() && !xrt_core::config::get_feature_toggle("Runtime.vitis715")) {
         auto data = xrt_core::xclbin::swemu::get_axlf_section(m_top, ip_layout, kind);
         if (!data.empty()) {
-          auto pos = m_axlf_sections.emplace(kind, std::move(data));
+          add_section(kind, std::move(data));
           if (kind == IP_LAYOUT)
-            ip_layout = reinterpret_cast<const ::ip_layout*>((pos.first)->second.data());
+            ip_layout = reinterpret_cast<const ::ip_layout*>(m_section_index[kind].first);
         }
       }
 
       if (!hdr)
         continue;
 
+      if (hdr->m_sectionOffset > get_image_size() || hdr->m_sectionSize > get_image_size() - hdr->m_sectionOffset)
+        throw std::runtime_error("Invalid xclbin, section " + std::to_string(kind) + " exceeds xclbin size");
+
+      // section structs are accessed in place, which requires 8 byte
+      // alignment; xclbinutil aligns sections so copies are rare
       auto section_data = reinterpret_cast<const char*>(m_top) + hdr->m_sectionOffset;
-      std::vector<char> data{section_data, section_data + hdr->m_sectionSize};
-      m_axlf_sections.emplace(kind , std::move(data));
+      if (reinterpret_cast<uintptr_t>(section_data) % 8) {
+        add_section(kind, {section_data, section_data + hdr->m_sectionSize});
+        continue;
+      }
+
+      m_section_index.emplace(kind, std::make_pair(section_data, size_t(hdr->m_sectionSize)));
     }
   }
   
 public:
   explicit
   xclbin_full(const std::string& filename)
-    : m_axlf(read_xclbin(filename))
   {
+    if (xrt_core::config::get_xclbin_mmap())
+      m_map = map_xclbin(filename, m_map_size);
+
+    // Image must not extend past end of file or access would fault
+    if (m_map && reinterpret_cast<const axlf*>(m_map.get())->m_header.m_length > m_map_size)
+      m_map.reset();
+
+    // Fall back on reading if mapping is disabled or failed
+    if (!m_map)
+      m_axlf = read_xclbin(filename);
+
     init_axlf();
   }
 
@@ -588,9 +675,9 @@ public:
   std::pair<const char*, size_t>
   get_axlf_section(axlf_section_kind kind) const
   {
-    auto itr = m_axlf_sections.find(kind);
-    return itr != m_axlf_sections.end()
-      ? std::make_pair((*itr).second.data(), (*itr).second.size())
+    auto itr = m_section_index.find(kind);
+    return itr != m_section_index.end()
+      ? (*itr).second
       : std::make_pair(nullptr, size_t(0));
   }
 
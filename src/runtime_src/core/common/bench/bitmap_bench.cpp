@@ -0,0 +1,246 @@
+/**
+ * Copyright (C) 2021 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Per command scheduling overhead of CU mask and slot handling with
+// 128 CUs and 128 command queue slots.
+//
+// Each command goes through the steps that touch CU masks and slots:
+//  - encode_compute_units, std::bitset CU mask to packet words
+//  - sws xocl_cmd, packet words to the command's CU mask
+//  - sws acquire_slot_idx, find a free command queue slot
+//  - sws select_cu with the "first" policy, find a ready CU among the
+//    command's CUs
+//
+// The steps are run with the std::bitset code that xrt_kernel.cpp and
+// sws.cpp used before xrt_core::bitmap, and with xrt_core::bitmap.  Both
+// run the same simulation, most slots are kept busy and CUs stay busy
+// until the simulation needs a ready one, and must pick the same slots
+// and CUs.
+//
+// Usage: bitmap_bench [commands] [CUs per command]
+
+#include "core/common/bitmap.h"
+
+#include <algorithm>
+#include <bitset>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr size_t max_cus = 128;
+constexpr size_t max_slots = 128;
+constexpr size_t num_cumasks = max_cus / 32;
+constexpr size_t busy_slots = 96;
+constexpr size_t no_index = SIZE_MAX;
+
+struct bitset_impl
+{
+  using cu_mask_type = std::bitset<max_cus>;
+  std::bitset<max_slots> slot_status;
+
+  static void
+  encode(const std::bitset<max_cus>& cumask, uint32_t* data)
+  {
+    std::fill(data, data + num_cumasks, 0);
+    for (size_t cu_idx = 0; cu_idx < max_cus; ++cu_idx) {
+      if (!cumask.test(cu_idx))
+        continue;
+      auto mask_idx = cu_idx / 32;
+      auto idx_in_mask = cu_idx - mask_idx * 32;
+      data[mask_idx] |= (1 << idx_in_mask);
+    }
+  }
+
+  static cu_mask_type
+  decode(const uint32_t* data)
+  {
+    cu_mask_type cus;
+    cus |= data[0];
+    for (size_t i = 1; i < num_cumasks; ++i) {
+      cu_mask_type mask(data[i]);
+      cus |= (mask << 32 * i);
+    }
+    return cus;
+  }
+
+  size_t
+  acquire_slot_idx()
+  {
+    if (slot_status.all())
+      return no_index;
+    for (size_t idx = 0; idx < max_slots; ++idx) {
+      if (!slot_status.test(idx)) {
+        slot_status.set(idx);
+        return idx;
+      }
+    }
+    return no_index;
+  }
+
+  void
+  release_slot_idx(size_t idx)
+  {
+    slot_status.reset(idx);
+  }
+
+  static size_t
+  find_ready_cu(const cu_mask_type& cus, const bool* ready)
+  {
+    for (size_t cuidx = 0; cuidx < max_cus; ++cuidx)
+      if (cus.test(cuidx) && ready[cuidx])
+        return cuidx;
+    return no_index;
+  }
+};
+
+struct bitmap_impl
+{
+  using cu_mask_type = xrt_core::bitmap<max_cus>;
+  xrt_core::bitmap<max_slots> slot_status;
+
+  static void
+  encode(const std::bitset<max_cus>& cumask, uint32_t* data)
+  {
+    xrt_core::bitmap<max_cus> words(cumask);
+    for (size_t mask_idx = 0; mask_idx < num_cumasks; ++mask_idx)
+      data[mask_idx] = words.get_word32(mask_idx);
+  }
+
+  static cu_mask_type
+  decode(const uint32_t* data)
+  {
+    cu_mask_type cus;
+    for (size_t i = 0; i < num_cumasks; ++i)
+      cus.set_word32(i, data[i]);
+    return cus;
+  }
+
+  size_t
+  acquire_slot_idx()
+  {
+    auto idx = slot_status.find_first_zero(max_slots);
+    if (idx == slot_status.npos)
+      return no_index;
+    slot_status.set(idx);
+    return idx;
+  }
+
+  void
+  release_slot_idx(size_t idx)
+  {
+    slot_status.reset(idx);
+  }
+
+  static size_t
+  find_ready_cu(const cu_mask_type& cus, const bool* ready)
+  {
+    auto cuidx = cus.find_if([ready](size_t idx) { return ready[idx]; });
+    return (cuidx == cus.npos) ? no_index : cuidx;
+  }
+};
+
+// Run the commands through the scheduling steps, returns elapsed ns
+// and a checksum of the selected slots and CUs
+template <typename Impl>
+double
+run(const std::vector<std::bitset<max_cus>>& cmds, uint64_t& checksum)
+{
+  Impl impl;
+  bool ready[max_cus];
+  std::fill(ready, ready + max_cus, true);
+  std::deque<size_t> busy_cus;
+  std::deque<size_t> slots;
+  uint32_t data[num_cumasks];
+  checksum = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (auto& cumask : cmds) {
+    Impl::encode(cumask, data);
+    auto cus = Impl::decode(data);
+
+    // Keep most slots occupied by commands not yet started
+    if (slots.size() == busy_slots) {
+      impl.release_slot_idx(slots.front());
+      slots.pop_front();
+    }
+    auto slot = impl.acquire_slot_idx();
+    slots.push_back(slot);
+
+    // CUs become ready oldest first, only when no CU of the command
+    // is ready
+    auto cu = Impl::find_ready_cu(cus, ready);
+    while (cu == no_index) {
+      ready[busy_cus.front()] = true;
+      busy_cus.pop_front();
+      cu = Impl::find_ready_cu(cus, ready);
+    }
+    ready[cu] = false;
+    busy_cus.push_back(cu);
+
+    checksum = checksum * 31 + slot * max_cus + cu;
+  }
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+int
+main(int argc, char* argv[])
+{
+  size_t num_cmds = (argc > 1) ? std::strtoul(argv[1], nullptr, 0) : 1000000;
+  size_t cus_per_cmd = (argc > 2) ? std::strtoul(argv[2], nullptr, 0) : 16;
+  if (num_cmds == 0 || cus_per_cmd == 0 || cus_per_cmd > max_cus) {
+    std::cerr << "Usage: " << argv[0] << " [commands] [CUs per command 1.." << max_cus << "]\n";
+    return 1;
+  }
+
+  // Commands of 8 kernels, each kernel has cus_per_cmd CUs spread
+  // over the 128 CUs
+  std::mt19937_64 rng(42);
+  std::vector<std::bitset<max_cus>> kernels(8);
+  std::vector<size_t> cu_order(max_cus);
+  for (auto& kernel : kernels) {
+    std::iota(cu_order.begin(), cu_order.end(), 0);
+    std::shuffle(cu_order.begin(), cu_order.end(), rng);
+    for (size_t idx = 0; idx < cus_per_cmd; ++idx)
+      kernel.set(cu_order[idx]);
+  }
+  std::vector<std::bitset<max_cus>> cmds(num_cmds);
+  for (auto& cmd : cmds)
+    cmd = kernels[rng() % kernels.size()];
+
+  uint64_t bitset_sum = 0, bitmap_sum = 0;
+  auto bitset_ns = run<bitset_impl>(cmds, bitset_sum);
+  auto bitmap_ns = run<bitmap_impl>(cmds, bitmap_sum);
+
+  if (bitset_sum != bitmap_sum) {
+    std::cerr << "bitset and bitmap selected different slots or CUs\n";
+    return 1;
+  }
+
+  std::cout << num_cmds << " commands, " << max_cus << " CUs, "
+            << cus_per_cmd << " CUs per command\n"
+            << "std::bitset      " << bitset_ns / num_cmds << " ns/command\n"
+            << "xrt_core::bitmap " << bitmap_ns / num_cmds << " ns/command\n";
+  return 0;
+}
@@ -0,0 +1,283 @@
+/**
+ * Copyright (C) 2021 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef core_common_bitmap_h
+#define core_common_bitmap_h
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _MSC_VER
+# include <intrin.h>
+#endif
+
+namespace xrt_core {
+
+/**
+ * Word level bit operations
+ */
+namespace bitops {
+
+// Index of least significant set bit, word must be non-zero
+inline unsigned int
+ctz(uint64_t word)
+{
+#ifdef _MSC_VER
+  unsigned long idx;
+  _BitScanForward64(&idx, word);
+  return idx;
+#else
+  return __builtin_ctzll(word);
+#endif
+}
+
+// Number of set bits in word
+inline unsigned int
+popcount(uint64_t word)
+{
+#ifdef _MSC_VER
+  return static_cast<unsigned int>(__popcnt64(word));
+#else
+  return __builtin_popcountll(word);
+#endif
+}
+
+} // bitops
+
+/**
+ * class bitmap - fixed size bit map with word level search
+ *
+ * Used for CU masks and command queue slot maps where the scheduler
+ * needs to find a set or clear bit.  Searches examine a 64 bit word
+ * at a time rather than testing bit by bit as std::bitset requires.
+ *
+ * Search functions return npos (== N) when no bit is found.
+ */
+template <size_t N>
+class bitmap
+{
+public:
+  using word_type = uint64_t;
+  static constexpr size_t word_bits = 64;
+  static constexpr size_t num_words = (N + word_bits - 1) / word_bits;
+  static constexpr size_t npos = N;
+
+private:
+  word_type m_words[num_words] = {0};
+
+  static constexpr size_t
+  word_index(size_t pos)
+  {
+    return pos / word_bits;
+  }
+
+  static constexpr word_type
+  bit_mask(size_t pos)
+  {
+    return word_type(1) << (pos % word_bits);
+  }
+
+  // Mask of valid bits in last word
+  static constexpr word_type
+  last_word_mask()
+  {
+    return (N % word_bits) ? (word_type(1) << (N % word_bits)) - 1 : ~word_type(0);
+  }
+
+public:
+  bitmap() = default;
+
+  explicit
+  bitmap(const std::bitset<N>& bs)
+  {
+    const std::bitset<N> low(~0ULL);
+    for (size_t widx = 0; widx < num_words; ++widx)
+      m_words[widx] = ((bs >> (widx * word_bits)) & low).to_ullong();
+  }
+
+  void
+  set(size_t pos)
+  {
+    m_words[word_index(pos)] |= bit_mask(pos);
+  }
+
+  void
+  reset(size_t pos)
+  {
+    m_words[word_index(pos)] &= ~bit_mask(pos);
+  }
+
+  void
+  reset()
+  {
+    for (auto& word : m_words)
+      word = 0;
+  }
+
+  bool
+  test(size_t pos) const
+  {
+    return (m_words[word_index(pos)] & bit_mask(pos)) != 0;
+  }
+
+  bool
+  any() const
+  {
+    for (auto word : m_words)
+      if (word)
+        return true;
+    return false;
+  }
+
+  bool
+  none() const
+  {
+    return !any();
+  }
+
+  size_t
+  count() const
+  {
+    size_t cnt = 0;
+    for (auto word : m_words)
+      cnt += bitops::popcount(word);
+    return cnt;
+  }
+
+  // First set bit at or after pos
+  size_t
+  find_next(size_t pos) const
+  {
+    if (pos >= N)
+      return npos;
+
+    auto widx = word_index(pos);
+    auto word = m_words[widx] & (~word_type(0) << (pos % word_bits));
+    while (!word) {
+      if (++widx == num_words)
+        return npos;
+      word = m_words[widx];
+    }
+    auto idx = widx * word_bits + bitops::ctz(word);
+    return idx < N ? idx : npos;
+  }
+
+  // First set bit
+  size_t
+  find_first() const
+  {
+    return find_next(0);
+  }
+
+  // First set bit for which pred(pos) is true.  Set bits are visited
+  // in index order a word at a time, which is cheaper than repeated
+  // find_next calls when many bits are set.
+  template <typename Predicate>
+  size_t
+  find_if(Predicate pred) const
+  {
+    for (size_t widx = 0; widx < num_words; ++widx) {
+      for (auto word = m_words[widx]; word; word &= word - 1) {
+        auto idx = widx * word_bits + bitops::ctz(word);
+        if (idx >= N)
+          return npos;
+        if (pred(idx))
+          return idx;
+      }
+    }
+    return npos;
+  }
+
+  // First set bit at or after pos wrapping around to bit 0, used
+  // for round robin selection
+  size_t
+  find_next_wrap(size_t pos) const
+  {
+    auto idx = find_next(pos);
+    return (idx == npos && pos) ? find_next(0) : idx;
+  }
+
+  // First clear bit before limit
+  size_t
+  find_first_zero(size_t limit = N) const
+  {
+    for (size_t widx = 0; widx < num_words && widx * word_bits < limit; ++widx) {
+      auto word = ~m_words[widx];
+      if (widx == num_words - 1)
+        word &= last_word_mask();
+      if (!word)
+        continue;
+      auto idx = widx * word_bits + bitops::ctz(word);
+      return idx < limit ? idx : npos;
+    }
+    return npos;
+  }
+
+  // Get 32 bit word, as used in command packet CU masks
+  uint32_t
+  get_word32(size_t idx) const
+  {
+    return static_cast<uint32_t>(m_words[idx / 2] >> ((idx % 2) * 32));
+  }
+
+  // Or in 32 bit word, as used in command packet CU masks
+  void
+  set_word32(size_t idx, uint32_t value)
+  {
+    m_words[idx / 2] |= word_type(value) << ((idx % 2) * 32);
+  }
+
+  bitmap&
+  operator&= (const bitmap& rhs)
+  {
+    for (size_t widx = 0; widx < num_words; ++widx)
+      m_words[widx] &= rhs.m_words[widx];
+    return *this;
+  }
+
+  bitmap&
+  operator|= (const bitmap& rhs)
+  {
+    for (size_t widx = 0; widx < num_words; ++widx)
+      m_words[widx] |= rhs.m_words[widx];
+    return *this;
+  }
+
+  friend bitmap
+  operator& (bitmap lhs, const bitmap& rhs)
+  {
+    return lhs &= rhs;
+  }
+
+  bool
+  operator== (const bitmap& rhs) const
+  {
+    for (size_t widx = 0; widx < num_words; ++widx)
+      if (m_words[widx] != rhs.m_words[widx])
+        return false;
+    return true;
+  }
+};
+
+// Out of class definitions needed for odr-use prior to C++17
+template <size_t N> constexpr size_t bitmap<N>::word_bits;
+template <size_t N> constexpr size_t bitmap<N>::num_words;
+template <size_t N> constexpr size_t bitmap<N>::npos;
+
+} // xrt_core
+
+#endif
@@ -21,6 +21,10 @@
 #include "device.h"
 #include "ert.h"
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
 #include <vector>
 #include <utility>
 #include <mutex>
@@ -32,91 +36,403 @@
 
 namespace xrt_core {
 
-// Create a cache of CMD BO objects -- for now only used for M2M -- to reduce
-// the overhead of BO life cycle management.
+// Create a cache of CMD BO objects to reduce the overhead of BO life
+// cycle management.
+//
+// BOs are cached per size class.  Each thread using the cache has its
+// own magazine of BOs per size class, which it allocates from and
+// releases to without synchronizing with other threads.  An empty
+// magazine is refilled from, and a full magazine is flushed to, a
+// shared depot per size class, which is a lock free bounded stack.  A
+// BO is allocated from the device only when both the magazine and the
+// depot are empty.
 class bo_cache {
 public:
   // Helper typedef for std::pair. Note the elements are const so that the
   // pair is immutable. The clients should not change the contents of cmd_bo.
   template <typename CommandType>
   using cmd_bo = std::pair<const xclBufferHandle, CommandType *const>;
-private:
+
+  // struct stats - cache statistics
+  //
+  // @hits: allocations served from the cache
+  // @misses: allocations served by allocating a BO from the device
+  // @live: BOs currently allocated from the device
+  // @high_water: max BOs allocated from the device at any point in time
+  struct stats
+  {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t live = 0;
+    uint64_t high_water = 0;
+  };
 
   // We are really allocating a page size as that is what xocl/zocl do. Note on
   // POWER9 pagesize maybe more than 4K, xocl would upsize the allocation to the
-  // correct pagesize. unmap always unmaps the full page.
+  // correct pagesize. unmap always unmaps the full page.  Size classes
+  // double from the page size, larger BOs are not cached.
   static const size_t mBOSize = 4096;
+  static const size_t mNumSizeClasses = 4;  // 4K, 8K, 16K, 32K
+
+private:
+  struct entry
+  {
+    xclBufferHandle handle;
+    void* data;
+  };
+
+  // class depot - Lock free bounded stack of BOs
+  //
+  // Nodes are preallocated and linked by index.  A stack head packs a
+  // node index with a tag that is incremented on every update to
+  // avoid ABA.  Nodes that do not hold a BO are kept on a free stack.
+  class depot
+  {
+    static const uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+    struct node
+    {
+      entry bo;
+      std::atomic<uint32_t> next {npos};
+    };
+
+    std::unique_ptr<node[]> m_nodes;
+    std::atomic<uint64_t> m_full;
+    std::atomic<uint64_t> m_free;
+
+    static uint64_t
+    pack(uint32_t idx, uint32_t tag)
+    {
+      return (static_cast<uint64_t>(tag) << 32) | idx;
+    }
+
+    static uint32_t
+    index(uint64_t head)
+    {
+      return static_cast<uint32_t>(head);
+    }
+
+    static uint32_t
+    tag(uint64_t head)
+    {
+      return static_cast<uint32_t>(head >> 32);
+    }
+
+    uint32_t
+    pop(std::atomic<uint64_t>& head)
+    {
+      auto old = head.load(std::memory_order_acquire);
+      while (index(old) != npos) {
+        auto next = m_nodes[index(old)].next.load(std::memory_order_relaxed);
+        if (head.compare_exchange_weak(old, pack(next, tag(old) + 1),
+                                       std::memory_order_acquire, std::memory_order_acquire))
+          return index(old);
+      }
+      return npos;
+    }
+
+    void
+    push(std::atomic<uint64_t>& head, uint32_t idx)
+    {
+      auto old = head.load(std::memory_order_relaxed);
+      do {
+        m_nodes[idx].next.store(index(old), std::memory_order_relaxed);
+      } while (!head.compare_exchange_weak(old, pack(idx, tag(old) + 1),
+                                           std::memory_order_release, std::memory_order_relaxed));
+    }
+
+  public:
+    explicit
+    depot(size_t capacity)
+      : m_nodes(std::make_unique<node[]>(capacity))
+      , m_full(pack(npos, 0))
+      , m_free(pack(npos, 0))
+    {
+      for (uint32_t idx = 0; idx < capacity; ++idx)
+        push(m_free, idx);
+    }
+
+    // Add a BO, returns false if depot is full
+    bool
+    put(const entry& bo)
+    {
+      auto idx = pop(m_free);
+      if (idx == npos)
+        return false;
+      m_nodes[idx].bo = bo;
+      push(m_full, idx);
+      return true;
+    }
+
+    // Remove a BO, returns false if depot is empty
+    bool
+    get(entry& bo)
+    {
+      auto idx = pop(m_full);
+      if (idx == npos)
+        return false;
+      bo = m_nodes[idx].bo;
+      push(m_free, idx);
+      return true;
+    }
+  };
+
+  // struct magazine - Per thread BOs of a cache
+  //
+  // A magazine is accessed only by its owning thread.  The mutex
+  // synchronizes the owning thread exiting with the cache being
+  // destroyed, whichever happens first retires the magazine by
+  // clearing its cache pointer.
+  struct magazine
+  {
+    std::mutex mutex;
+    std::atomic<bo_cache*> cache {nullptr};
+    std::vector<entry> bos[mNumSizeClasses];
+    std::atomic<uint64_t> hits {0};
+  };
+
+  // struct thread_magazines - Magazines of the calling thread
+  //
+  // On thread exit, BOs in magazines of live caches are returned to
+  // the depots of the caches.
+  struct thread_magazines
+  {
+    std::vector<std::shared_ptr<magazine>> mags;
+    magazine* last = nullptr;
+
+    ~thread_magazines()
+    {
+      for (auto& mag : mags) {
+        std::lock_guard<std::mutex> lk(mag->mutex);
+        if (auto cache = mag->cache.load())
+          cache->retire(mag.get());
+      }
+    }
+  };
+
   std::shared_ptr<device> mDevice;
-  // Maximum number of BOs that can be cached in the pool. Value of 0 indicates
-  // caching should be disabled.
+  // Maximum number of BOs that can be cached in the depot of a size
+  // class. Value of 0 indicates caching should be disabled.
   const unsigned int mCacheMaxSize;
-  std::vector<cmd_bo<void>> mCmdBOCache;
-  std::mutex mCacheMutex;
+  // Maximum number of BOs in a thread magazine per size class
+  const size_t mMagazineSize;
+  std::unique_ptr<depot> mDepot[mNumSizeClasses];
+
+  // Magazines of all threads, only accessed when a thread first uses
+  // the cache, on thread exit, and when cache is destroyed.
+  std::vector<std::shared_ptr<magazine>> mMagazines;
+  std::mutex mMagazineMutex;
+
+  std::atomic<uint64_t> mRetiredHits {0};
+  std::atomic<uint64_t> mMisses {0};
+  std::atomic<uint64_t> mLive {0};
+  std::atomic<uint64_t> mHighWater {0};
 
 public:
-  bo_cache(xclDeviceHandle handle, unsigned int max_size)
-    : mDevice(get_userpf_device(handle)), mCacheMaxSize(max_size)
-  {}
+  bo_cache(xclDeviceHandle handle, unsigned int max_size, unsigned int prewarm = 0)
+    : mDevice(get_userpf_device(handle))
+    , mCacheMaxSize(max_size)
+    , mMagazineSize(std::min<size_t>(16, max_size))
+  {
+    for (auto& dp : mDepot)
+      dp = std::make_unique<depot>(mCacheMaxSize);
+
+    // Pre-allocate BOs of the smallest size class
+    prewarm = std::min(prewarm, max_size);
+    for (unsigned int count = 0; count < prewarm; ++count)
+      mDepot[0]->put(create(mBOSize));
+  }
 
   ~bo_cache()
   {
-    std::lock_guard<std::mutex> lock(mCacheMutex);
-    for (auto& bo : mCmdBOCache)
-      destroy(bo);
+    {
+      std::lock_guard<std::mutex> lock(mMagazineMutex);
+      for (auto& mag : mMagazines) {
+        std::lock_guard<std::mutex> lk(mag->mutex);
+        if (!mag->cache.load())
+          continue;
+        for (auto& bos : mag->bos)
+          for (auto& bo : bos)
+            destroy(bo);
+        mag->cache = nullptr;
+      }
+    }
+
+    entry bo;
+    for (auto& dp : mDepot)
+      while (dp->get(bo))
+        destroy(bo);
   }
 
   template<typename T>
   cmd_bo<T>
-  alloc()
+  alloc(size_t bytes = mBOSize)
   {
-    auto bo = alloc_impl();
-    return std::make_pair(bo.first, static_cast<T *>(bo.second));
+    auto bo = alloc_impl(bytes);
+    return std::make_pair(bo.handle, static_cast<T *>(bo.data));
   }
 
+  // Release a BO, bytes must be the size the BO was allocated with
   template<typename T>
   void
-  release(cmd_bo<T>& bo)
+  release(cmd_bo<T>& bo, size_t bytes = mBOSize)
+  {
+    release_impl({bo.first, static_cast<void *>(bo.second)}, bytes);
+  }
+
+  // Snapshot of cache statistics
+  stats
+  get_stats()
   {
-    release_impl(std::make_pair(bo.first, static_cast<void *>(bo.second)));
+    stats st;
+    {
+      std::lock_guard<std::mutex> lock(mMagazineMutex);
+      for (auto& mag : mMagazines)
+        st.hits += mag->hits.load(std::memory_order_relaxed);
+    }
+    st.hits += mRetiredHits.load();
+    st.misses = mMisses.load();
+    st.live = mLive.load();
+    st.high_water = mHighWater.load();
+    return st;
   }
 
 private:
-  cmd_bo<void>
-  alloc_impl()
-  {
-    if (mCacheMaxSize) {
-      // If caching is enabled first look up in the BO cache
-      std::lock_guard<std::mutex> lock(mCacheMutex);
-      if (!mCmdBOCache.empty()) {
-        auto bo = mCmdBOCache.back();
-        mCmdBOCache.pop_back();
-        return bo;
-      }
+  static size_t
+  size_class(size_t bytes)
+  {
+    size_t cls = 0;
+    for (auto sz = mBOSize; sz < bytes && cls < mNumSizeClasses; sz <<= 1)
+      ++cls;
+    return cls;
+  }
+
+  // Get the calling thread's magazine for this cache
+  magazine*
+  get_magazine()
+  {
+    static thread_local thread_magazines tm;
+    if (tm.last && tm.last->cache.load(std::memory_order_relaxed) == this)
+      return tm.last;
+
+    for (auto& mag : tm.mags) {
+      if (mag->cache.load(std::memory_order_relaxed) == this)
+        return (tm.last = mag.get());
     }
 
-    auto execHandle = mDevice->alloc_bo(mBOSize, XCL_BO_FLAGS_EXECBUF);
-    return std::make_pair(execHandle, mDevice->map_bo(execHandle, true));
+    // First use of this cache by calling thread, drop magazines of
+    // caches that have since been destroyed
+    tm.mags.erase(std::remove_if(tm.mags.begin(), tm.mags.end(),
+                                 [](const auto& mag) { return mag->cache.load() == nullptr; }),
+                  tm.mags.end());
+
+    auto mag = std::make_shared<magazine>();
+    mag->cache = this;
+    {
+      std::lock_guard<std::mutex> lock(mMagazineMutex);
+      mMagazines.erase(std::remove_if(mMagazines.begin(), mMagazines.end(),
+                                      [](const auto& mag) { return mag->cache.load() == nullptr; }),
+                       mMagazines.end());
+      mMagazines.push_back(mag);
+    }
+    tm.mags.push_back(mag);
+    return (tm.last = mag.get());
   }
 
+  // Return BOs of magazine to depots, called with magazine locked
+  // when owning thread exits
   void
-  release_impl(const cmd_bo<void> &bo)
-  {
-    if (mCacheMaxSize) {
-      // If caching is enabled and BO cache is not fully populated add this the cache
-      std::lock_guard<std::mutex> lock(mCacheMutex);
-      if (mCmdBOCache.size() < mCacheMaxSize) {
-        mCmdBOCache.push_back(bo);
-        return;
-      }
+  retire(magazine* mag)
+  {
+    for (size_t cls = 0; cls < mNumSizeClasses; ++cls)
+      flush(cls, mag->bos[cls], mag->bos[cls].size());
+    mRetiredHits += mag->hits.load();
+    mag->hits = 0;
+    mag->cache = nullptr;
+  }
+
+  // Move up to half a magazine of BOs from depot to magazine
+  void
+  refill(size_t cls, std::vector<entry>& bos)
+  {
+    entry bo;
+    for (size_t count = std::max<size_t>(mMagazineSize / 2, 1); count && mDepot[cls]->get(bo); --count)
+      bos.push_back(bo);
+  }
+
+  // Move count BOs from magazine to depot, BOs that do not fit in
+  // the depot are destroyed
+  void
+  flush(size_t cls, std::vector<entry>& bos, size_t count)
+  {
+    for (; count && !bos.empty(); --count) {
+      if (!mDepot[cls]->put(bos.back()))
+        destroy(bos.back());
+      bos.pop_back();
     }
-    destroy(bo);
+  }
+
+  entry
+  alloc_impl(size_t bytes)
+  {
+    auto cls = size_class(bytes);
+    if (!mCacheMaxSize || cls == mNumSizeClasses)
+      return create(bytes);
+
+    // If caching is enabled first look up in the magazine and depot
+    auto mag = get_magazine();
+    auto& bos = mag->bos[cls];
+    if (bos.empty())
+      refill(cls, bos);
+
+    if (!bos.empty()) {
+      auto bo = bos.back();
+      bos.pop_back();
+      mag->hits.store(mag->hits.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      return bo;
+    }
+
+    return create(mBOSize << cls);
+  }
+
+  void
+  release_impl(const entry& bo, size_t bytes)
+  {
+    auto cls = size_class(bytes);
+    if (!mCacheMaxSize || cls == mNumSizeClasses) {
+      destroy(bo);
+      return;
+    }
+
+    // If caching is enabled add BO to magazine, make room by moving
+    // half of a full magazine to the depot
+    auto mag = get_magazine();
+    auto& bos = mag->bos[cls];
+    if (bos.size() >= mMagazineSize)
+      flush(cls, bos, mMagazineSize / 2 + 1);
+    bos.push_back(bo);
+  }
+
+  entry
+  create(size_t bytes)
+  {
+    auto execHandle = mDevice->alloc_bo(bytes, XCL_BO_FLAGS_EXECBUF);
+    entry bo {execHandle, mDevice->map_bo(execHandle, true)};
+
+    ++mMisses;
+    auto live = ++mLive;
+    auto high = mHighWater.load();
+    while (live > high && !mHighWater.compare_exchange_weak(high, live))
+      ;
+    return bo;
   }
 
   void
-  destroy(const cmd_bo<void> &bo)
+  destroy(const entry& bo)
   {
-    mDevice->unmap_bo(bo.first, bo.second);
-    mDevice->free_bo(bo.first);
+    mDevice->unmap_bo(bo.handle, bo.data);
+    mDevice->free_bo(bo.handle);
+    --mLive;
   }
 };
 
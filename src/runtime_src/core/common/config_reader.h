@@ -441,6 +441,52 @@ get_kds()
   return value;
 }
 
+/**
+ * Software scheduler (sws) runs one scheduler thread per device
+ * rather than one scheduler thread for all devices.
+ */
+inline bool
+get_sws_per_device()
+{
+  static bool value = detail::get_bool_value("Runtime.sws_per_device",false);
+  return value;
+}
+
+/**
+ * Software scheduler (sws) uses CU interrupts, where supported by
+ * the shim, to wake up when a CU completes.  Polling with adaptive
+ * backoff is used regardless, interrupts only shorten the sleep.
+ */
+inline bool
+get_sws_cu_interrupt()
+{
+  static bool value = detail::get_bool_value("Runtime.sws_cu_interrupt",false);
+  return value;
+}
+
+/**
+ * Record per kernel and per device histograms of command latencies
+ * (submit to start, start to complete, complete to host notify) and
+ * report them when the process exits.
+ */
+inline bool
+get_command_latency()
+{
+  static bool value = detail::get_bool_value("Runtime.command_latency",false);
+  return value;
+}
+
+/**
+ * Software scheduler (sws) policy for choosing among the ready CUs
+ * of a command: first, round_robin, least_outstanding, memory_affinity
+ */
+inline std::string
+get_sws_cu_policy()
+{
+  static std::string value = detail::get_string_value("Runtime.sws_cu_policy","first");
+  return value;
+}
+
 /**
  * Enable / disable embedded runtime scheduler
  */
@@ -553,6 +599,16 @@ get_noop_completion_delay_us()
   return delay;
 }
 
+/**
+ * Simulated DMA time of a buffer sync in the noop shim
+ */
+inline unsigned int
+get_noop_dma_delay_us()
+{
+  static unsigned int delay = detail::get_uint_value("Runtime.noop_dma_delay_us", 0);
+  return delay;
+}
+
 /**
  * Set CMD BO cache size. CUrrently it is only used in xclCopyBO()
  */
@@ -563,6 +619,113 @@ get_cmdbo_cache()
   return value;
 }
 
+/**
+ * Max number of exec BOs per size class cached by the native XRT
+ * APIs for each device, and number of exec BOs to pre-allocate
+ * when the device is first used for kernel execution.
+ */
+inline unsigned int
+get_exec_bo_cache()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.exec_bo_cache",128);
+  return value;
+}
+
+inline unsigned int
+get_exec_bo_prewarm()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.exec_bo_prewarm",0);
+  return value;
+}
+
+/**
+ * Buffers of this size or smaller are carved out of larger arena
+ * buffers allocated per memory bank.  Zero disables the arena.
+ */
+inline unsigned int
+get_bo_arena_threshold()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.bo_arena_threshold",0);
+  return value;
+}
+
+/**
+ * Size in bytes of each arena buffer allocated from the driver.  The
+ * size is rounded down to a multiple of the size class it serves.
+ */
+inline unsigned int
+get_bo_arena_size()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.bo_arena_size",0x400000);
+  return value;
+}
+
+/**
+ * Cache results of device queries that are marked static or slow
+ * changing in query_requests.h
+ */
+inline bool
+get_query_cache()
+{
+  static bool value = detail::get_bool_value("Runtime.query_cache",false);
+  return value;
+}
+
+/**
+ * Time to live in milliseconds of cached slow changing query results
+ */
+inline unsigned int
+get_query_cache_ttl()
+{
+  static unsigned int value = detail::get_uint_value("Runtime.query_cache_ttl",1000);
+  return value;
+}
+
+/**
+ * Root of the sysfs tree scanned for devices.  Can point at a
+ * synthetic tree for testing device enumeration.
+ */
+inline std::string
+get_sysfs_root()
+{
+  static std::string value = detail::get_string_value("Runtime.sysfs_root","/sys");
+  return value;
+}
+
+/**
+ * Keep sysfs entries open after first read and re-read them with
+ * pread at offset zero
+ */
+inline bool
+get_sysfs_persistent_fd()
+{
+  static bool value = detail::get_bool_value("Runtime.sysfs_persistent_fd",false);
+  return value;
+}
+
+/**
+ * Memory map xclbin files constructed from a filename rather than
+ * reading them into memory.  Sections are paged in on first access.
+ */
+inline bool
+get_xclbin_mmap()
+{
+  static bool value = detail::get_bool_value("Runtime.xclbin_mmap",false);
+  return value;
+}
+
+/**
+ * Directory in which parsed kernel meta data is persisted per xclbin
+ * for reuse by other processes of the same XRT build.  Empty disables
+ * the disk cache.
+ */
+inline std::string
+get_kernel_metadata_cache_dir()
+{
+  static std::string value = detail::get_string_value("Runtime.kernel_metadata_cache_dir","");
+  return value;
+}
+
 inline std::string
 get_hw_em_driver()
 {
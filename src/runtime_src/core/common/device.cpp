@@ -54,6 +54,8 @@ namespace xrt_core {
 device::
 device(id_type device_id)
   : m_device_id(device_id)
+  , m_query_cache_enabled(config::get_query_cache())
+  , m_query_cache(std::chrono::milliseconds(config::get_query_cache_ttl()))
 {
   XRT_DEBUGF("xrt_core::device::device(0x%x) idx(%d)\n", this, device_id);
 }
@@ -83,6 +85,54 @@ is_nodma() const
   return *m_nodma;
 }
 
+boost::any
+device::
+cached_query(const query::request& qr, query::key_type key, query::freshness fresh) const
+{
+  return m_query_cache.get(key, fresh, [&qr, this] { return qr.get(this); });
+}
+
+void
+device::
+enable_query_cache(bool enable)
+{
+  m_query_cache_enabled = enable;
+  if (!enable)
+    clear_query_cache();
+}
+
+void
+device::
+set_query_ttl(query::key_type key, std::chrono::milliseconds ttl)
+{
+  m_query_cache.set_ttl(key, ttl);
+}
+
+void
+device::
+clear_query_cache() const
+{
+  m_query_cache.clear();
+}
+
+void
+device::
+clear_query_cache(query::key_type key) const
+{
+  m_query_cache.clear(key);
+}
+
+device::query_cache_stats
+device::
+get_query_cache_stats() const
+{
+  auto cs = m_query_cache.get_stats();
+  query_cache_stats stats;
+  stats.hits = cs.hits;
+  stats.misses = cs.misses;
+  return stats;
+}
+
 uuid
 device::
 get_xclbin_uuid() const
@@ -158,6 +208,9 @@ register_axlf(const axlf* top)
   if (!m_xclbin || m_xclbin.get_uuid() != uuid(top->m_header.uuid))
       m_xclbin = xrt::xclbin{top};
 
+  // slow changing queries reflect the new xclbin
+  clear_query_cache();
+
   // encode / compress memory connections, a mapping from mem_topology
   // memory index to encoded index.  The compressed indices facilitate
   // small sized std::bitset for representing kernel argument connectivity
@@ -22,6 +22,7 @@
 #include "error.h"
 #include "ishim.h"
 #include "query.h"
+#include "query_cache.h"
 #include "query_reset.h"
 #include "scope_guard.h"
 #include "uuid.h"
@@ -29,6 +30,8 @@
 #include "core/include/xrt.h"
 #include "core/include/experimental/xrt_xclbin.h"
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <vector>
 #include <string>
@@ -157,7 +160,9 @@ public:
   query() const
   {
     auto& qr = lookup_query(QueryRequestType::key);
-    return qr.get(this);
+    if (!m_query_cache_enabled)
+      return qr.get(this);
+    return cached_query(qr, QueryRequestType::key, query::request_freshness<QueryRequestType>::value);
   }
 
   /**
@@ -175,6 +180,13 @@ public:
     return qr.get(this, std::forward<Args>(args)...);
   }
 
+private:
+  // Look up query in cache, calls the query request on a miss.
+  XRT_CORE_COMMON_EXPORT
+  boost::any
+  cached_query(const query::request& qr, query::key_type key, query::freshness fresh) const;
+
+public:
   /**
    * update() - Update a given property for this device
    *
@@ -186,9 +198,65 @@ public:
   update(Args&&... args) const
   {
     auto& qr = lookup_query(QueryRequestType::key);
-    return qr.put(this, std::forward<Args>(args)...);
+    qr.put(this, std::forward<Args>(args)...);
+    if (m_query_cache_enabled)
+      clear_query_cache(QueryRequestType::key);
   }
 
+  /**
+   * struct query_cache_stats - hit and miss counters of query cache
+   */
+  struct query_cache_stats
+  {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+  };
+
+  /**
+   * enable_query_cache() - Enable or disable caching of query results
+   *
+   * The cache is enabled by default per xrt.ini Runtime.query_cache.
+   * Only queries without arguments are cached.  Disabling the cache
+   * clears it.
+   */
+  XRT_CORE_COMMON_EXPORT
+  void
+  enable_query_cache(bool enable);
+
+  /**
+   * set_query_ttl() - Override the time to live of a cached query
+   *
+   * @key: The query request to override
+   * @ttl: Time to live of cached value, zero disables caching of key
+   *
+   * By default static queries live forever, slow changing queries
+   * live per xrt.ini Runtime.query_cache_ttl, and volatile queries
+   * are not cached.
+   */
+  XRT_CORE_COMMON_EXPORT
+  void
+  set_query_ttl(query::key_type key, std::chrono::milliseconds ttl);
+
+  /**
+   * clear_query_cache() - Drop cached query results
+   *
+   * Called when device state changes, e.g. after xclbin load or reset.
+   */
+  XRT_CORE_COMMON_EXPORT
+  void
+  clear_query_cache() const;
+
+  XRT_CORE_COMMON_EXPORT
+  void
+  clear_query_cache(query::key_type key) const;
+
+  /**
+   * get_query_cache_stats() - Get hit and miss counters of query cache
+   */
+  XRT_CORE_COMMON_EXPORT
+  query_cache_stats
+  get_query_cache_stats() const;
+
   /**
    * load_xclbin() - Load an xclbin object on this device
    *
@@ -334,6 +402,10 @@ public:
   id_type m_device_id;
   mutable boost::optional<bool> m_nodma = boost::none;
 
+  // Query result cache, see query_cache.h
+  std::atomic<bool> m_query_cache_enabled;
+  mutable query::cache m_query_cache;
+
   std::vector<size_t> m_memidx_encoding; // compressed mem_toplogy indices
   xrt::xclbin m_xclbin;                  // currently loaded xclbin
 };
@@ -65,6 +65,21 @@ struct kds_scu_mgmt {
 	char			  name[MAX_CUS][32];
 };
 
+/* How to select a CU when a command could run on more than one CU
+ *
+ * CU_POLICY_USAGE: the CU that was selected the least times
+ * CU_POLICY_QUEUE: the CU with the least commands in flight
+ * CU_POLICY_EXPECTED: the CU expected to complete a new command first,
+ *   which is its commands in flight plus one times its estimated
+ *   execution time
+ */
+enum kds_cu_policy {
+	CU_POLICY_USAGE = 0,
+	CU_POLICY_QUEUE,
+	CU_POLICY_EXPECTED,
+	CU_POLICY_MAX, // always the last one
+};
+
 /* the MSB of cu_refs is used for exclusive flag */
 #define CU_EXCLU_MASK		0x80000000
 struct kds_cu_mgmt {
@@ -76,6 +91,7 @@ struct kds_cu_mgmt {
 	u32			  cu_refs[MAX_CUS];
 	struct cu_stats __percpu *cu_stats;
 	int			  rw_shared;
+	enum kds_cu_policy	  policy;
 };
 
 #define cu_stat_read(cu_mgmt, field) \
@@ -172,7 +188,10 @@ void kds_free_command(struct kds_command *xcmd);
 /* sysfs */
 int store_kds_echo(struct kds_sched *kds, const char *buf, size_t count,
 		   int kds_mode, u32 clients, int *echo);
+int store_kds_cu_policy(struct kds_sched *kds, const char *buf, size_t count);
+ssize_t show_kds_cu_policy(struct kds_sched *kds, char *buf);
 ssize_t show_kds_stat(struct kds_sched *kds, char *buf);
 ssize_t show_kds_custat_raw(struct kds_sched *kds, char *buf);
+ssize_t show_kds_cu_load(struct kds_sched *kds, char *buf);
 ssize_t show_kds_scustat_raw(struct kds_sched *kds, char *buf);
 #endif
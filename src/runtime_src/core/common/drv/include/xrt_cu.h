@@ -225,6 +225,8 @@ struct xrt_cu {
 	struct list_head	  pq;
 	spinlock_t		  pq_lock;
 	u32			  num_pq;
+	/* commands ever submitted, protected by pq_lock */
+	u64			  submitted;
 	/*
 	 * Pending Q is used in thread that is submitting CU cmds.
 	 * Other Qs are used in thread that is completing them.
@@ -240,6 +242,12 @@ struct xrt_cu {
 	/* completed queue */
 	struct list_head	  cq;
 	u32			  num_cq;
+	/* commands ever notified, CU thread only */
+	u64			  completed;
+	/* Execution time estimate, only when track_exec is set */
+	bool			  track_exec;
+	u64			  exec_ewma_ns;
+	u64			  last_done_ns;
 	struct semaphore	  sem;
 	struct semaphore	  sem_cu;
 	void			 *core;
@@ -275,6 +283,29 @@ struct xrt_cu {
 	u32			   max_running;
 };
 
+/**
+ * xrt_cu_inflight() - Number of commands submitted but not yet completed
+ * @xcu: Target XRT CU
+ *
+ * Lockless, the value could be stale by the commands being submitted
+ * or completed at the same time.
+ */
+static inline u32 xrt_cu_inflight(struct xrt_cu *xcu)
+{
+	return (u32)(READ_ONCE(xcu->submitted) - READ_ONCE(xcu->completed));
+}
+
+/**
+ * xrt_cu_exec_time() - Estimated execution time of a command in ns
+ * @xcu: Target XRT CU
+ *
+ * Return: 0 if not tracked or no command completed yet
+ */
+static inline u64 xrt_cu_exec_time(struct xrt_cu *xcu)
+{
+	return READ_ONCE(xcu->exec_ewma_ns);
+}
+
 static inline char *prot2str(enum CU_PROTOCOL prot)
 {
 	switch (prot) {
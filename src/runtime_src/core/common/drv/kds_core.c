@@ -45,6 +45,48 @@ int store_kds_echo(struct kds_sched *kds, const char *buf, size_t count,
 	return count;
 }
 
+static const char *cu_policy_names[CU_POLICY_MAX] = {
+	[CU_POLICY_USAGE]	= "usage",
+	[CU_POLICY_QUEUE]	= "queue",
+	[CU_POLICY_EXPECTED]	= "expected",
+};
+
+int store_kds_cu_policy(struct kds_sched *kds, const char *buf, size_t count)
+{
+	struct kds_cu_mgmt *cu_mgmt = &kds->cu_mgmt;
+	size_t len = count;
+	int policy;
+	int i;
+
+	/* The last character of buf could be '\n' */
+	if (len && buf[len - 1] == '\n')
+		--len;
+
+	for (policy = 0; policy < CU_POLICY_MAX; ++policy) {
+		if (strlen(cu_policy_names[policy]) == len &&
+		    !strncmp(buf, cu_policy_names[policy], len))
+			break;
+	}
+	if (policy == CU_POLICY_MAX)
+		return -EINVAL;
+
+	/* Commands in flight are not affected, no need to check clients */
+	mutex_lock(&cu_mgmt->lock);
+	WRITE_ONCE(cu_mgmt->policy, policy);
+	for (i = 0; i < cu_mgmt->num_cus; ++i)
+		WRITE_ONCE(cu_mgmt->xcus[i]->track_exec,
+			   policy == CU_POLICY_EXPECTED);
+	mutex_unlock(&cu_mgmt->lock);
+
+	return count;
+}
+
+ssize_t show_kds_cu_policy(struct kds_sched *kds, char *buf)
+{
+	return scnprintf(buf, PAGE_SIZE, "%s\n",
+			 cu_policy_names[kds->cu_mgmt.policy]);
+}
+
 /* Each line is a CU, format:
  * "cu_idx kernel_name:cu_name address status usage"
  */
@@ -69,6 +111,32 @@ ssize_t show_kds_custat_raw(struct kds_sched *kds, char *buf)
 	return sz;
 }
 
+/* Each line is a CU, format:
+ * "cu_idx,inflight,exec_time"
+ *
+ * inflight is the number of commands submitted to the CU and not yet
+ * completed, exec_time is the estimated execution time in ns, 0 unless
+ * the CU selection policy is "expected".
+ */
+ssize_t show_kds_cu_load(struct kds_sched *kds, char *buf)
+{
+	struct kds_cu_mgmt *cu_mgmt = &kds->cu_mgmt;
+	struct xrt_cu *xcu = NULL;
+	char *cu_fmt = "%d,%u,%llu\n";
+	ssize_t sz = 0;
+	int i;
+
+	mutex_lock(&cu_mgmt->lock);
+	for (i = 0; i < cu_mgmt->num_cus; ++i) {
+		xcu = cu_mgmt->xcus[i];
+		sz += scnprintf(buf+sz, PAGE_SIZE - sz, cu_fmt, i,
+				xrt_cu_inflight(xcu), xrt_cu_exec_time(xcu));
+	}
+	mutex_unlock(&cu_mgmt->lock);
+
+	return sz;
+}
+
 /* Each line is a PS kernel, format:
  * "idx kernel_name status usage"
  */
@@ -115,6 +183,8 @@ ssize_t show_kds_stat(struct kds_sched *kds, char *buf)
 			kds->cu_intr_cap);
 	sz += scnprintf(buf+sz, PAGE_SIZE - sz, "Interrupt mode: %s\n",
 			(kds->cu_intr)? "cu" : "ert");
+	sz += scnprintf(buf+sz, PAGE_SIZE - sz, "CU selection policy: %s\n",
+			cu_policy_names[cu_mgmt->policy]);
 	sz += scnprintf(buf+sz, PAGE_SIZE - sz, "Number of CUs: %d\n",
 			cu_mgmt->num_cus);
 	for (i = 0; i < cu_mgmt->num_cus; ++i) {
@@ -183,6 +253,66 @@ kds_scu_config(struct kds_scu_mgmt *scu_mgmt, struct kds_command *xcmd)
 	return 0;
 }
 
+/**
+ * cu_expected_cost - Cost of submitting one more command to a CU
+ *
+ * @xcu: CU
+ * @expected: weight by the estimated execution time
+ *
+ * Returns: (commands in flight + 1), times the estimated execution time
+ * if expected is set and the CU has an estimate.
+ */
+static inline u64
+cu_expected_cost(struct xrt_cu *xcu, bool expected)
+{
+	u64 cost = xrt_cu_inflight(xcu) + 1;
+	u64 exec_time;
+
+	if (!expected)
+		return cost;
+
+	/* No estimate until a command is done, the CU is likely idle */
+	exec_time = xrt_cu_exec_time(xcu);
+	return (exec_time) ? cost * exec_time : cost;
+}
+
+/**
+ * select_cu_by_cost - Get CU with minimum expected cost
+ *
+ * @cu_mgmt: KDS CU management struct
+ * @valid_cus: Candidate CU indexes
+ * @num_valid: Number of candidates
+ * @expected: weight by the estimated execution time
+ *
+ * Ties are broken by minimum usage.
+ */
+static uint8_t
+select_cu_by_cost(struct kds_cu_mgmt *cu_mgmt, uint8_t *valid_cus,
+		  int num_valid, bool expected)
+{
+	uint8_t index = valid_cus[0];
+	u64 min_cost = U64_MAX;
+	u64 min_usage = 0;
+	u64 usage;
+	u64 cost;
+	int i;
+
+	for (i = 0; i < num_valid; ++i) {
+		cost = cu_expected_cost(cu_mgmt->xcus[valid_cus[i]], expected);
+		if (cost > min_cost)
+			continue;
+
+		usage = cu_stat_read(cu_mgmt, usage[valid_cus[i]]);
+		if (cost < min_cost || usage < min_usage) {
+			index = valid_cus[i];
+			min_cost = cost;
+			min_usage = usage;
+		}
+	}
+
+	return index;
+}
+
 /**
  * acquire_cu_idx - Get ready CU index
  *
@@ -228,12 +358,21 @@ acquire_cu_idx(struct kds_cu_mgmt *cu_mgmt, struct kds_command *xcmd)
 		return -EINVAL;
 	}
 
-	/* Find out the CU with minimum usage */
-	for (i = 1, index = valid_cus[0]; i < num_valid; ++i) {
-		usage = cu_stat_read(cu_mgmt, usage[valid_cus[i]]);
-		min_usage = cu_stat_read(cu_mgmt, usage[index]);
-		if (usage < min_usage)
-			index = valid_cus[i];
+	switch (READ_ONCE(cu_mgmt->policy)) {
+	case CU_POLICY_QUEUE:
+		index = select_cu_by_cost(cu_mgmt, valid_cus, num_valid, false);
+		break;
+	case CU_POLICY_EXPECTED:
+		index = select_cu_by_cost(cu_mgmt, valid_cus, num_valid, true);
+		break;
+	default:
+		/* Find out the CU with minimum usage */
+		for (i = 1, index = valid_cus[0]; i < num_valid; ++i) {
+			usage = cu_stat_read(cu_mgmt, usage[valid_cus[i]]);
+			min_usage = cu_stat_read(cu_mgmt, usage[index]);
+			if (usage < min_usage)
+				index = valid_cus[i];
+		}
 	}
 
 out:
@@ -466,6 +605,7 @@ int kds_init_sched(struct kds_sched *kds)
 	/* At this point, I don't know if ERT subdev exist or not */
 	kds->ert_disable = true;
 	kds->ini_disable = false;
+	kds->cu_mgmt.policy = CU_POLICY_USAGE;
 	init_completion(&kds->comp);
 
 	return 0;
@@ -757,6 +897,8 @@ int kds_add_cu(struct kds_sched *kds, struct xrt_cu *xcu)
 	if (cu_mgmt->num_cus >= MAX_CUS)
 		return -ENOMEM;
 
+	xcu->track_exec = (cu_mgmt->policy == CU_POLICY_EXPECTED);
+
 	/* Determin CUs ordering:
 	 * Sort CU in interrupt ID increase order.
 	 * If interrupt ID is the same, sort CU in address
@@ -0,0 +1,242 @@
+// SPDX-License-Identifier: GPL-2.0 OR Apache-2.0
+/*
+ * Simulated CU for userspace KDS simulation
+ *
+ * Copyright (C) 2021 Xilinx, Inc. All rights reserved.
+ *
+ * This file is dual-licensed; you may select either the GNU General Public
+ * License version 2 or Apache License, Version 2.0.
+ */
+
+#include <math.h>
+#include "cu_sim.h"
+
+/* The simulated CU behaves as an HLS CU with a task queue of
+ * max_credits entries.  Tasks execute one after another, each for a
+ * time drawn from the CU's distribution, so a task queued behind
+ * another starts when the previous one is done.  A task is reported
+ * done and ready by check() once its end time has passed.
+ *
+ * All functions are called from the CU thread only.
+ */
+
+static u64 sim_rand(struct xrt_cu_sim *cu_sim)
+{
+	/* xorshift64* */
+	cu_sim->rng ^= cu_sim->rng >> 12;
+	cu_sim->rng ^= cu_sim->rng << 25;
+	cu_sim->rng ^= cu_sim->rng >> 27;
+	return cu_sim->rng * 0x2545F4914F6CDD1DULL;
+}
+
+/* Uniform in (0, 1) */
+static double sim_rand_unit(struct xrt_cu_sim *cu_sim)
+{
+	return ((sim_rand(cu_sim) >> 11) + 0.5) / (double)(1ULL << 53);
+}
+
+static u64 sim_sample(struct xrt_cu_sim *cu_sim)
+{
+	struct sim_dist *dist = &cu_sim->dist;
+	double val;
+
+	switch (dist->type) {
+	case SIM_UNIFORM:
+		return dist->a + (u64)(sim_rand_unit(cu_sim) * (dist->b - dist->a));
+	case SIM_EXP:
+		return (u64)(-log(sim_rand_unit(cu_sim)) * dist->a);
+	case SIM_NORMAL:
+		/* Box-Muller, negative times are clamped to 0 */
+		val = sqrt(-2.0 * log(sim_rand_unit(cu_sim))) *
+		      cos(2.0 * M_PI * sim_rand_unit(cu_sim));
+		val = dist->a + val * dist->b;
+		return (val > 0) ? (u64)val : 0;
+	case SIM_CONST:
+	default:
+		return dist->a;
+	}
+}
+
+/**
+ * sim_dist_parse() - Parse distribution, times in us
+ *
+ * @spec: "const:T", "uniform:LO:HI", "exp:MEAN" or "normal:MEAN:SD"
+ * @dist: parsed distribution
+ *
+ * Returns: 0 on success, -EINVAL if spec is malformed
+ */
+int sim_dist_parse(const char *spec, struct sim_dist *dist)
+{
+	char name[16];
+	double a = 0, b = 0;
+	int n;
+
+	n = sscanf(spec, "%15[a-z]:%lf:%lf", name, &a, &b);
+	if (n < 2 || a < 0 || b < 0)
+		return -EINVAL;
+
+	if (!strcmp(name, "const") && n == 2)
+		dist->type = SIM_CONST;
+	else if (!strcmp(name, "uniform") && n == 3 && b >= a)
+		dist->type = SIM_UNIFORM;
+	else if (!strcmp(name, "exp") && n == 2)
+		dist->type = SIM_EXP;
+	else if (!strcmp(name, "normal") && n == 3)
+		dist->type = SIM_NORMAL;
+	else
+		return -EINVAL;
+
+	dist->a = (u64)(a * 1000);
+	dist->b = (u64)(b * 1000);
+	return 0;
+}
+
+static int cu_sim_alloc_credit(void *core)
+{
+	struct xrt_cu_sim *cu_sim = core;
+
+	return (cu_sim->credits) ? cu_sim->credits-- : 0;
+}
+
+static void cu_sim_free_credit(void *core, u32 count)
+{
+	struct xrt_cu_sim *cu_sim = core;
+
+	cu_sim->credits += count;
+	if (cu_sim->credits > cu_sim->max_credits)
+		cu_sim->credits = cu_sim->max_credits;
+}
+
+static int cu_sim_peek_credit(void *core)
+{
+	struct xrt_cu_sim *cu_sim = core;
+
+	return cu_sim->credits;
+}
+
+static void cu_sim_configure(void *core, u32 *data, size_t sz, int type)
+{
+	struct xrt_cu_sim *cu_sim = core;
+
+	cu_sim->regmap = (sz >= sizeof(struct sim_regmap) && type == REGMAP) ?
+			 (struct sim_regmap *)data : NULL;
+}
+
+static void cu_sim_start(void *core)
+{
+	struct xrt_cu_sim *cu_sim = core;
+	u64 now = ktime_get_raw_fast_ns();
+	u64 start;
+	u64 end;
+	u32 idx;
+
+	start = (cu_sim->last_end_ns > now) ? cu_sim->last_end_ns : now;
+	end = start + sim_sample(cu_sim);
+
+	idx = (cu_sim->head + cu_sim->run_cnts) % cu_sim->max_credits;
+	cu_sim->end_ns[idx] = end;
+	cu_sim->run_cnts++;
+	cu_sim->last_end_ns = end;
+
+	cu_sim->num_started++;
+	cu_sim->busy_ns += end - start;
+
+	if (cu_sim->regmap) {
+		cu_sim->regmap->start_ns = start;
+		cu_sim->regmap->end_ns = end;
+		cu_sim->regmap = NULL;
+	}
+}
+
+static void cu_sim_check(void *core, struct xcu_status *status)
+{
+	struct xrt_cu_sim *cu_sim = core;
+	u64 now;
+	u32 done = 0;
+
+	if (!cu_sim->run_cnts)
+		return;
+
+	now = ktime_get_raw_fast_ns();
+	while (cu_sim->run_cnts && cu_sim->end_ns[cu_sim->head] <= now) {
+		cu_sim->head = (cu_sim->head + 1) % cu_sim->max_credits;
+		cu_sim->run_cnts--;
+		++done;
+	}
+
+	status->num_done = done;
+	status->num_ready = done;
+	status->new_status = (cu_sim->run_cnts) ? CU_AP_START : CU_AP_IDLE;
+}
+
+static void cu_sim_enable_intr(void *core, u32 intr_type)
+{
+}
+
+static void cu_sim_disable_intr(void *core, u32 intr_type)
+{
+}
+
+static u32 cu_sim_clear_intr(void *core)
+{
+	return 0;
+}
+
+static struct xcu_funcs xrt_cu_sim_funcs = {
+	.alloc_credit	= cu_sim_alloc_credit,
+	.free_credit	= cu_sim_free_credit,
+	.peek_credit	= cu_sim_peek_credit,
+	.configure	= cu_sim_configure,
+	.start		= cu_sim_start,
+	.check		= cu_sim_check,
+	.enable_intr	= cu_sim_enable_intr,
+	.disable_intr	= cu_sim_disable_intr,
+	.clear_intr	= cu_sim_clear_intr,
+};
+
+int xrt_cu_sim_init(struct xrt_cu *xcu, const struct sim_dist *dist,
+		    int depth, u64 seed)
+{
+	struct xrt_cu_sim *core;
+
+	if (depth < 1)
+		return -EINVAL;
+
+	core = kzalloc(sizeof(struct xrt_cu_sim), GFP_KERNEL);
+	if (!core)
+		return -ENOMEM;
+
+	core->end_ns = kzalloc(depth * sizeof(u64), GFP_KERNEL);
+	if (!core->end_ns) {
+		kfree(core);
+		return -ENOMEM;
+	}
+
+	core->dist = *dist;
+	core->max_credits = depth;
+	core->credits = depth;
+	core->rng = seed ? seed : 1;
+
+	xcu->core = core;
+	xcu->funcs = &xrt_cu_sim_funcs;
+
+	/* Same defaults as HLS CU */
+	xcu->busy_threshold = -1;
+	xcu->interval_min = 2;
+	xcu->interval_max = 5;
+	xcu->status = CU_AP_IDLE;
+
+	return xrt_cu_init(xcu);
+}
+
+void xrt_cu_sim_fini(struct xrt_cu *xcu)
+{
+	struct xrt_cu_sim *core = xcu->core;
+
+	xrt_cu_fini(xcu);
+
+	if (core) {
+		kfree(core->end_ns);
+		kfree(core);
+	}
+}
@@ -0,0 +1,84 @@
+/* SPDX-License-Identifier: GPL-2.0 OR Apache-2.0 */
+/*
+ * Simulated CU for userspace KDS simulation
+ *
+ * Copyright (C) 2021 Xilinx, Inc. All rights reserved.
+ *
+ * This file is dual-licensed; you may select either the GNU General Public
+ * License version 2 or Apache License, Version 2.0.
+ */
+
+#ifndef _CU_SIM_H
+#define _CU_SIM_H
+
+#include "xrt_cu.h"
+
+enum sim_dist_type {
+	SIM_CONST,
+	SIM_UNIFORM,
+	SIM_EXP,
+	SIM_NORMAL,
+};
+
+/**
+ * struct sim_dist: CU execution time distribution, in ns
+ *
+ * @type: distribution
+ * @a: constant, lower bound, mean or mean
+ * @b: unused, upper bound, unused or standard deviation
+ */
+struct sim_dist {
+	enum sim_dist_type	 type;
+	u64			 a;
+	u64			 b;
+};
+
+/**
+ * struct sim_regmap: Register map of a simulated CU
+ *
+ * The simulated CU writes the time its task started executing and the
+ * time it will be done into the register map, like a CU writing an
+ * output argument.  The command info payload must hold this struct.
+ *
+ * @submit_ns: set by the submitter, not used by the CU
+ * @start_ns: time the CU started executing the task
+ * @end_ns: time the CU is done with the task
+ */
+struct sim_regmap {
+	u64			 submit_ns;
+	u64			 start_ns;
+	u64			 end_ns;
+};
+
+#define to_cu_sim(core) ((struct xrt_cu_sim *)(core))
+struct xrt_cu_sim {
+	struct sim_dist		 dist;
+	int			 max_credits;
+	int			 credits;
+	u64			 rng;
+	/* pending task end times in start order, max_credits entries */
+	u64			*end_ns;
+	u32			 head;
+	u32			 run_cnts;
+	u64			 last_end_ns;
+	struct sim_regmap	*regmap;
+	/* statistics */
+	u64			 num_started;
+	u64			 busy_ns;
+};
+
+int sim_dist_parse(const char *spec, struct sim_dist *dist);
+
+/**
+ * xrt_cu_sim_init() - Initialize simulated CU and start its CU thread
+ *
+ * @xcu: CU with info filled in
+ * @dist: execution time distribution
+ * @depth: number of tasks the CU queues (1 for ap_ctrl_hs)
+ * @seed: random seed
+ */
+int xrt_cu_sim_init(struct xrt_cu *xcu, const struct sim_dist *dist,
+		    int depth, u64 seed);
+void xrt_cu_sim_fini(struct xrt_cu *xcu);
+
+#endif /* _CU_SIM_H */
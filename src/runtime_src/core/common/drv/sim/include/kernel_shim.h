@@ -0,0 +1,511 @@
+/* SPDX-License-Identifier: GPL-2.0 OR Apache-2.0 */
+/*
+ * Userspace shim of the Linux kernel primitives used by KDS
+ *
+ * Copyright (C) 2021 Xilinx, Inc. All rights reserved.
+ *
+ * This file is dual-licensed; you may select either the GNU General Public
+ * License version 2 or Apache License, Version 2.0.
+ */
+
+#ifndef _KERNEL_SHIM_H
+#define _KERNEL_SHIM_H
+
+/* Only what kds_core.c and xrt_cu.c use is provided. Kernel threads
+ * are pthreads, locks are pthread mutexes and per cpu statistics are
+ * a single copy updated with atomic operations.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef uint8_t  u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef int32_t  s32;
+typedef unsigned long long u64;
+typedef long long s64;
+
+#define U64_MAX		((u64)~0ULL)
+
+#define max(x, y)	((x) > (y) ? (x) : (y))
+#define div_u64(dividend, divisor)	((u64)(dividend) / (u32)(divisor))
+
+#define READ_ONCE(x)	__atomic_load_n(&(x), __ATOMIC_RELAXED)
+#define WRITE_ONCE(x, val)	__atomic_store_n(&(x), (val), __ATOMIC_RELAXED)
+
+#ifndef ERESTARTSYS
+#define ERESTARTSYS 512
+#endif
+
+#ifndef PAGE_SIZE
+#define PAGE_SIZE 4096
+#endif
+
+#define KERNEL_VERSION(a, b, c)	(((a) << 16) + ((b) << 8) + (c))
+#define LINUX_VERSION_CODE	KERNEL_VERSION(5, 4, 0)
+
+#define GFP_KERNEL	0
+#define __iomem
+#define __percpu
+#define ____cacheline_aligned_in_smp __attribute__((aligned(64)))
+
+#define likely(x)	__builtin_expect(!!(x), 1)
+#define unlikely(x)	__builtin_expect(!!(x), 0)
+
+#define BUG_ON(cond)							\
+	do {								\
+		if (unlikely(cond)) {					\
+			fprintf(stderr, "BUG at %s:%d\n", __FILE__, __LINE__); \
+			abort();					\
+		}							\
+	} while (0)
+
+#define WARN_ON(cond)							\
+	({								\
+		int __ret = !!(cond);					\
+		if (unlikely(__ret))					\
+			fprintf(stderr, "WARNING at %s:%d\n", __FILE__, __LINE__); \
+		__ret;							\
+	})
+
+#define container_of(ptr, type, member) \
+	((type *)((char *)(ptr) - offsetof(type, member)))
+
+#define MAX_ERRNO	4095
+#define IS_ERR_VALUE(x) ((unsigned long)(x) >= (unsigned long)-MAX_ERRNO)
+#define ERR_PTR(err)	((void *)(long)(err))
+#define PTR_ERR(ptr)	((long)(ptr))
+#define IS_ERR(ptr)	IS_ERR_VALUE((unsigned long)(ptr))
+
+/* Logging, dev_info and dev_dbg are printed only when verbose */
+extern int kernel_shim_verbose;
+
+struct device {
+	const char *name;
+};
+
+#define dev_err(dev, fmt, args...)	fprintf(stderr, "err:" fmt "\n", ##args)
+#define dev_warn(dev, fmt, args...)	fprintf(stderr, "warn:" fmt "\n", ##args)
+#define dev_info(dev, fmt, args...)					\
+	do {								\
+		if (kernel_shim_verbose)				\
+			fprintf(stderr, "info:" fmt "\n", ##args);	\
+	} while (0)
+#define dev_dbg(dev, fmt, args...)					\
+	do {								\
+		if (kernel_shim_verbose > 1)				\
+			fprintf(stderr, "dbg:" fmt "\n", ##args);	\
+	} while (0)
+
+struct resource {
+	u64 start;
+	u64 end;
+};
+
+/* Memory */
+#define kzalloc(size, flags)	calloc(1, (size))
+#define kfree(ptr)		free(ptr)
+#define vmalloc(size)		malloc(size)
+#define vfree(ptr)		free(ptr)
+
+static inline int scnprintf(char *buf, size_t size, const char *fmt, ...)
+{
+	va_list args;
+	int len;
+
+	if (!size)
+		return 0;
+	va_start(args, fmt);
+	len = vsnprintf(buf, size, fmt, args);
+	va_end(args);
+	if (len < 0)
+		return 0;
+	return ((size_t)len >= size) ? (int)(size - 1) : len;
+}
+
+static inline int kstrtou32(const char *s, unsigned int base, u32 *res)
+{
+	char *end;
+	unsigned long val;
+
+	errno = 0;
+	val = strtoul(s, &end, base);
+	if (errno || end == s || val > UINT32_MAX)
+		return -EINVAL;
+	*res = (u32)val;
+	return 0;
+}
+
+/* Time */
+#define HZ	1000
+
+static inline u64 ktime_get_raw_fast_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+	return (u64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+#define jiffies	(ktime_get_raw_fast_ns() / (1000000000ULL / HZ))
+
+static inline void usleep_range(unsigned long min, unsigned long max)
+{
+	(void)max;
+	usleep(min);
+}
+
+static inline void msleep(unsigned int msecs)
+{
+	usleep(msecs * 1000);
+}
+
+static inline void schedule(void)
+{
+	sched_yield();
+}
+
+/* Timers are not run, CU ticks (command timeout) are not simulated */
+struct timer_list {
+	void (*function)(struct timer_list *);
+};
+
+#define timer_setup(timer, fn, flags)	((timer)->function = (fn))
+#define from_timer(var, callback_timer, timer_fieldname) \
+	container_of(callback_timer, typeof(*var), timer_fieldname)
+
+static inline int mod_timer(struct timer_list *timer, unsigned long expires)
+{
+	(void)timer;
+	(void)expires;
+	return 0;
+}
+
+static inline int del_timer_sync(struct timer_list *timer)
+{
+	(void)timer;
+	return 0;
+}
+
+/* Atomics */
+typedef struct {
+	int counter;
+} atomic_t;
+
+#define atomic_read(v)		__atomic_load_n(&(v)->counter, __ATOMIC_SEQ_CST)
+#define atomic_set(v, i)	__atomic_store_n(&(v)->counter, (i), __ATOMIC_SEQ_CST)
+#define atomic_inc(v)		__atomic_fetch_add(&(v)->counter, 1, __ATOMIC_SEQ_CST)
+#define atomic_dec(v)		__atomic_fetch_sub(&(v)->counter, 1, __ATOMIC_SEQ_CST)
+
+/* Locks */
+struct mutex {
+	pthread_mutex_t lock;
+	int locked;
+};
+
+static inline void mutex_init(struct mutex *m)
+{
+	pthread_mutex_init(&m->lock, NULL);
+	m->locked = 0;
+}
+
+static inline void mutex_destroy(struct mutex *m)
+{
+	pthread_mutex_destroy(&m->lock);
+}
+
+static inline void mutex_lock(struct mutex *m)
+{
+	pthread_mutex_lock(&m->lock);
+	m->locked = 1;
+}
+
+static inline void mutex_unlock(struct mutex *m)
+{
+	m->locked = 0;
+	pthread_mutex_unlock(&m->lock);
+}
+
+#define mutex_is_locked(m)	((m)->locked)
+
+typedef struct {
+	pthread_mutex_t lock;
+} spinlock_t;
+
+#define spin_lock_init(s)	pthread_mutex_init(&(s)->lock, NULL)
+#define spin_lock(s)		pthread_mutex_lock(&(s)->lock)
+#define spin_unlock(s)		pthread_mutex_unlock(&(s)->lock)
+#define spin_lock_irqsave(s, flags)					\
+	do {								\
+		(flags) = 0;						\
+		pthread_mutex_lock(&(s)->lock);				\
+	} while (0)
+#define spin_unlock_irqrestore(s, flags)				\
+	do {								\
+		(void)(flags);						\
+		pthread_mutex_unlock(&(s)->lock);			\
+	} while (0)
+
+struct semaphore {
+	sem_t sem;
+};
+
+#define sema_init(s, val)	sem_init(&(s)->sem, 0, (val))
+#define up(s)			sem_post(&(s)->sem)
+
+static inline int down_interruptible(struct semaphore *s)
+{
+	while (sem_wait(&s->sem) && errno == EINTR)
+		;
+	return 0;
+}
+
+static inline int down_timeout(struct semaphore *s, long timeout)
+{
+	struct timespec ts;
+	u64 ns;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	ns = (u64)ts.tv_nsec + (u64)timeout * (1000000000ULL / HZ);
+	ts.tv_sec += ns / 1000000000ULL;
+	ts.tv_nsec = ns % 1000000000ULL;
+	while (sem_timedwait(&s->sem, &ts)) {
+		if (errno == ETIMEDOUT)
+			return -ETIME;
+	}
+	return 0;
+}
+
+struct completion {
+	sem_t sem;
+};
+
+#define init_completion(c)	sem_init(&(c)->sem, 0, 0)
+#define complete(c)		sem_post(&(c)->sem)
+
+static inline void wait_for_completion(struct completion *c)
+{
+	while (sem_wait(&c->sem) && errno == EINTR)
+		;
+}
+
+static inline int wait_for_completion_interruptible(struct completion *c)
+{
+	wait_for_completion(c);
+	return 0;
+}
+
+typedef int wait_queue_head_t;
+#define init_waitqueue_head(q)	(*(q) = 0)
+
+/* Processes and threads */
+struct pid {
+	pid_t nr;
+};
+
+struct task_struct {
+	pthread_t thread;
+	int (*fn)(void *data);
+	void *data;
+	int ret;
+};
+
+extern struct pid kernel_shim_pid;
+
+#define current			NULL
+#define task_pid(task)		(&kernel_shim_pid)
+#define get_pid(pid)		(pid)
+#define put_pid(pid)		((void)(pid))
+#define pid_nr(pid)		((pid) ? (pid)->nr : 0)
+
+static inline void *kthread_entry(void *arg)
+{
+	struct task_struct *task = arg;
+
+	task->ret = task->fn(task->data);
+	return NULL;
+}
+
+static inline struct task_struct *
+kthread_run(int (*fn)(void *data), void *data, const char *name)
+{
+	struct task_struct *task = calloc(1, sizeof(*task));
+
+	(void)name;
+	if (!task)
+		return ERR_PTR(-ENOMEM);
+	task->fn = fn;
+	task->data = data;
+	if (pthread_create(&task->thread, NULL, kthread_entry, task)) {
+		free(task);
+		return ERR_PTR(-EAGAIN);
+	}
+	return task;
+}
+
+/* Caller must have asked the thread to stop, as xrt_cu does */
+static inline int kthread_stop(struct task_struct *task)
+{
+	int ret;
+
+	pthread_join(task->thread, NULL);
+	ret = task->ret;
+	free(task);
+	return ret;
+}
+
+/* Per cpu data, a single copy */
+#define alloc_percpu(type)		((type *)calloc(1, sizeof(type)))
+#define free_percpu(ptr)		free(ptr)
+#define for_each_possible_cpu(cpu)	for ((cpu) = 0; (cpu) < 1; ++(cpu))
+#define per_cpu_ptr(ptr, cpu)		((void)(cpu), (ptr))
+#define this_cpu_read(pcp)		__atomic_load_n(&(pcp), __ATOMIC_RELAXED)
+#define this_cpu_write(pcp, val)	__atomic_store_n(&(pcp), (val), __ATOMIC_RELAXED)
+#define this_cpu_add(pcp, val)		__atomic_fetch_add(&(pcp), (val), __ATOMIC_RELAXED)
+
+/* Bitmaps */
+#define BITS_PER_LONG		(8 * sizeof(unsigned long))
+#define BITS_TO_LONGS(nr)	(((nr) + BITS_PER_LONG - 1) / BITS_PER_LONG)
+#define DECLARE_BITMAP(name, bits) unsigned long name[BITS_TO_LONGS(bits)]
+#define BIT_WORD(nr)		((nr) / BITS_PER_LONG)
+#define BIT_MASK(nr)		(1UL << ((nr) % BITS_PER_LONG))
+
+static inline int test_bit(unsigned long nr, const unsigned long *addr)
+{
+	return (__atomic_load_n(&addr[BIT_WORD(nr)], __ATOMIC_RELAXED) & BIT_MASK(nr)) != 0;
+}
+
+static inline int test_and_set_bit(unsigned long nr, unsigned long *addr)
+{
+	return (__atomic_fetch_or(&addr[BIT_WORD(nr)], BIT_MASK(nr), __ATOMIC_SEQ_CST) & BIT_MASK(nr)) != 0;
+}
+
+static inline int test_and_clear_bit(unsigned long nr, unsigned long *addr)
+{
+	return (__atomic_fetch_and(&addr[BIT_WORD(nr)], ~BIT_MASK(nr), __ATOMIC_SEQ_CST) & BIT_MASK(nr)) != 0;
+}
+
+static inline void clear_bit(unsigned long nr, unsigned long *addr)
+{
+	__atomic_fetch_and(&addr[BIT_WORD(nr)], ~BIT_MASK(nr), __ATOMIC_SEQ_CST);
+}
+
+static inline void set_bit(unsigned long nr, unsigned long *addr)
+{
+	__atomic_fetch_or(&addr[BIT_WORD(nr)], BIT_MASK(nr), __ATOMIC_SEQ_CST);
+}
+
+static inline unsigned long
+find_next_bit(const unsigned long *addr, unsigned long size, unsigned long offset)
+{
+	for (; offset < size; ++offset) {
+		if (test_bit(offset, addr))
+			return offset;
+	}
+	return size;
+}
+
+#define find_first_bit(addr, size)	find_next_bit((addr), (size), 0)
+#define bitmap_zero(dst, nbits)		memset((dst), 0, BITS_TO_LONGS(nbits) * sizeof(unsigned long))
+
+/* Doubly linked list */
+struct list_head {
+	struct list_head *next, *prev;
+};
+
+static inline void INIT_LIST_HEAD(struct list_head *list)
+{
+	list->next = list;
+	list->prev = list;
+}
+
+static inline void __list_add(struct list_head *entry, struct list_head *prev,
+			      struct list_head *next)
+{
+	next->prev = entry;
+	entry->next = next;
+	entry->prev = prev;
+	prev->next = entry;
+}
+
+static inline void list_add(struct list_head *entry, struct list_head *head)
+{
+	__list_add(entry, head, head->next);
+}
+
+static inline void list_add_tail(struct list_head *entry, struct list_head *head)
+{
+	__list_add(entry, head->prev, head);
+}
+
+static inline void __list_del(struct list_head *prev, struct list_head *next)
+{
+	next->prev = prev;
+	prev->next = next;
+}
+
+static inline void list_del(struct list_head *entry)
+{
+	__list_del(entry->prev, entry->next);
+	entry->next = NULL;
+	entry->prev = NULL;
+}
+
+static inline void list_move_tail(struct list_head *list, struct list_head *head)
+{
+	__list_del(list->prev, list->next);
+	list_add_tail(list, head);
+}
+
+static inline int list_empty(const struct list_head *head)
+{
+	return head->next == head;
+}
+
+static inline void list_splice_tail_init(struct list_head *list, struct list_head *head)
+{
+	struct list_head *first = list->next;
+	struct list_head *last = list->prev;
+	struct list_head *at = head->prev;
+
+	if (list_empty(list))
+		return;
+
+	first->prev = at;
+	at->next = first;
+	last->next = head;
+	head->prev = last;
+	INIT_LIST_HEAD(list);
+}
+
+#define list_entry(ptr, type, member)	container_of(ptr, type, member)
+#define list_first_entry(ptr, type, member) \
+	list_entry((ptr)->next, type, member)
+#define list_next_entry(pos, member) \
+	list_entry((pos)->member.next, typeof(*(pos)), member)
+#define list_for_each(pos, head) \
+	for (pos = (head)->next; pos != (head); pos = pos->next)
+#define list_for_each_entry(pos, head, member)				\
+	for (pos = list_first_entry(head, typeof(*pos), member);	\
+	     &pos->member != (head);					\
+	     pos = list_next_entry(pos, member))
+#define list_for_each_entry_safe(pos, n, head, member)			\
+	for (pos = list_first_entry(head, typeof(*pos), member),	\
+	     n = list_next_entry(pos, member);				\
+	     &pos->member != (head);					\
+	     pos = n, n = list_next_entry(n, member))
+
+#endif /* _KERNEL_SHIM_H */
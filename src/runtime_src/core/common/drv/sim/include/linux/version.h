@@ -0,0 +1,3 @@
+/* SPDX-License-Identifier: GPL-2.0 OR Apache-2.0 */
+/* Userspace shim, see kernel_shim.h */
+#include "kernel_shim.h"
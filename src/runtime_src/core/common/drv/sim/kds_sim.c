@@ -0,0 +1,362 @@
+// SPDX-License-Identifier: GPL-2.0 OR Apache-2.0
+/*
+ * Userspace KDS simulation
+ *
+ * Copyright (C) 2021 Xilinx, Inc. All rights reserved.
+ *
+ * This file is dual-licensed; you may select either the GNU General Public
+ * License version 2 or Apache License, Version 2.0.
+ */
+
+/* Runs kds_core.c and xrt_cu.c against simulated CUs. Client threads
+ * submit commands that may run on any CU, keeping a window of commands
+ * outstanding. Reports throughput, queueing delay, end to end latency
+ * and how the commands were distributed across the CUs.
+ */
+
+#include <getopt.h>
+#include "kds_core.h"
+#include "cu_sim.h"
+
+#define SIM_MAX_DISTS	MAX_CUS
+
+int kernel_shim_verbose;
+struct pid kernel_shim_pid;
+
+struct sim_client {
+	struct kds_client	 client;
+	struct kds_sched	*kds;
+	pthread_t		 thread;
+	int			 num_cmds;
+	int			 max_outstanding;
+	/* outstanding window */
+	pthread_mutex_t		 lock;
+	pthread_cond_t		 cond;
+	int			 outstanding;
+	/* per command samples in ns */
+	u64			*queue_ns;
+	u64			*latency_ns;
+	int			 num_samples;
+	int			 num_errors;
+};
+
+static struct kds_sched sim_kds;
+static struct xrt_cu *sim_cus[MAX_CUS];
+static int num_cus = 4;
+static u64 cu_done[MAX_CUS];
+
+static void sim_notify_host(struct kds_command *xcmd, int status)
+{
+	struct sim_client *sc = xcmd->priv;
+	struct sim_regmap *regmap = xcmd->info;
+	u64 now = ktime_get_raw_fast_ns();
+	int idx;
+
+	/* Done by the device driver before notifying the client */
+	if (xcmd->cu_idx >= 0)
+		client_stat_inc(xcmd->client, c_cnt[xcmd->cu_idx]);
+
+	if (status != KDS_COMPLETED) {
+		__atomic_fetch_add(&sc->num_errors, 1, __ATOMIC_RELAXED);
+		return;
+	}
+
+	__atomic_fetch_add(&cu_done[xcmd->cu_idx], 1, __ATOMIC_RELAXED);
+	idx = __atomic_fetch_add(&sc->num_samples, 1, __ATOMIC_RELAXED);
+	sc->queue_ns[idx] = regmap->start_ns - regmap->submit_ns;
+	sc->latency_ns[idx] = now - regmap->submit_ns;
+}
+
+static void sim_free_cmd(struct kds_command *xcmd)
+{
+	struct sim_client *sc = xcmd->priv;
+
+	kds_free_command(xcmd);
+
+	pthread_mutex_lock(&sc->lock);
+	--sc->outstanding;
+	pthread_cond_signal(&sc->cond);
+	pthread_mutex_unlock(&sc->lock);
+}
+
+static void *sim_client_thread(void *data)
+{
+	struct sim_client *sc = data;
+	struct kds_command *xcmd;
+	struct sim_regmap *regmap;
+	int i, j;
+
+	for (i = 0; i < sc->num_cmds; ++i) {
+		pthread_mutex_lock(&sc->lock);
+		while (sc->outstanding >= sc->max_outstanding)
+			pthread_cond_wait(&sc->cond, &sc->lock);
+		++sc->outstanding;
+		pthread_mutex_unlock(&sc->lock);
+
+		xcmd = kds_alloc_command(&sc->client, sizeof(struct sim_regmap));
+		if (!xcmd) {
+			fprintf(stderr, "Out of memory\n");
+			exit(EXIT_FAILURE);
+		}
+		xcmd->type = KDS_CU;
+		xcmd->opcode = OP_START;
+		xcmd->payload_type = REGMAP;
+		xcmd->isize = sizeof(struct sim_regmap);
+		for (j = 0; j < num_cus; ++j)
+			xcmd->cu_mask[j / 32] |= 1U << (j % 32);
+		xcmd->num_mask = (num_cus + 31) / 32;
+		xcmd->cb.notify_host = sim_notify_host;
+		xcmd->cb.free = sim_free_cmd;
+		xcmd->priv = sc;
+
+		regmap = xcmd->info;
+		regmap->submit_ns = ktime_get_raw_fast_ns();
+		kds_add_command(sc->kds, xcmd);
+	}
+
+	pthread_mutex_lock(&sc->lock);
+	while (sc->outstanding)
+		pthread_cond_wait(&sc->cond, &sc->lock);
+	pthread_mutex_unlock(&sc->lock);
+
+	return NULL;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+	u64 x = *(const u64 *)a;
+	u64 y = *(const u64 *)b;
+
+	return (x > y) - (x < y);
+}
+
+static void report_samples(const char *name, u64 *samples, int num)
+{
+	double sum = 0;
+	int i;
+
+	if (!num)
+		return;
+
+	qsort(samples, num, sizeof(u64), cmp_u64);
+	for (i = 0; i < num; ++i)
+		sum += samples[i];
+
+	printf("%-12s mean %10.1f  p50 %10.1f  p99 %10.1f  max %10.1f us\n",
+	       name, sum / num / 1000, samples[num / 2] / 1000.0,
+	       samples[(u64)num * 99 / 100] / 1000.0, samples[num - 1] / 1000.0);
+}
+
+static void usage(const char *prog)
+{
+	printf("Usage: %s [options]\n", prog);
+	printf("  -u <num>   number of CUs (default 4)\n");
+	printf("  -c <num>   number of clients (default 2)\n");
+	printf("  -n <num>   commands per client (default 10000)\n");
+	printf("  -q <num>   outstanding commands per client (default 16)\n");
+	printf("  -l <list>  comma separated CU execution times in us, applied\n");
+	printf("             to the CUs in turn (default const:100)\n");
+	printf("             const:T, uniform:LO:HI, exp:MEAN, normal:MEAN:SD\n");
+	printf("  -d <num>   CU queue depth (default 1, ap_ctrl_hs)\n");
+	printf("  -b <num>   CU busy threshold (default -1, unlimited)\n");
+	printf("  -p <name>  CU selection policy, usage, queue or expected\n");
+	printf("             (default usage)\n");
+	printf("  -s <num>   random seed (default 1)\n");
+	printf("  -v         verbose, repeat for debug messages\n");
+}
+
+int main(int argc, char *argv[])
+{
+	struct sim_dist dists[SIM_MAX_DISTS];
+	struct sim_client *clients;
+	struct kds_ctx_info info;
+	char *lat_spec = "const:100";
+	char *policy = "usage";
+	char *spec;
+	char *tok;
+	char *buf;
+	int num_dists = 0;
+	int num_clients = 2;
+	int num_cmds = 10000;
+	int max_outstanding = 16;
+	int depth = 1;
+	int busy_threshold = -1;
+	u64 seed = 1;
+	u64 start, elapsed;
+	u64 *samples;
+	u64 total = 0, max_done = 0, min_done = ~0ULL;
+	int num_samples = 0;
+	int num_errors = 0;
+	int opt;
+	int i, j;
+
+	while ((opt = getopt(argc, argv, "u:c:n:q:l:d:b:p:s:vh")) != -1) {
+		switch (opt) {
+		case 'u': num_cus = atoi(optarg); break;
+		case 'c': num_clients = atoi(optarg); break;
+		case 'n': num_cmds = atoi(optarg); break;
+		case 'q': max_outstanding = atoi(optarg); break;
+		case 'l': lat_spec = optarg; break;
+		case 'd': depth = atoi(optarg); break;
+		case 'b': busy_threshold = atoi(optarg); break;
+		case 'p': policy = optarg; break;
+		case 's': seed = strtoull(optarg, NULL, 0); break;
+		case 'v': ++kernel_shim_verbose; break;
+		default:
+			usage(argv[0]);
+			return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+	}
+
+	if (num_cus < 1 || num_cus > MAX_CUS || num_clients < 1 ||
+	    num_cmds < 1 || max_outstanding < 1 || depth < 1) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	spec = strdup(lat_spec);
+	for (tok = strtok(spec, ","); tok && num_dists < SIM_MAX_DISTS;
+	     tok = strtok(NULL, ",")) {
+		if (sim_dist_parse(tok, &dists[num_dists])) {
+			fprintf(stderr, "Bad CU execution time '%s'\n", tok);
+			return EXIT_FAILURE;
+		}
+		++num_dists;
+	}
+	free(spec);
+	if (!num_dists) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	kernel_shim_pid.nr = getpid();
+	if (kds_init_sched(&sim_kds))
+		return EXIT_FAILURE;
+	if (store_kds_cu_policy(&sim_kds, policy, strlen(policy)) < 0) {
+		fprintf(stderr, "Bad CU selection policy '%s'\n", policy);
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < num_cus; ++i) {
+		struct xrt_cu *xcu = calloc(1, sizeof(*xcu));
+
+		xcu->info.cu_idx = i;
+		xcu->info.intr_id = i;
+		xcu->info.addr = 0x1000000ULL + (u64)i * 0x10000;
+		xcu->info.size = 0x10000;
+		xcu->info.model = XCU_HLS;
+		xcu->info.protocol = (depth > 1) ? CTRL_CHAIN : CTRL_HS;
+		snprintf(xcu->info.iname, sizeof(xcu->info.iname), "cu_%d", i);
+		snprintf(xcu->info.kname, sizeof(xcu->info.kname), "sim");
+
+		if (xrt_cu_sim_init(xcu, &dists[i % num_dists], depth, seed + i)) {
+			fprintf(stderr, "Failed to initialize CU %d\n", i);
+			return EXIT_FAILURE;
+		}
+		xcu->busy_threshold = busy_threshold;
+		kds_add_cu(&sim_kds, xcu);
+		sim_cus[i] = xcu;
+	}
+
+	clients = calloc(num_clients, sizeof(*clients));
+	for (i = 0; i < num_clients; ++i) {
+		struct sim_client *sc = &clients[i];
+
+		sc->kds = &sim_kds;
+		sc->num_cmds = num_cmds;
+		sc->max_outstanding = max_outstanding;
+		sc->queue_ns = calloc(num_cmds, sizeof(u64));
+		sc->latency_ns = calloc(num_cmds, sizeof(u64));
+		pthread_mutex_init(&sc->lock, NULL);
+		pthread_cond_init(&sc->cond, NULL);
+
+		kds_init_client(&sim_kds, &sc->client);
+		mutex_lock(&sc->client.lock);
+		for (j = 0; j < num_cus; ++j) {
+			info.cu_idx = j;
+			info.flags = CU_CTX_SHARED;
+			if (kds_add_context(&sim_kds, &sc->client, &info)) {
+				fprintf(stderr, "Failed to open context on CU %d\n", j);
+				return EXIT_FAILURE;
+			}
+		}
+		mutex_unlock(&sc->client.lock);
+	}
+
+	start = ktime_get_raw_fast_ns();
+	for (i = 0; i < num_clients; ++i)
+		pthread_create(&clients[i].thread, NULL, sim_client_thread, &clients[i]);
+	for (i = 0; i < num_clients; ++i)
+		pthread_join(clients[i].thread, NULL);
+	elapsed = ktime_get_raw_fast_ns() - start;
+
+	samples = calloc((size_t)num_clients * num_cmds, sizeof(u64));
+	for (i = 0; i < num_clients; ++i) {
+		memcpy(samples + num_samples, clients[i].latency_ns,
+		       clients[i].num_samples * sizeof(u64));
+		num_samples += clients[i].num_samples;
+		num_errors += clients[i].num_errors;
+	}
+
+	printf("%d CUs, %d clients, %d commands per client, %d outstanding, depth %d, policy %s\n",
+	       num_cus, num_clients, num_cmds, max_outstanding, depth, policy);
+	printf("Completed %d commands (%d errors) in %.3f ms, %.0f commands/s\n",
+	       num_samples, num_errors, elapsed / 1e6,
+	       num_samples / (elapsed / 1e9));
+	report_samples("latency", samples, num_samples);
+
+	num_samples = 0;
+	for (i = 0; i < num_clients; ++i) {
+		memcpy(samples + num_samples, clients[i].queue_ns,
+		       clients[i].num_samples * sizeof(u64));
+		num_samples += clients[i].num_samples;
+	}
+	report_samples("queue delay", samples, num_samples);
+	free(samples);
+
+	for (i = 0; i < num_cus; ++i)
+		total += cu_done[i];
+	printf("CU      commands   share   utilization\n");
+	for (i = 0; i < num_cus; ++i) {
+		struct xrt_cu_sim *cu_sim = sim_cus[i]->core;
+
+		printf("cu_%-3d %9llu %6.1f%% %8.1f%%\n", i, cu_done[i],
+		       total ? 100.0 * cu_done[i] / total : 0,
+		       100.0 * cu_sim->busy_ns / elapsed);
+		if (cu_done[i] > max_done)
+			max_done = cu_done[i];
+		if (cu_done[i] < min_done)
+			min_done = cu_done[i];
+	}
+	if (min_done)
+		printf("Balance (max/min commands) %.3f\n", (double)max_done / min_done);
+	else
+		printf("Balance (max/min commands) inf\n");
+
+	if (kernel_shim_verbose) {
+		buf = calloc(1, PAGE_SIZE);
+		show_kds_custat_raw(&sim_kds, buf);
+		printf("custat_raw:\n%s", buf);
+		show_kds_cu_load(&sim_kds, buf);
+		printf("cu_load:\n%s", buf);
+		free(buf);
+	}
+
+	for (i = 0; i < num_clients; ++i) {
+		kds_fini_client(&sim_kds, &clients[i].client);
+		free(clients[i].queue_ns);
+		free(clients[i].latency_ns);
+	}
+	free(clients);
+
+	for (i = num_cus - 1; i >= 0; --i) {
+		struct xrt_cu *xcu = sim_cus[i];
+
+		kds_del_cu(&sim_kds, xcu);
+		xrt_cu_sim_fini(xcu);
+		free(xcu);
+	}
+	kds_fini_sched(&sim_kds);
+
+	return (num_errors) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
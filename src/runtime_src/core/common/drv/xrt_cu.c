@@ -80,9 +80,42 @@ static inline void process_cq(struct xrt_cu *xcu)
 		list_del(&xcmd->list);
 		xcmd->cb.free(xcmd);
 		--xcu->num_cq;
+		WRITE_ONCE(xcu->completed, xcu->completed + 1);
 	}
 }
 
+/**
+ * update_exec_time() - Update execution time estimate
+ * @xcu: Target XRT CU
+ * @start: Start time of the first command done
+ * @done: Number of commands done
+ *
+ * Commands done in one check are accounted evenly. A command could be
+ * started before the previous one was done (e.g. ap_ctrl_chain), so its
+ * execution is counted from the later of its start and previous done.
+ * The estimate is an EWMA with weight 1/8 of the new sample.
+ */
+static inline void update_exec_time(struct xrt_cu *xcu, u64 start, u32 done)
+{
+	u64 now = ktime_get_raw_fast_ns();
+	u64 from = max(start, xcu->last_done_ns);
+	u64 sample;
+	u64 ewma;
+
+	xcu->last_done_ns = now;
+	/* Started before tracking is enabled */
+	if (!start)
+		return;
+
+	sample = div_u64(now - from, done);
+	ewma = xcu->exec_ewma_ns;
+	if (!ewma)
+		ewma = sample;
+	else
+		ewma = ewma - (ewma >> 3) + (sample >> 3);
+	WRITE_ONCE(xcu->exec_ewma_ns, ewma);
+}
+
 /**
  * __process_sq() - Process submitted queue
  * @xcu: Target XRT CU
@@ -94,6 +127,8 @@ static inline void __process_sq(struct xrt_cu *xcu)
 	struct kds_client *ev_client = NULL;
 	unsigned int tick;
 	u64 time;
+	u64 first_start = 0;
+	u32 done = 0;
 
 	/* CU is ready to accept more commands
 	 * Return credits to allow submit more commands
@@ -131,6 +166,8 @@ static inline void __process_sq(struct xrt_cu *xcu)
 			/* Done command has priority */
 			xcmd->status = KDS_COMPLETED;
 			--xcu->done_cnt;
+			if (!done++)
+				first_start = xcmd->start;
 		} else if (unlikely(ev_client)) {
 			/* Client event happens rarely */
 			if (xcmd->client != ev_client)
@@ -156,6 +193,9 @@ static inline void __process_sq(struct xrt_cu *xcu)
 		move_to_queue(xcmd, &xcu->cq, &xcu->num_cq);
 		--xcu->num_sq;
 	}
+
+	if (xcu->track_exec && done)
+		update_exec_time(xcu, first_start, done);
 }
 
 /**
@@ -221,7 +261,8 @@ static inline int process_rq(struct xrt_cu *xcu)
 	 * But this implementation is used for general purpose. Please create CU
 	 * specific thread if needed.
 	 */
-	//xcmd->start = ktime_get_raw_fast_ns();
+	if (xcu->track_exec)
+		xcmd->start = ktime_get_raw_fast_ns();
 move_cmd:
 	move_to_queue(xcmd, dst_q, dst_len);
 	--xcu->num_rq;
@@ -410,6 +451,7 @@ void xrt_cu_submit(struct xrt_cu *xcu, struct kds_command *xcmd)
 	spin_lock_irqsave(&xcu->pq_lock, flags);
 	list_add_tail(&xcmd->list, &xcu->pq);
 	++xcu->num_pq;
+	WRITE_ONCE(xcu->submitted, xcu->submitted + 1);
 	first_command = (xcu->num_pq == 1);
 	spin_unlock_irqrestore(&xcu->pq_lock, flags);
 	if (first_command)
@@ -24,6 +24,7 @@
 #include "experimental/xrt-next.h"
 #include "xcl_graph.h"
 #include "error.h"
+#include <condition_variable>
 #include <stdexcept>
 
 // Internal shim function forward declarations
@@ -32,6 +33,56 @@ int xclInternalResetDevice(xclDeviceHandle handle, xclResetKind kind);
 
 namespace xrt_core {
 
+/**
+ * class exec_buf_batch_error - Partial submission of a batch
+ *
+ * Thrown by ishim::exec_buf_batch when the execution buffer at
+ * index submitted() failed to launch.  The execution buffers prior
+ * to this index were launched and are owned by the device.  Any
+ * other exception from exec_buf_batch means that no execution buffer
+ * was launched.
+ */
+class exec_buf_batch_error : public system_error
+{
+  size_t m_submitted;
+
+public:
+  exec_buf_batch_error(int ec, size_t submitted, const std::string& what = "")
+    : system_error(ec, what), m_submitted(submitted)
+  {}
+
+  size_t
+  submitted() const
+  {
+    return m_submitted;
+  }
+};
+
+/**
+ * exec_buf_serial() - Launch a batch of execution buffers one by one
+ *
+ * @bos: Execution buffers to launch
+ * @count: Number of execution buffers
+ * @exec_buf: Function launching one execution buffer, throws system_error
+ *
+ * Used by shims without native support for batched submission.
+ * Throws exec_buf_batch_error with the index of the execution buffer
+ * that failed to launch.
+ */
+template <typename ExecBuf>
+inline void
+exec_buf_serial(const xclBufferHandle* bos, size_t count, ExecBuf&& exec_buf)
+{
+  for (size_t idx = 0; idx < count; ++idx) {
+    try {
+      exec_buf(bos[idx]);
+    }
+    catch (const system_error& ex) {
+      throw exec_buf_batch_error(ex.value(), idx, "failed to launch execution buffer " + std::to_string(idx) + " of batch");
+    }
+  }
+}
+
 /**
  * struct ishim - Shim API implemented by core libraries
  *
@@ -99,6 +150,10 @@ struct ishim
   virtual void
   exec_buf(xclBufferHandle boh) = 0;
 
+  // Throws exec_buf_batch_error if the batch was partially launched
+  virtual void
+  exec_buf_batch(const xclBufferHandle* bos, size_t count) = 0;
+
   virtual int
   exec_wait(int timeout_ms) const = 0;
 
@@ -144,6 +199,12 @@ struct ishim
   virtual void
   wait_ip_interrupt(xclInterruptNotifyHandle)
   { throw xrt_core::error(std::errc::not_supported,"wait_ip_interrupt()"); }
+
+  // Wait at most timeout_ms for interrupt, or until wake handle is
+  // signaled.  Returns no_timeout only if the interrupt was raised.
+  virtual std::cv_status
+  wait_ip_interrupt(xclInterruptNotifyHandle, int32_t, xclInterruptNotifyHandle)
+  { throw xrt_core::error(std::errc::not_supported,"wait_ip_interrupt()"); }
   ////////////////////////////////////////////////////////////////
 
 #ifdef XRT_ENABLE_AIE
@@ -380,6 +441,14 @@ struct shim : public DeviceType
       throw system_error(ret, "failed to launch execution buffer");
   }
 
+  // Shims without native support for batched submission
+  // launch the execution buffers one by one
+  virtual void
+  exec_buf_batch(const xclBufferHandle* bos, size_t count)
+  {
+    exec_buf_serial(bos, count, [this](xclBufferHandle bo) { exec_buf(bo); });
+  }
+
   virtual int
   exec_wait(int timeout_ms) const
   {
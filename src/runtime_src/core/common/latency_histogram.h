@@ -0,0 +1,173 @@
+/**
+ * Copyright (C) 2021 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef core_common_latency_histogram_h
+#define core_common_latency_histogram_h
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _MSC_VER
+# include <intrin.h>
+#endif
+
+namespace xrt_core {
+
+/**
+ * class latency_histogram - lock free log-linear histogram of latencies
+ *
+ * Values (typically ns) are counted in buckets where each power of
+ * two range is split into 2^sub_bucket_bits linear sub buckets, so
+ * the relative error of a reported percentile is bounded by
+ * 1/2^sub_bucket_bits (12.5%) over the full 64 bit range in a fixed
+ * number of buckets.
+ *
+ * Recording is a few relaxed atomic operations and may be done
+ * concurrently from any number of threads.  Reading while recording
+ * gives an approximate but consistent enough snapshot.
+ */
+class latency_histogram
+{
+public:
+  static constexpr unsigned int sub_bucket_bits = 3;
+  static constexpr unsigned int sub_buckets = 1u << sub_bucket_bits;
+  static constexpr unsigned int num_buckets = (64 - sub_bucket_bits + 1) * sub_buckets;
+
+private:
+  std::atomic<uint64_t> m_buckets[num_buckets];
+  std::atomic<uint64_t> m_count {0};
+  std::atomic<uint64_t> m_sum {0};
+  std::atomic<uint64_t> m_max {0};
+
+  // Index of most significant set bit, value must be non-zero
+  static unsigned int
+  msb(uint64_t value)
+  {
+#ifdef _MSC_VER
+    unsigned long idx;
+    _BitScanReverse64(&idx, value);
+    return idx;
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+  }
+
+  static unsigned int
+  bucket_index(uint64_t value)
+  {
+    if (value < sub_buckets)
+      return static_cast<unsigned int>(value);
+    auto shift = msb(value) - sub_bucket_bits;
+    auto sub = static_cast<unsigned int>(value >> shift) & (sub_buckets - 1);
+    return (shift + 1) * sub_buckets + sub;
+  }
+
+  // Largest value counted in bucket
+  static uint64_t
+  bucket_upper(unsigned int idx)
+  {
+    if (idx < sub_buckets)
+      return idx;
+    auto shift = idx / sub_buckets - 1;
+    auto sub = idx % sub_buckets;
+    auto lower = uint64_t(sub_buckets + sub) << shift;
+    return lower + ((uint64_t(1) << shift) - 1);
+  }
+
+public:
+  latency_histogram()
+  {
+    reset();
+  }
+
+  latency_histogram(const latency_histogram&) = delete;
+  latency_histogram& operator=(const latency_histogram&) = delete;
+
+  void
+  record(uint64_t value)
+  {
+    m_buckets[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+    auto max = m_max.load(std::memory_order_relaxed);
+    while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+      ;
+  }
+
+  void
+  reset()
+  {
+    for (auto& bucket : m_buckets)
+      bucket.store(0, std::memory_order_relaxed);
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+  }
+
+  uint64_t
+  count() const
+  {
+    return m_count.load(std::memory_order_relaxed);
+  }
+
+  uint64_t
+  max() const
+  {
+    return m_max.load(std::memory_order_relaxed);
+  }
+
+  uint64_t
+  mean() const
+  {
+    auto cnt = count();
+    return cnt ? m_sum.load(std::memory_order_relaxed) / cnt : 0;
+  }
+
+  /**
+   * percentile() - value at or below which pct percent of values fall
+   *
+   * @pct: percentile in range [0,100]
+   * Return: upper bound of the bucket holding the percentile, capped
+   *  at the largest recorded value
+   */
+  uint64_t
+  percentile(double pct) const
+  {
+    auto cnt = count();
+    if (!cnt)
+      return 0;
+
+    auto rank = static_cast<uint64_t>(pct / 100.0 * cnt + 0.5);
+    if (rank < 1)
+      rank = 1;
+
+    uint64_t seen = 0;
+    for (unsigned int idx = 0; idx < num_buckets; ++idx) {
+      seen += m_buckets[idx].load(std::memory_order_relaxed);
+      if (seen >= rank) {
+        auto upper = bucket_upper(idx);
+        auto mx = max();
+        return upper < mx ? upper : mx;
+      }
+    }
+    return max();
+  }
+};
+
+} // xrt_core
+
+#endif
@@ -31,6 +31,37 @@ namespace query {
 
 enum class key_type;
 
+/**
+ * enum class freshness - how often the value of a query request changes
+ *
+ * @volatile_data: value can change between any two calls, e.g. sensors
+ * @slow_changing: value changes on rare events such as xclbin load
+ * @static_data:   value is fixed for the lifetime of the device
+ *
+ * A query request declares its freshness with a static data member
+ * named 'cache_freshness'.  Requests without the member are volatile.  The
+ * device query cache uses the freshness to pick a time to live for
+ * cached values.
+ */
+enum class freshness { volatile_data, slow_changing, static_data };
+
+/**
+ * request_freshness - freshness of a query request type
+ *
+ * request_freshness<pcie_bdf>::value
+ */
+template <typename QueryRequestType, typename = void>
+struct request_freshness
+{
+  static constexpr freshness value = freshness::volatile_data;
+};
+
+template <typename QueryRequestType>
+struct request_freshness<QueryRequestType, decltype(void(QueryRequestType::cache_freshness))>
+{
+  static constexpr freshness value = QueryRequestType::cache_freshness;
+};
+
 /**
  * class request - virtual dispatch to concrete query requests
  *
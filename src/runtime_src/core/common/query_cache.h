@@ -0,0 +1,162 @@
+/**
+ * Copyright (C) 2021 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef xrt_core_common_query_cache_h
+#define xrt_core_common_query_cache_h
+
+#include "query.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <boost/any.hpp>
+
+namespace xrt_core { namespace query {
+
+/**
+ * class cache - time limited cache of query results
+ *
+ * Static results live forever, slow changing results live for the
+ * time to live passed to the constructor, volatile results are not
+ * cached.  The defaults can be overridden per key with set_ttl().
+ *
+ * A generation counter is bumped by every clear, a value fetched
+ * while the cache was cleared is returned but not stored since it
+ * may be stale.
+ */
+class cache
+{
+public:
+  struct stats
+  {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+  };
+
+  explicit
+  cache(std::chrono::milliseconds slow_ttl)
+    : m_slow_ttl(slow_ttl)
+  {}
+
+  /**
+   * get() - Get cached value of key, call fetch() on a miss
+   *
+   * @key:   query request key
+   * @fresh: freshness of the query request
+   * @fetch: callable returning the value as boost::any
+   *
+   * Exceptions from fetch() propagate, failed queries are not cached.
+   */
+  template <typename Fetch>
+  boost::any
+  get(key_type key, freshness fresh, Fetch&& fetch)
+  {
+    auto ttl = std::chrono::milliseconds::zero();
+    uint64_t generation = 0;
+    auto now = std::chrono::steady_clock::now();
+    {
+      std::lock_guard<std::mutex> lk(m_mutex);
+      auto itr = m_ttl.find(key);
+      if (itr != m_ttl.end())
+        ttl = (*itr).second;
+      else if (fresh == freshness::static_data)
+        ttl = std::chrono::milliseconds::max();
+      else if (fresh == freshness::slow_changing)
+        ttl = m_slow_ttl;
+
+      auto entry = m_cache.find(key);
+      if (entry != m_cache.end() && now < (*entry).second.expires) {
+        ++m_hits;
+        return (*entry).second.value;
+      }
+      generation = m_generation;
+    }
+
+    if (ttl <= std::chrono::milliseconds::zero())
+      return fetch();
+
+    // Query outside the lock
+    ++m_misses;
+    boost::any value = fetch();
+
+    auto expires = (ttl == std::chrono::milliseconds::max())
+      ? std::chrono::steady_clock::time_point::max()
+      : now + ttl;
+
+    // Cache cleared while querying, the value may be stale
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (generation == m_generation)
+      m_cache[key] = {value, expires};
+
+    return value;
+  }
+
+  // Override time to live of key, zero disables caching of key
+  void
+  set_ttl(key_type key, std::chrono::milliseconds ttl)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_ttl[key] = ttl;
+    m_cache.erase(key);
+    ++m_generation;
+  }
+
+  void
+  clear()
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_cache.clear();
+    ++m_generation;
+  }
+
+  void
+  clear(key_type key)
+  {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_cache.erase(key);
+    ++m_generation;
+  }
+
+  stats
+  get_stats() const
+  {
+    stats s;
+    s.hits = m_hits;
+    s.misses = m_misses;
+    return s;
+  }
+
+private:
+  struct entry
+  {
+    boost::any value;
+    std::chrono::steady_clock::time_point expires;
+  };
+
+  std::chrono::milliseconds m_slow_ttl;
+  std::mutex m_mutex;  // guards all but the counters
+  std::map<key_type, entry> m_cache;
+  std::map<key_type, std::chrono::milliseconds> m_ttl;
+  uint64_t m_generation = 0;
+  std::atomic<uint64_t> m_hits {0};
+  std::atomic<uint64_t> m_misses {0};
+};
+
+}} // query, xrt_core
+
+#endif
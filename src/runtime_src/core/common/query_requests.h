@@ -260,6 +260,7 @@ struct pcie_vendor : request
 {
   using result_type = uint16_t;
   static const key_type key = key_type::pcie_vendor;
+  static const freshness cache_freshness = freshness::static_data;
   static const char* name() { return "vendor"; }
 
   virtual boost::any
@@ -276,6 +277,7 @@ struct pcie_device : request
 {
   using result_type = uint16_t;
   static const key_type key = key_type::pcie_device;
+  static const freshness cache_freshness = freshness::static_data;
   static const char* name() { return "device"; }
 
   virtual boost::any
@@ -293,6 +295,7 @@ struct pcie_subsystem_vendor : request
 {
   using result_type = uint16_t;
   static const key_type key = key_type::pcie_subsystem_vendor;
+  static const freshness cache_freshness = freshness::static_data;
   static const char* name() { return "subsystem_vendor"; }
 
   virtual boost::any
@@ -309,6 +312,7 @@ struct pcie_subsystem_id : request
 {
   using result_type = uint16_t;
   static const key_type key = key_type::pcie_subsystem_id;
+  static const freshness cache_freshness = freshness::static_data;
   static const char* name() { return "subsystem_id"; }
 
   virtual boost::any
@@ -341,6 +345,7 @@ struct pcie_link_speed_max : request
 {
   using result_type = uint64_t;
   static const key_type key = key_type::pcie_link_speed_max;
+  static const freshness cache_freshness = freshness::static_data;
   static const char* name() { return "link_speed_max"; }
 
   virtual boost::any
@@ -373,6 +378,7 @@ struct pcie_express_lane_width_max : request
 {
   using result_type = uint64_t;
   static const key_type key = key_type::pcie_express_lane_width_max;
+  static const freshness cache_freshness = freshness::static_data;
   static const char* name() { return "width_max"; }
 
   virtual boost::any
@@ -389,6 +395,7 @@ struct pcie_bdf : request
 {
   using result_type = std::tuple<uint16_t,uint16_t,uint16_t>;
   static const key_type key = key_type::pcie_bdf;
+  static const freshness cache_freshness = freshness::static_data;
   static const char* name() { return "bdf"; }
 
   virtual boost::any
@@ -440,6 +447,7 @@ struct rom_vbnv : request
 {
   using result_type = std::string;
   static const key_type key = key_type::rom_vbnv;
+  static const freshness cache_freshness = freshness::slow_changing;
   static const char* name() { return "vbnv"; }
 
   virtual boost::any
@@ -456,6 +464,7 @@ struct rom_ddr_bank_size_gb : request
 {
   using result_type = uint64_t;
   static const key_type key = key_type::rom_ddr_bank_size_gb;
+  static const freshness cache_freshness = freshness::slow_changing;
   static const char* name() { return "ddr_size_bytes"; }
 
   virtual boost::any
@@ -472,6 +481,7 @@ struct rom_ddr_bank_count_max : request
 {
   using result_type = uint64_t;
   static const key_type key = key_type::rom_ddr_bank_count_max;
+  static const freshness cache_freshness = freshness::slow_changing;
   static const char* name() { return "widdr_countdth"; }
 
   virtual boost::any
@@ -488,6 +498,7 @@ struct rom_fpga_name : request
 {
   using result_type = std::string;
   static const key_type key = key_type::rom_fpga_name;
+  static const freshness cache_freshness = freshness::slow_changing;
   static const char* name() { return "fpga_name"; }
 
   virtual boost::any
@@ -513,6 +524,7 @@ struct rom_uuid : request
 {
   using result_type = std::string;
   static const key_type key = key_type::rom_uuid;
+  static const freshness cache_freshness = freshness::slow_changing;
   static const char* name() { return "uuid"; }
 
   virtual boost::any
@@ -529,6 +541,7 @@ struct rom_time_since_epoch : request
 {
   using result_type = uint64_t;
   static const key_type key = key_type::rom_time_since_epoch;
+  static const freshness cache_freshness = freshness::slow_changing;
   static const char* name() { return "id"; }
 
   virtual boost::any
@@ -545,6 +558,7 @@ struct interface_uuids : request
 {
   using result_type = std::vector<std::string>;
   static const key_type key = key_type::interface_uuids;
+  static const freshness cache_freshness = freshness::slow_changing;
   static const char* name() { return "interface_uuids"; }
 
   virtual boost::any
@@ -578,6 +592,7 @@ struct logic_uuids : request
 {
   using result_type = std::vector<std::string>;
   static const key_type key = key_type::logic_uuids;
+  static const freshness cache_freshness = freshness::slow_changing;
   static const char* name() { return "logic_uuids"; }
 
   virtual boost::any
@@ -595,6 +610,7 @@ struct xclbin_uuid : request
 {
   using result_type = std::string;
   static const key_type key = key_type::xclbin_uuid;
+  static const freshness cache_freshness = freshness::slow_changing;
 
   virtual boost::any
   get(const device*) const = 0;
@@ -604,6 +620,7 @@ struct group_topology : request
 {
   using result_type = std::vector<char>;
   static const key_type key = key_type::group_topology;
+  static const freshness cache_freshness = freshness::slow_changing;
 
   virtual boost::any
   get(const device*) const = 0;
@@ -652,6 +669,7 @@ struct mem_topology_raw : request
 {
   using result_type = std::vector<char>;
   static const key_type key = key_type::mem_topology_raw;
+  static const freshness cache_freshness = freshness::slow_changing;
 
   virtual boost::any
   get(const device*) const = 0;
@@ -700,6 +718,7 @@ struct ip_layout_raw : request
 {
   using result_type = std::vector<char>;
   static const key_type key = key_type::ip_layout_raw;
+  static const freshness cache_freshness = freshness::slow_changing;
 
   virtual boost::any
   get(const device*) const = 0;
@@ -719,6 +738,7 @@ struct kds_mode : request
 {
   using result_type = uint32_t;
   static const key_type key = key_type::kds_mode;
+  static const freshness cache_freshness = freshness::slow_changing;
 
   virtual boost::any
   get(const device*) const = 0;
@@ -770,6 +790,7 @@ struct clock_freq_topology_raw : request
 {
   using result_type = std::vector<char>;
   static const key_type key = key_type::clock_freq_topology_raw;
+  static const freshness cache_freshness = freshness::slow_changing;
 
   virtual boost::any
   get(const device*) const = 0;
@@ -779,6 +800,7 @@ struct xmc_version : request
 {
   using result_type = std::string;
   static const key_type key = key_type::xmc_version;
+  static const freshness cache_freshness = freshness::slow_changing;
   static const char* name() { return "xmc_version"; }
 
   virtual boost::any
@@ -795,6 +817,7 @@ struct xmc_board_name : request
 {
   using result_type = std::string;
   static const key_type key = key_type::xmc_board_name;
+  static const freshness cache_freshness = freshness::static_data;
   static const char* name() { return "xmc_board_name"; }
 
   virtual boost::any
@@ -811,6 +834,7 @@ struct xmc_serial_num : request
 {
   using result_type = std::string;
   static const key_type key = key_type::xmc_serial_num;
+  static const freshness cache_freshness = freshness::static_data;
   static const char* name() { return "serial_number"; }
 
   virtual boost::any
@@ -891,6 +915,7 @@ struct expected_sc_version : request
 {
   using result_type = std::string;
   static const key_type key = key_type::expected_sc_version;
+  static const freshness cache_freshness = freshness::slow_changing;
   static const char* name() { return "expected_sc_version"; }
 
   virtual boost::any
@@ -987,6 +1012,7 @@ struct nodma : request
 {
   using result_type = uint32_t;
   static const key_type key = key_type::nodma;
+  static const freshness cache_freshness = freshness::slow_changing;
 
   virtual boost::any
   get(const device*) const = 0;
@@ -1023,6 +1049,7 @@ struct dna_serial_num : request
 {
   using result_type = std::string;
   static const key_type key = key_type::dna_serial_num;
+  static const freshness cache_freshness = freshness::static_data;
   static const char* name() { return "dna"; }
 
   virtual boost::any
@@ -1057,6 +1084,7 @@ struct clock_freqs_mhz : request
 {
   using result_type = std::vector<std::string> ;
   static const key_type key = key_type::clock_freqs_mhz;
+  static const freshness cache_freshness = freshness::slow_changing;
   static const char* name() { return "clocks"; }
 
   virtual boost::any
@@ -1074,6 +1102,7 @@ struct idcode : request
 {
   using result_type = uint64_t;
   static const key_type key = key_type::idcode;
+  static const freshness cache_freshness = freshness::static_data;
   static const char* name() { return "idcode"; }
 
   virtual boost::any
@@ -1092,6 +1121,7 @@ struct data_retention : request
   using value_type = uint32_t;   // put value type
 
   static const key_type key = key_type::data_retention;
+  static const freshness cache_freshness = freshness::slow_changing;
 
   virtual boost::any
   get(const device*) const = 0;
@@ -1112,6 +1142,7 @@ struct sec_level : request
   using result_type = uint16_t;   // get value type
   using value_type = std::string; // put value type
   static const key_type key = key_type::sec_level;
+  static const freshness cache_freshness = freshness::slow_changing;
 
   virtual boost::any
   get(const device*) const = 0;
@@ -1124,6 +1155,7 @@ struct max_shared_host_mem_aperture_bytes : request
 {
   using result_type = uint64_t;
   static const key_type key = key_type::max_shared_host_mem_aperture_bytes;
+  static const freshness cache_freshness = freshness::static_data;
 
   virtual boost::any
   get(const device*) const = 0;
@@ -1149,6 +1181,7 @@ struct p2p_config : request
 {
   using result_type = std::vector<std::string>;
   static const key_type key = key_type::p2p_config;
+  static const freshness cache_freshness = freshness::slow_changing;
   static const char* name() { return "p2p_config"; }
 
   virtual boost::any
@@ -1907,6 +1940,7 @@ struct mac_contiguous_num : request
 {
   using result_type = uint64_t;
   static const key_type key = key_type::mac_contiguous_num;
+  static const freshness cache_freshness = freshness::static_data;
   static const char* name() { return "mac_contiguous_num"; }
 
   virtual boost::any
@@ -1917,6 +1951,7 @@ struct mac_addr_first : request
 {
   using result_type = std::string;
   static const key_type key = key_type::mac_addr_first;
+  static const freshness cache_freshness = freshness::static_data;
   static const char* name() { return "mac_addr_first"; }
 
   virtual boost::any
@@ -1927,6 +1962,7 @@ struct mac_addr_list : request
 {
   using result_type = std::vector<std::string>;
   static const key_type key = key_type::mac_addr_list;
+  static const freshness cache_freshness = freshness::static_data;
   static const char* name() { return "mac_addr_list"; }
 
   virtual boost::any
@@ -1937,6 +1973,7 @@ struct oem_id : request
 {
   using result_type = std::string;
   static const key_type key = key_type::oem_id;
+  static const freshness cache_freshness = freshness::static_data;
   static const char* name() { return "oem_id"; }
 
   virtual boost::any
@@ -2025,6 +2062,7 @@ struct host_mem_size : request
 {
   using result_type = uint64_t;
   static const key_type key = key_type::host_mem_size;
+  static const freshness cache_freshness = freshness::slow_changing;
   static const char* name() { return "host_mem_size"; }
 
   virtual boost::any
@@ -2124,6 +2162,7 @@ struct is_mfg : request
 {
   using result_type = bool;
   static const key_type key = key_type::is_mfg;
+  static const freshness cache_freshness = freshness::slow_changing;
 
   virtual boost::any
   get(const device*) const = 0;
@@ -2133,6 +2172,7 @@ struct mfg_ver : request
 {
   using result_type = uint32_t;
   static const key_type key = key_type::mfg_ver;
+  static const freshness cache_freshness = freshness::slow_changing;
 
   virtual boost::any
   get(const device*) const = 0;
@@ -2176,6 +2216,7 @@ struct f_flash_type : request
 {
   using result_type = std::string;
   static const key_type key = key_type::f_flash_type;
+  static const freshness cache_freshness = freshness::static_data;
 
   virtual boost::any
   get(const device*) const = 0;
@@ -2185,6 +2226,7 @@ struct flash_type : request
 {
   using result_type = std::string;
   static const key_type key = key_type::flash_type;
+  static const freshness cache_freshness = freshness::static_data;
   static const char* name() { return "flash_type"; }
 
   virtual boost::any
@@ -2201,6 +2243,7 @@ struct board_name : request
 {
   using result_type = std::string;
   static const key_type key = key_type::board_name;
+  static const freshness cache_freshness = freshness::static_data;
 
   virtual boost::any
   get(const device*) const = 0;
@@ -2210,6 +2253,7 @@ struct flash_bar_offset : request
 {
   using result_type = uint64_t;
   static const key_type key = key_type::flash_bar_offset;
+  static const freshness cache_freshness = freshness::static_data;
 
   virtual boost::any
   get(const device*) const = 0;
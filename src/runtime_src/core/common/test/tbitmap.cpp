@@ -0,0 +1,225 @@
+/**
+ * Copyright (C) 2021 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing of core/common/bitmap.h
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "core/common/bitmap.h"
+
+#include <bitset>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE ( test_bitmap )
+
+namespace {
+
+// Reference implementations testing bit by bit
+template <size_t N>
+size_t
+ref_find_next(const std::bitset<N>& bs, size_t pos)
+{
+  for (size_t idx = pos; idx < N; ++idx)
+    if (bs.test(idx))
+      return idx;
+  return N;
+}
+
+template <size_t N>
+size_t
+ref_find_first_zero(const std::bitset<N>& bs, size_t limit)
+{
+  for (size_t idx = 0; idx < limit && idx < N; ++idx)
+    if (!bs.test(idx))
+      return idx;
+  return N;
+}
+
+template <size_t N>
+void
+check_against_reference(const std::bitset<N>& bs)
+{
+  xrt_core::bitmap<N> bm(bs);
+  BOOST_CHECK_EQUAL(bm.count(), bs.count());
+  BOOST_CHECK_EQUAL(bm.any(), bs.any());
+  for (size_t pos = 0; pos < N; ++pos) {
+    BOOST_CHECK_EQUAL(bm.test(pos), bs.test(pos));
+    BOOST_CHECK_EQUAL(bm.find_next(pos), ref_find_next(bs, pos));
+
+    auto wrap = ref_find_next(bs, pos);
+    if (wrap == N)
+      wrap = ref_find_next(bs, 0);
+    BOOST_CHECK_EQUAL(bm.find_next_wrap(pos), wrap);
+  }
+  for (size_t limit = 0; limit <= N; ++limit)
+    BOOST_CHECK_EQUAL(bm.find_first_zero(limit), ref_find_first_zero(bs, limit));
+}
+
+}
+
+BOOST_AUTO_TEST_CASE( test_set_reset )
+{
+  xrt_core::bitmap<128> bm;
+  BOOST_CHECK(bm.none());
+  bm.set(0);
+  bm.set(63);
+  bm.set(64);
+  bm.set(127);
+  BOOST_CHECK_EQUAL(bm.count(), 4);
+  BOOST_CHECK(bm.test(63) && bm.test(64));
+  bm.reset(63);
+  BOOST_CHECK(!bm.test(63));
+  BOOST_CHECK_EQUAL(bm.find_first(), 0);
+  BOOST_CHECK_EQUAL(bm.find_next(1), 64);
+  bm.reset();
+  BOOST_CHECK(bm.none());
+  BOOST_CHECK_EQUAL(bm.find_first(), bm.npos);
+}
+
+BOOST_AUTO_TEST_CASE( test_find_next_wrap )
+{
+  xrt_core::bitmap<128> bm;
+  BOOST_CHECK_EQUAL(bm.find_next_wrap(0), bm.npos);
+  BOOST_CHECK_EQUAL(bm.find_next_wrap(100), bm.npos);
+
+  bm.set(5);
+  bm.set(70);
+  BOOST_CHECK_EQUAL(bm.find_next_wrap(0), 5);
+  BOOST_CHECK_EQUAL(bm.find_next_wrap(5), 5);
+  BOOST_CHECK_EQUAL(bm.find_next_wrap(6), 70);
+  BOOST_CHECK_EQUAL(bm.find_next_wrap(71), 5);
+  BOOST_CHECK_EQUAL(bm.find_next_wrap(127), 5);
+  BOOST_CHECK_EQUAL(bm.find_next_wrap(128), 5);
+}
+
+BOOST_AUTO_TEST_CASE( test_find_if )
+{
+  xrt_core::bitmap<128> bm;
+  BOOST_CHECK_EQUAL(bm.find_if([](size_t) { return true; }), bm.npos);
+
+  bm.set(3);
+  bm.set(64);
+  bm.set(100);
+  std::vector<size_t> visited;
+  auto idx = bm.find_if([&](size_t pos) { visited.push_back(pos); return pos > 50; });
+  BOOST_CHECK_EQUAL(idx, 64);
+  BOOST_CHECK(visited == std::vector<size_t>({3, 64}));
+  BOOST_CHECK_EQUAL(bm.find_if([](size_t pos) { return pos == 100; }), 100);
+  BOOST_CHECK_EQUAL(bm.find_if([](size_t) { return false; }), bm.npos);
+
+  // Bits past N set through set_word32 are not visited
+  xrt_core::bitmap<40> odd;
+  odd.set_word32(1, 0xffffffff);
+  BOOST_CHECK_EQUAL(odd.find_if([](size_t pos) { return pos >= 40; }), odd.npos);
+}
+
+BOOST_AUTO_TEST_CASE( test_find_first_zero )
+{
+  xrt_core::bitmap<128> bm;
+  BOOST_CHECK_EQUAL(bm.find_first_zero(), 0);
+  BOOST_CHECK_EQUAL(bm.find_first_zero(0), bm.npos);
+
+  for (size_t idx = 0; idx < 100; ++idx)
+    bm.set(idx);
+  BOOST_CHECK_EQUAL(bm.find_first_zero(), 100);
+  BOOST_CHECK_EQUAL(bm.find_first_zero(101), 100);
+  BOOST_CHECK_EQUAL(bm.find_first_zero(100), bm.npos);
+  BOOST_CHECK_EQUAL(bm.find_first_zero(64), bm.npos);
+
+  for (size_t idx = 100; idx < 128; ++idx)
+    bm.set(idx);
+  BOOST_CHECK_EQUAL(bm.find_first_zero(), bm.npos);
+
+  // Bits past N in the last word are not free
+  xrt_core::bitmap<70> odd;
+  for (size_t idx = 0; idx < 70; ++idx)
+    odd.set(idx);
+  BOOST_CHECK_EQUAL(odd.find_first_zero(), odd.npos);
+  odd.reset(69);
+  BOOST_CHECK_EQUAL(odd.find_first_zero(), 69);
+}
+
+BOOST_AUTO_TEST_CASE( test_word32 )
+{
+  xrt_core::bitmap<128> bm;
+  bm.set_word32(0, 0x80000001);
+  bm.set_word32(1, 0x00000002);
+  bm.set_word32(3, 0xdeadbeef);
+  BOOST_CHECK_EQUAL(bm.get_word32(0), 0x80000001);
+  BOOST_CHECK_EQUAL(bm.get_word32(1), 0x00000002);
+  BOOST_CHECK_EQUAL(bm.get_word32(2), 0);
+  BOOST_CHECK_EQUAL(bm.get_word32(3), 0xdeadbeef);
+  BOOST_CHECK(bm.test(0) && bm.test(31) && bm.test(33) && bm.test(96));
+  BOOST_CHECK(!bm.test(32));
+
+  // set_word32 ors into existing bits
+  bm.set_word32(1, 0x00000001);
+  BOOST_CHECK_EQUAL(bm.get_word32(1), 0x00000003);
+
+  // Same layout as std::bitset
+  std::bitset<128> bs;
+  bs.set(3);
+  bs.set(40);
+  bs.set(127);
+  xrt_core::bitmap<128> from(bs);
+  BOOST_CHECK_EQUAL(from.get_word32(0), 1u << 3);
+  BOOST_CHECK_EQUAL(from.get_word32(1), 1u << 8);
+  BOOST_CHECK_EQUAL(from.get_word32(2), 0);
+  BOOST_CHECK_EQUAL(from.get_word32(3), 1u << 31);
+}
+
+BOOST_AUTO_TEST_CASE( test_reference )
+{
+  std::mt19937_64 rng(42);
+  for (int iter = 0; iter < 50; ++iter) {
+    std::bitset<128> bs;
+    std::bitset<70> odd;
+    auto density = rng() % 8;
+    for (size_t idx = 0; idx < 128; ++idx) {
+      if (rng() % 8 < density)
+        bs.set(idx);
+      if (idx < 70 && rng() % 8 < density)
+        odd.set(idx);
+    }
+    check_against_reference(bs);
+    check_against_reference(odd);
+  }
+  check_against_reference(std::bitset<128>().set());
+  check_against_reference(std::bitset<70>().set());
+}
+
+BOOST_AUTO_TEST_CASE( test_operators )
+{
+  xrt_core::bitmap<128> a, b;
+  a.set(1);
+  a.set(100);
+  b.set(100);
+  b.set(120);
+  auto c = a & b;
+  BOOST_CHECK_EQUAL(c.count(), 1);
+  BOOST_CHECK(c.test(100));
+  a |= b;
+  BOOST_CHECK_EQUAL(a.count(), 3);
+  xrt_core::bitmap<128> d;
+  d.set(1);
+  d.set(100);
+  d.set(120);
+  BOOST_CHECK(a == d);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
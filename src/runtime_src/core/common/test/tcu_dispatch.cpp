@@ -0,0 +1,198 @@
+/**
+ * Copyright (C) 2021 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing of sws CU dispatch in core/common/api/cu_dispatch.h
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "core/common/api/cu_dispatch.h"
+#include "core/common/bitmap.h"
+
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE ( test_cu_dispatch )
+
+namespace {
+
+using xrt_core::sws::cu_policy;
+using xrt_core::sws::arg_banks;
+using cu_bitmap = xrt_core::bitmap<128>;
+
+constexpr size_t npos = cu_bitmap::npos;
+
+// Bank base addresses, each bank is 1GB
+constexpr uint64_t gb = 1ull << 30;
+constexpr uint64_t bank0 = 0x4000000000;
+constexpr uint64_t bank1 = bank0 + gb;
+
+// CU state as seen by the scheduler, ready flag, number of running
+// commands, and affinity of the command being dispatched
+struct fake_cus
+{
+  std::vector<bool> ready;
+  std::vector<size_t> running;
+  std::vector<size_t> affinity;
+  cu_bitmap mask;
+
+  explicit
+  fake_cus(size_t count)
+    : ready(count, true), running(count, 0), affinity(count, 0)
+  {
+    for (size_t idx = 0; idx < count; ++idx)
+      mask.set(idx);
+  }
+
+  size_t
+  select(cu_policy policy, size_t next = 0) const
+  {
+    return select(policy, mask, next);
+  }
+
+  size_t
+  select(cu_policy policy, const cu_bitmap& cus, size_t next) const
+  {
+    return xrt_core::sws::select_cu
+      (policy, cus, next,
+       [this](size_t idx) { return bool(ready[idx]); },
+       [this](size_t idx) { return running[idx]; },
+       [this](size_t idx) { return affinity[idx]; });
+  }
+};
+
+// Command register map with a 64 bit buffer address at regidx
+std::vector<uint32_t>
+make_regmap(size_t size, size_t regidx, uint64_t addr)
+{
+  std::vector<uint32_t> regmap(size, 0);
+  regmap[regidx] = static_cast<uint32_t>(addr);
+  regmap[regidx + 1] = static_cast<uint32_t>(addr >> 32);
+  return regmap;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE( test_first )
+{
+  fake_cus cus(4);
+  cus.running = {3, 2, 1, 0};
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::first, 2), 0);
+
+  cus.ready[0] = false;
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::first, 2), 1);
+
+  cus.ready = {false, false, false, false};
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::first), npos);
+}
+
+BOOST_AUTO_TEST_CASE( test_round_robin )
+{
+  fake_cus cus(4);
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::round_robin, 0), 0);
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::round_robin, 2), 2);
+
+  // Wraps around past the last CU
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::round_robin, 4), 0);
+  cus.ready[3] = false;
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::round_robin, 3), 0);
+
+  // Only CUs the command can run on are considered
+  cu_bitmap subset;
+  subset.set(1);
+  subset.set(2);
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::round_robin, subset, 3), 1);
+  cus.ready[1] = cus.ready[2] = false;
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::round_robin, subset, 0), npos);
+}
+
+BOOST_AUTO_TEST_CASE( test_least_outstanding )
+{
+  fake_cus cus(4);
+  cus.running = {3, 1, 2, 2};
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::least_outstanding), 1);
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::first), 0);
+
+  // Busiest ready CU is not chosen over a less loaded one, a CU that
+  // is not ready is skipped however lightly loaded
+  cus.ready[1] = false;
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::least_outstanding), 2);
+
+  // Ties go to the first CU searched from next
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::least_outstanding, 3), 3);
+
+  // An idle CU ends the search
+  cus.running = {3, 1, 0, 0};
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::least_outstanding, 3), 3);
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::least_outstanding, 0), 2);
+}
+
+BOOST_AUTO_TEST_CASE( test_memory_affinity )
+{
+  fake_cus cus(4);
+  cus.running = {0, 2, 1, 3};
+  cus.affinity = {0, 2, 2, 1};
+
+  // Highest affinity wins over lower load, ties by load
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::memory_affinity), 2);
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::least_outstanding), 0);
+
+  cus.ready[2] = false;
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::memory_affinity), 1);
+
+  // No affinity anywhere, same as least_outstanding
+  cus.affinity = {0, 0, 0, 0};
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::memory_affinity),
+                    cus.select(cu_policy::least_outstanding));
+}
+
+BOOST_AUTO_TEST_CASE( test_arg_affinity )
+{
+  // CU0 has argument 0 (regidx 4) connected to bank0 and argument 1
+  // (regidx 6) connected to bank0 or bank1, CU1 has both in bank1
+  std::vector<std::vector<arg_banks>> banks = {
+    { {4, {{bank0, gb}}}, {6, {{bank0, gb}, {bank1, gb}}} },
+    { {4, {{bank1, gb}}}, {6, {{bank1, gb}}} }
+  };
+
+  auto regmap = make_regmap(8, 4, bank1 + 0x1000);
+  regmap[6] = static_cast<uint32_t>(bank1);
+  regmap[7] = static_cast<uint32_t>(bank1 >> 32);
+  BOOST_CHECK_EQUAL(xrt_core::sws::arg_affinity(banks[0], regmap.data(), regmap.size()), 1);
+  BOOST_CHECK_EQUAL(xrt_core::sws::arg_affinity(banks[1], regmap.data(), regmap.size()), 2);
+
+  // End of a bank is exclusive
+  regmap = make_regmap(8, 4, bank0 + gb);
+  BOOST_CHECK_EQUAL(xrt_core::sws::arg_affinity(banks[0], regmap.data(), regmap.size()), 0);
+  BOOST_CHECK_EQUAL(xrt_core::sws::arg_affinity(banks[1], regmap.data(), regmap.size()), 1);
+
+  // Arguments beyond the register map of the command are ignored
+  regmap = make_regmap(6, 4, bank1);
+  BOOST_CHECK_EQUAL(xrt_core::sws::arg_affinity(banks[1], regmap.data(), regmap.size()), 1);
+
+  // Dispatch a command whose buffers are in bank1 to the CU connected
+  // to bank1 although it is more loaded
+  regmap = make_regmap(8, 4, bank1);
+  regmap[6] = static_cast<uint32_t>(bank1 + gb / 2);
+  regmap[7] = static_cast<uint32_t>((bank1 + gb / 2) >> 32);
+  fake_cus cus(2);
+  cus.running = {0, 3};
+  for (size_t idx = 0; idx < 2; ++idx)
+    cus.affinity[idx] = xrt_core::sws::arg_affinity(banks[idx], regmap.data(), regmap.size());
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::memory_affinity), 1);
+  BOOST_CHECK_EQUAL(cus.select(cu_policy::least_outstanding), 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,99 @@
+/**
+ * Copyright (C) 2021 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing of batched exec_buf fallback in core/common/ishim.h
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "core/common/ishim.h"
+
+#include <cerrno>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE ( test_exec_buf_batch )
+
+namespace {
+
+// Records launched execution buffers, fails to launch the one at
+// index fail_at
+struct fake_exec_buf
+{
+  size_t fail_at;
+  std::vector<xclBufferHandle> launched;
+
+  void
+  operator() (xclBufferHandle bo)
+  {
+    if (launched.size() == fail_at)
+      throw xrt_core::system_error(EBUSY, "command queue full");
+    launched.push_back(bo);
+  }
+};
+
+std::vector<xclBufferHandle>
+make_bos(size_t count)
+{
+  std::vector<xclBufferHandle> bos;
+  for (size_t idx = 0; idx < count; ++idx)
+    bos.push_back(static_cast<xclBufferHandle>(100 + idx));
+  return bos;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE( test_all_launched )
+{
+  auto bos = make_bos(8);
+  fake_exec_buf fake {bos.size(), {}};
+  xrt_core::exec_buf_serial(bos.data(), bos.size(), std::ref(fake));
+  BOOST_CHECK(fake.launched == bos);
+}
+
+BOOST_AUTO_TEST_CASE( test_failure_halfway )
+{
+  auto bos = make_bos(8);
+  fake_exec_buf fake {4, {}};
+  try {
+    xrt_core::exec_buf_serial(bos.data(), bos.size(), std::ref(fake));
+    BOOST_FAIL("expected exec_buf_batch_error");
+  }
+  catch (const xrt_core::exec_buf_batch_error& ex) {
+    BOOST_CHECK_EQUAL(ex.submitted(), 4);
+    BOOST_CHECK_EQUAL(ex.value(), EBUSY);
+  }
+
+  // Execution buffers after the failing one are not launched
+  BOOST_CHECK(fake.launched == std::vector<xclBufferHandle>(bos.begin(), bos.begin() + 4));
+}
+
+BOOST_AUTO_TEST_CASE( test_failure_first )
+{
+  auto bos = make_bos(8);
+  fake_exec_buf fake {0, {}};
+  BOOST_CHECK_EXCEPTION(xrt_core::exec_buf_serial(bos.data(), bos.size(), std::ref(fake)),
+                        xrt_core::exec_buf_batch_error,
+                        [](const xrt_core::exec_buf_batch_error& ex) { return ex.submitted() == 0; });
+  BOOST_CHECK(fake.launched.empty());
+
+  // Callers that do not handle partial launches still see a system_error
+  fake_exec_buf last {7, {}};
+  BOOST_CHECK_THROW(xrt_core::exec_buf_serial(bos.data(), bos.size(), std::ref(last)),
+                    xrt_core::system_error);
+  BOOST_CHECK_EQUAL(last.launched.size(), 7);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,313 @@
+/**
+ * Copyright (C) 2021 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing of xrt::pipeline in core/common/api/xrt_pipeline.cpp
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "core/include/experimental/xrt_pipeline.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE ( test_pipeline )
+
+namespace {
+
+// Event queue with a number of handler threads
+struct queue_with_handlers
+{
+  xrt::event_queue queue;
+  std::vector<xrt::event_handler> handlers;
+
+  explicit
+  queue_with_handlers(size_t count)
+  {
+    for (size_t idx = 0; idx < count; ++idx)
+      handlers.emplace_back(queue);
+  }
+};
+
+// Log of stage function calls, stage function of stage s for
+// iteration i is logged as (s, i)
+struct call_log
+{
+  std::mutex mutex;
+  std::vector<std::pair<unsigned int, unsigned int>> calls;
+  unsigned int active = 0;      // iterations between first and last stage
+  unsigned int max_active = 0;
+
+  void
+  add(unsigned int stage, unsigned int iteration, unsigned int stages)
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    calls.emplace_back(stage, iteration);
+    if (stage == 0)
+      max_active = std::max(max_active, ++active);
+    if (stage == stages - 1)
+      --active;
+  }
+
+  // Position of call (stage, iteration) in the log, calls.size() if
+  // not called
+  size_t
+  position(unsigned int stage, unsigned int iteration)
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    auto itr = std::find(calls.begin(), calls.end(), std::make_pair(stage, iteration));
+    return itr - calls.begin();
+  }
+};
+
+// Blocks stage functions until opened
+struct gate
+{
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool open = false;
+
+  void
+  wait()
+  {
+    std::unique_lock<std::mutex> lk(mutex);
+    cv.wait(lk, [this] { return open; });
+  }
+
+  void
+  release()
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    open = true;
+    cv.notify_all();
+  }
+};
+
+// Add stages that log their calls, the iteration is counted by each
+// stage since stage functions of one stage run in iteration order
+// when the stage is limited to one iteration in flight
+void
+add_logged_stages(xrt::pipeline& p, call_log& log, unsigned int stages, unsigned int stage_depth)
+{
+  for (unsigned int s = 0; s < stages; ++s) {
+    auto iteration = std::make_shared<std::atomic<unsigned int>>(0);
+    auto& stage = std::get<0>(p.emplace([&log, s, stages, iteration] {
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+      log.add(s, (*iteration)++, stages);
+    }));
+    stage.set_max_inflight(stage_depth);
+  }
+}
+
+}
+
+BOOST_AUTO_TEST_CASE( test_stage_order )
+{
+  const unsigned int stages = 3;
+  const unsigned int iterations = 50;
+  const unsigned int max_inflight = 3;
+  call_log log;
+  queue_with_handlers q(4);
+
+  xrt::pipeline p(q.queue, max_inflight);
+  add_logged_stages(p, log, stages, 1);
+
+  std::vector<xrt::event> events;
+  for (unsigned int i = 0; i < iterations; ++i)
+    events.push_back(p.execute());
+  for (auto& ev : events)
+    ev.wait();
+
+  BOOST_REQUIRE_EQUAL(log.calls.size(), stages * iterations);
+  for (unsigned int i = 0; i < iterations; ++i) {
+    // Stages of an iteration run in order
+    for (unsigned int s = 1; s < stages; ++s)
+      BOOST_CHECK_LT(log.position(s - 1, i), log.position(s, i));
+
+    // Iterations of a stage limited to one in flight run in order
+    if (i)
+      for (unsigned int s = 0; s < stages; ++s)
+        BOOST_CHECK_LT(log.position(s, i - 1), log.position(s, i));
+  }
+
+  // Iterations did overlap, but no more than the pipeline maximum
+  BOOST_CHECK_GT(log.max_active, 1);
+  BOOST_CHECK_LE(log.max_active, max_inflight);
+  BOOST_CHECK(!p.get_error());
+}
+
+BOOST_AUTO_TEST_CASE( test_ring_slot )
+{
+  const unsigned int max_inflight = 4;
+  std::mutex mutex;
+  std::vector<unsigned int> slots;
+  queue_with_handlers q(2);
+
+  xrt::pipeline p(q.queue, max_inflight);
+  p.emplace([&](unsigned int slot) {
+    std::lock_guard<std::mutex> lk(mutex);
+    slots.push_back(slot);
+  });
+  auto& stage = std::get<0>(p.emplace([] {}));
+  stage.set_max_inflight(1);
+
+  for (unsigned int i = 0; i < 10; ++i)
+    p.execute().wait();
+  BOOST_REQUIRE_EQUAL(slots.size(), 10);
+  for (unsigned int i = 0; i < 10; ++i)
+    BOOST_CHECK_EQUAL(slots[i], i % max_inflight);
+}
+
+BOOST_AUTO_TEST_CASE( test_back_pressure )
+{
+  const unsigned int max_inflight = 2;
+  gate g;
+  std::atomic<unsigned int> started{0};
+  queue_with_handlers q(4);
+
+  xrt::pipeline p(q.queue, max_inflight);
+  p.emplace([&] { ++started; g.wait(); });
+
+  p.execute();
+  p.execute();
+
+  // Third iteration reuses the slot of the first, which is blocked
+  auto third = std::async(std::launch::async, [&] { return p.execute(); });
+  BOOST_CHECK(third.wait_for(std::chrono::milliseconds(100)) == std::future_status::timeout);
+
+  g.release();
+  third.get().wait();
+  BOOST_CHECK_EQUAL(started, 3);
+}
+
+BOOST_AUTO_TEST_CASE( test_error )
+{
+  const unsigned int stages = 3;
+  const unsigned int iterations = 8;
+  const unsigned int fail_at = 3;
+  call_log log;
+  std::atomic<unsigned int> last{0};
+  gate g;
+  queue_with_handlers q(2);
+
+  xrt::pipeline p(q.queue, iterations);
+  auto first = std::make_shared<std::atomic<unsigned int>>(0);
+  std::get<0>(p.emplace([&log, &g, first] {
+    g.wait();
+    log.add(0, (*first)++, stages);
+  })).set_max_inflight(1);
+  auto second = std::make_shared<std::atomic<unsigned int>>(0);
+  std::get<0>(p.emplace([&log, second] {
+    auto i = (*second)++;
+    if (i == fail_at)
+      throw std::runtime_error("stage failed");
+    log.add(1, i, stages);
+  })).set_max_inflight(1);
+  p.emplace([&last] { ++last; });
+
+  // All iterations are in flight before the failure
+  std::vector<xrt::event> events;
+  for (unsigned int i = 0; i < iterations; ++i)
+    events.push_back(p.execute());
+  g.release();
+
+  // Events of skipped stages complete too
+  for (auto& ev : events)
+    ev.wait();
+
+  auto error = p.get_error();
+  BOOST_REQUIRE(error);
+  BOOST_CHECK_THROW(std::rethrow_exception(error), std::runtime_error);
+
+  // Iterations of the failed stage before the failure completed,
+  // later iterations of it were skipped, and so was the last stage of
+  // the failed iteration and of any iteration still pending
+  BOOST_CHECK_EQUAL(*second, fail_at + 1);
+  for (unsigned int i = 0; i < iterations; ++i)
+    BOOST_CHECK_EQUAL(log.position(1, i) < log.calls.size(), i < fail_at);
+  BOOST_CHECK_GE(*first, fail_at + 1);
+  BOOST_CHECK_LE(last, fail_at);
+
+  // Failed pipeline rejects new iterations
+  BOOST_CHECK_THROW(p.execute(), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( test_teardown_in_flight )
+{
+  const unsigned int stages = 2;
+  const unsigned int iterations = 6;
+  call_log log;
+  gate g;
+  queue_with_handlers q(2);
+
+  std::vector<xrt::event> events;
+  {
+    // Pipeline is destructed while all iterations are blocked
+    xrt::pipeline p(q.queue, iterations);
+    p.enable_statistics();
+    std::get<0>(p.emplace([&g] { g.wait(); }));
+    add_logged_stages(p, log, stages, 1);
+    for (unsigned int i = 0; i < iterations; ++i)
+      events.push_back(p.execute());
+  }
+
+  g.release();
+  for (auto& ev : events)
+    ev.wait();
+  BOOST_CHECK_EQUAL(log.calls.size(), stages * iterations);
+}
+
+BOOST_AUTO_TEST_CASE( test_teardown_handlers )
+{
+  // Handlers are destructed with stages pending, the queue keeps the
+  // pending events and a new handler completes them
+  const unsigned int iterations = 4;
+  xrt::event_queue queue;
+  gate g;
+  std::atomic<unsigned int> done{0};
+  std::vector<xrt::event> events;
+
+  xrt::pipeline p(queue, iterations);
+  p.emplace([&g] { g.wait(); });
+  p.emplace([&done] { ++done; });
+  std::thread releaser;
+  {
+    // Destructor waits for the running stage function
+    std::vector<xrt::event_handler> handlers;
+    handlers.emplace_back(queue);
+    for (unsigned int i = 0; i < iterations; ++i)
+      events.push_back(p.execute());
+    releaser = std::thread([&g] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      g.release();
+    });
+  }
+  releaser.join();
+
+  xrt::event_handler handler(queue);
+  for (auto& ev : events)
+    ev.wait();
+  BOOST_CHECK_EQUAL(done, iterations);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
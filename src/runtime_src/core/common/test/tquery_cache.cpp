@@ -0,0 +1,167 @@
+/**
+ * Copyright (C) 2021 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing of core/common/query_cache.h
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "core/common/query_cache.h"
+
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+BOOST_AUTO_TEST_SUITE ( test_query_cache )
+
+namespace {
+
+using xrt_core::query::cache;
+using xrt_core::query::freshness;
+using xrt_core::query::key_type;
+
+const key_type key1 = static_cast<key_type>(1);
+const key_type key2 = static_cast<key_type>(2);
+
+// Query that returns and counts the number of times it was called
+struct counting_query
+{
+  int calls = 0;
+
+  boost::any
+  operator() ()
+  {
+    return ++calls;
+  }
+};
+
+int
+get(cache& qc, key_type key, freshness fresh, counting_query& qr)
+{
+  return boost::any_cast<int>(qc.get(key, fresh, [&qr] { return qr(); }));
+}
+
+}
+
+BOOST_AUTO_TEST_CASE( test_freshness )
+{
+  cache qc(std::chrono::milliseconds(1000));
+  counting_query vq, sq, cq;
+
+  // volatile is never cached and not counted
+  BOOST_CHECK_EQUAL(get(qc, key1, freshness::volatile_data, vq), 1);
+  BOOST_CHECK_EQUAL(get(qc, key1, freshness::volatile_data, vq), 2);
+
+  BOOST_CHECK_EQUAL(get(qc, key2, freshness::slow_changing, sq), 1);
+  BOOST_CHECK_EQUAL(get(qc, key2, freshness::slow_changing, sq), 1);
+
+  auto stats = qc.get_stats();
+  BOOST_CHECK_EQUAL(stats.hits, 1);
+  BOOST_CHECK_EQUAL(stats.misses, 1);
+
+  cache sc(std::chrono::milliseconds(1000));
+  BOOST_CHECK_EQUAL(get(sc, key1, freshness::static_data, cq), 1);
+  BOOST_CHECK_EQUAL(get(sc, key1, freshness::static_data, cq), 1);
+}
+
+BOOST_AUTO_TEST_CASE( test_ttl )
+{
+  cache qc(std::chrono::milliseconds(20));
+  counting_query sq, cq;
+
+  BOOST_CHECK_EQUAL(get(qc, key1, freshness::slow_changing, sq), 1);
+  BOOST_CHECK_EQUAL(get(qc, key1, freshness::slow_changing, sq), 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(40));
+  BOOST_CHECK_EQUAL(get(qc, key1, freshness::slow_changing, sq), 2);
+
+  // static data does not expire
+  BOOST_CHECK_EQUAL(get(qc, key2, freshness::static_data, cq), 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(40));
+  BOOST_CHECK_EQUAL(get(qc, key2, freshness::static_data, cq), 1);
+}
+
+BOOST_AUTO_TEST_CASE( test_set_ttl )
+{
+  cache qc(std::chrono::milliseconds(1000));
+  counting_query vq, cq;
+
+  // override makes a volatile key cacheable
+  qc.set_ttl(key1, std::chrono::milliseconds(1000));
+  BOOST_CHECK_EQUAL(get(qc, key1, freshness::volatile_data, vq), 1);
+  BOOST_CHECK_EQUAL(get(qc, key1, freshness::volatile_data, vq), 1);
+
+  // zero disables caching of a static key and drops its value
+  BOOST_CHECK_EQUAL(get(qc, key2, freshness::static_data, cq), 1);
+  qc.set_ttl(key2, std::chrono::milliseconds::zero());
+  BOOST_CHECK_EQUAL(get(qc, key2, freshness::static_data, cq), 2);
+  BOOST_CHECK_EQUAL(get(qc, key2, freshness::static_data, cq), 3);
+}
+
+BOOST_AUTO_TEST_CASE( test_clear )
+{
+  cache qc(std::chrono::milliseconds(1000));
+  counting_query q1, q2;
+
+  BOOST_CHECK_EQUAL(get(qc, key1, freshness::static_data, q1), 1);
+  BOOST_CHECK_EQUAL(get(qc, key2, freshness::static_data, q2), 1);
+
+  qc.clear(key1);
+  BOOST_CHECK_EQUAL(get(qc, key1, freshness::static_data, q1), 2);
+  BOOST_CHECK_EQUAL(get(qc, key2, freshness::static_data, q2), 1);
+
+  qc.clear();
+  BOOST_CHECK_EQUAL(get(qc, key1, freshness::static_data, q1), 3);
+  BOOST_CHECK_EQUAL(get(qc, key2, freshness::static_data, q2), 2);
+}
+
+BOOST_AUTO_TEST_CASE( test_generation )
+{
+  cache qc(std::chrono::milliseconds(1000));
+  int calls = 0;
+
+  // cache is cleared while the query runs, value is returned but not stored
+  auto racing = [&] {
+    qc.clear();
+    return boost::any(++calls);
+  };
+  BOOST_CHECK_EQUAL(boost::any_cast<int>(qc.get(key1, freshness::static_data, racing)), 1);
+
+  counting_query qr;
+  BOOST_CHECK_EQUAL(get(qc, key1, freshness::static_data, qr), 1);
+  BOOST_CHECK_EQUAL(get(qc, key1, freshness::static_data, qr), 1);
+  BOOST_CHECK_EQUAL(qc.get_stats().hits, 1);
+
+  // clear of another key also invalidates an inflight query
+  auto racing_key = [&] {
+    qc.clear(key1);
+    return boost::any(++calls);
+  };
+  BOOST_CHECK_EQUAL(boost::any_cast<int>(qc.get(key2, freshness::static_data, racing_key)), 2);
+  BOOST_CHECK_EQUAL(get(qc, key2, freshness::static_data, qr), 2);
+}
+
+BOOST_AUTO_TEST_CASE( test_failed_query )
+{
+  cache qc(std::chrono::milliseconds(1000));
+  auto failing = [] () -> boost::any { throw std::runtime_error("query failed"); };
+  BOOST_CHECK_THROW(qc.get(key1, freshness::static_data, failing), std::runtime_error);
+
+  counting_query qr;
+  BOOST_CHECK_EQUAL(get(qc, key1, freshness::static_data, qr), 1);
+  BOOST_CHECK_EQUAL(get(qc, key1, freshness::static_data, qr), 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
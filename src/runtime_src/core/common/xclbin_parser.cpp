@@ -16,17 +16,29 @@
 #define XRT_CORE_COMMON_SOURCE
 #include "xclbin_parser.h"
 #include "config_reader.h"
+#include "gen/version.h"
 
 #include <algorithm>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <regex>
 #include <cstring>
 #include <cstdlib>
+#include <cstdio>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/xml_parser.hpp>
 #include <boost/range/iterator_range.hpp>
 #include <boost/optional.hpp>
 #include <boost/algorithm/string.hpp>
 
+#ifdef _WIN32
+# include <process.h>
+#else
+# include <unistd.h>
+#endif
+
 // This is xclbin parser. Update this file if xclbin format has changed.
 #ifdef _WIN32
 #pragma warning ( disable : 4996 )
@@ -153,6 +165,294 @@ kernel_max_ctx(const ip_data& ip)
 }
 
 
+// struct xml_metadata - kernel meta data extracted from xml section
+//
+// The embedded xml meta data is parsed once per distinct xml section
+// and cached process wide, optionally also on disk, so that repeated
+// kernel construction does not re-parse the xml.
+struct xml_metadata
+{
+  std::vector<xrt_core::xclbin::kernel_object> kernels; // xml order
+  size_t max_cu_size = 0;
+  size_t kernel_freq = 100; //default clock frequency is 100
+};
+
+using kernel_argument = xrt_core::xclbin::kernel_argument;
+
+static std::shared_ptr<const xml_metadata>
+parse_xml_metadata(const char* xml_data, size_t xml_size)
+{
+  auto md = std::make_shared<xml_metadata>();
+
+  pt::ptree xml_project;
+  std::stringstream xml_stream;
+  xml_stream.write(xml_data,xml_size);
+  pt::read_xml(xml_stream,xml_project);
+
+  for (auto& xml_kernel : xml_project.get_child("project.platform.device.core")) {
+    if (xml_kernel.first != "kernel")
+      continue;
+
+    xrt_core::xclbin::kernel_object kernel;
+    kernel.name = xml_kernel.second.get<std::string>("<xmlattr>.name");
+    kernel.range = 0x10000; //default kernel range is 64KB
+    bool slave = false;
+
+    for (auto& xml_arg : xml_kernel.second) {
+      if (xml_arg.first == "port") {
+        /* one AXI slave port per kernel */
+        if (!slave && xml_arg.second.get<std::string>("<xmlattr>.mode") == "slave") {
+          kernel.range = convert(xml_arg.second.get<std::string>("<xmlattr>.range"));
+          slave = true;
+        }
+        continue;
+      }
+
+      if (xml_arg.first != "arg")
+        continue;
+
+      std::string id = xml_arg.second.get<std::string>("<xmlattr>.id");
+      size_t index = id.empty() ? kernel_argument::no_index : convert(id);
+
+      kernel.args.emplace_back(kernel_argument{
+          xml_arg.second.get<std::string>("<xmlattr>.name")
+         ,xml_arg.second.get<std::string>("<xmlattr>.type", "no-type")
+         ,xml_arg.second.get<std::string>("<xmlattr>.port", "no-port")
+         ,index
+         ,convert(xml_arg.second.get<std::string>("<xmlattr>.offset"))
+         ,convert(xml_arg.second.get<std::string>("<xmlattr>.size"))
+         ,convert(xml_arg.second.get<std::string>("<xmlattr>.hostSize"))
+         ,0  // fa_desc_offset post computed if necessary
+         ,kernel_argument::argtype(xml_arg.second.get<size_t>("<xmlattr>.addressQualifier"))
+         ,kernel_argument::direction(kernel_argument::direction::input)
+      });
+
+      auto& arg = kernel.args.back();
+      md->max_cu_size = std::max(md->max_cu_size, arg.offset + arg.size);
+    }
+
+    // stable sort to preserve order of multi-component arguments
+    // for example global_size, local_size, etc.
+    std::stable_sort(kernel.args.begin(), kernel.args.end(), [](auto& a1, auto& a2) { return a1.index < a2.index; });
+    md->kernels.emplace_back(std::move(kernel));
+  }
+
+  auto clock_child = xml_project.get_child_optional("project.platform.device.core.kernelClocks");
+  if (clock_child) { // check whether kernelClocks field exists or not
+    for (auto& xml_clock : *clock_child) {
+      if (xml_clock.first != "clock")
+        continue;
+      auto port = xml_clock.second.get<std::string>("<xmlattr>.port","");
+      auto freq = convert(xml_clock.second.get<std::string>("<xmlattr>.frequency","100"));
+      if(port == "KERNEL_CLK")
+        md->kernel_freq = freq;
+    }
+  }
+
+  return md;
+}
+
+// Disk cache of xml meta data.  The format is a flat sequence of
+// fixed size integers and length prefixed strings in host byte order
+// that is only meant to be read back by same version of XRT.
+namespace disk_cache {
+
+// The magic encodes the file format version, bump it when the layout
+// changes.  The kernel_object and kernel_argument types may change
+// between XRT builds without a format change, so the file also records
+// the XRT build hash and is only read back by the same build.
+constexpr uint64_t magic = 0x32444d4b54525800; // "\0XRTKMD2"
+
+static void
+write(std::ostream& ostr, uint64_t value)
+{
+  ostr.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void
+write(std::ostream& ostr, const std::string& str)
+{
+  write(ostr, str.size());
+  ostr.write(str.data(), str.size());
+}
+
+static uint64_t
+read_uint(std::istream& istr)
+{
+  uint64_t value = 0;
+  if (!istr.read(reinterpret_cast<char*>(&value), sizeof(value)))
+    throw std::runtime_error("truncated kernel meta data");
+  return value;
+}
+
+static std::string
+read_string(std::istream& istr)
+{
+  auto size = read_uint(istr);
+  if (size > 0x10000)
+    throw std::runtime_error("corrupt kernel meta data");
+  std::string str(size, '\0');
+  if (!istr.read(&str[0], size))
+    throw std::runtime_error("truncated kernel meta data");
+  return str;
+}
+
+// The build hash is part of the name so that different XRT builds
+// sharing a cache directory do not overwrite each other's files
+static std::string
+path(const std::string& dir, uint64_t hash, size_t xml_size)
+{
+  char name[96];
+  std::snprintf(name, sizeof(name), "/%016llx-%zx-%.12s.kmd",
+                static_cast<unsigned long long>(hash), xml_size, xrt_build_version_hash);
+  return dir + name;
+}
+
+static std::shared_ptr<const xml_metadata>
+load(const std::string& fnm)
+{
+  std::ifstream istr(fnm, std::ios::binary);
+  if (!istr)
+    return nullptr;
+
+  try {
+    if (read_uint(istr) != magic)
+      return nullptr;
+    if (read_string(istr) != xrt_build_version_hash)
+      return nullptr;
+
+    auto md = std::make_shared<xml_metadata>();
+    md->max_cu_size = read_uint(istr);
+    md->kernel_freq = read_uint(istr);
+    auto num_kernels = read_uint(istr);
+    for (uint64_t kidx = 0; kidx < num_kernels; ++kidx) {
+      xrt_core::xclbin::kernel_object kernel;
+      kernel.name = read_string(istr);
+      kernel.range = read_uint(istr);
+      auto num_args = read_uint(istr);
+      for (uint64_t aidx = 0; aidx < num_args; ++aidx) {
+        kernel_argument arg;
+        arg.name = read_string(istr);
+        arg.hosttype = read_string(istr);
+        arg.port = read_string(istr);
+        arg.index = read_uint(istr);
+        arg.offset = read_uint(istr);
+        arg.size = read_uint(istr);
+        arg.hostsize = read_uint(istr);
+        arg.fa_desc_offset = read_uint(istr);
+        arg.type = kernel_argument::argtype(read_uint(istr));
+        arg.dir = kernel_argument::direction(read_uint(istr));
+        kernel.args.emplace_back(std::move(arg));
+      }
+      md->kernels.emplace_back(std::move(kernel));
+    }
+    return md;
+  }
+  catch (const std::exception&) {
+    return nullptr;
+  }
+}
+
+// Write to a process unique temporary and rename so that concurrent
+// readers never see a partial file.  Failure is silently ignored.
+static void
+store(const std::string& fnm, const xml_metadata& md)
+{
+#ifdef _WIN32
+  auto tmp = fnm + "." + std::to_string(_getpid());
+#else
+  auto tmp = fnm + "." + std::to_string(getpid());
+#endif
+  {
+    std::ofstream ostr(tmp, std::ios::binary);
+    if (!ostr)
+      return;
+
+    write(ostr, magic);
+    write(ostr, std::string(xrt_build_version_hash));
+    write(ostr, md.max_cu_size);
+    write(ostr, md.kernel_freq);
+    write(ostr, md.kernels.size());
+    for (auto& kernel : md.kernels) {
+      write(ostr, kernel.name);
+      write(ostr, kernel.range);
+      write(ostr, kernel.args.size());
+      for (auto& arg : kernel.args) {
+        write(ostr, arg.name);
+        write(ostr, arg.hosttype);
+        write(ostr, arg.port);
+        write(ostr, arg.index);
+        write(ostr, arg.offset);
+        write(ostr, arg.size);
+        write(ostr, arg.hostsize);
+        write(ostr, arg.fa_desc_offset);
+        write(ostr, static_cast<uint64_t>(arg.type));
+        write(ostr, static_cast<uint64_t>(arg.dir));
+      }
+    }
+
+    if (!ostr.flush()) {
+      ostr.close();
+      std::remove(tmp.c_str());
+      return;
+    }
+  }
+
+  if (std::rename(tmp.c_str(), fnm.c_str()))
+    std::remove(tmp.c_str());
+}
+
+} // disk_cache
+
+// FNV-1a hash of the xml meta data, used together with the size as
+// cache key.  Hashing is much cheaper than parsing the xml.
+static uint64_t
+hash_xml(const char* xml_data, size_t xml_size)
+{
+  uint64_t hash = 0xcbf29ce484222325;
+  for (size_t idx = 0; idx < xml_size; ++idx) {
+    hash ^= static_cast<unsigned char>(xml_data[idx]);
+    hash *= 0x100000001b3;
+  }
+  return hash;
+}
+
+// Get parsed meta data for xml section from process wide cache,
+// from the disk cache, or by parsing the xml
+static std::shared_ptr<const xml_metadata>
+get_xml_metadata(const char* xml_data, size_t xml_size)
+{
+  static std::mutex mutex;
+  static std::map<std::pair<uint64_t, size_t>, std::shared_ptr<const xml_metadata>> cache;
+
+  auto key = std::make_pair(hash_xml(xml_data, xml_size), xml_size);
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    auto itr = cache.find(key);
+    if (itr != cache.end())
+      return (*itr).second;
+  }
+
+  std::shared_ptr<const xml_metadata> md;
+  static auto dir = xrt_core::config::get_kernel_metadata_cache_dir();
+  auto fnm = dir.empty() ? std::string() : disk_cache::path(dir, key.first, key.second);
+  if (!fnm.empty())
+    md = disk_cache::load(fnm);
+
+  if (!md) {
+    md = parse_xml_metadata(xml_data, xml_size);
+    if (!fnm.empty())
+      disk_cache::store(fnm, *md);
+  }
+
+  // A process rarely sees more than a few xclbins, bound the cache
+  // in case it does
+  std::lock_guard<std::mutex> lk(mutex);
+  if (cache.size() >= 16)
+    cache.clear();
+  return cache.emplace(key, md).first->second;
+}
+
 } // namespace
 
 namespace xrt_core { namespace xclbin {
@@ -237,27 +537,7 @@ get_first_used_mem(const axlf* top)
 size_t
 get_max_cu_size(const char* xml_data, size_t xml_size)
 {
-  pt::ptree xml_project;
-  std::stringstream xml_stream;
-  xml_stream.write(xml_data,xml_size);
-  pt::read_xml(xml_stream,xml_project);
-
-  size_t maxsz = 0;
-
-  for (auto& xml_kernel : xml_project.get_child("project.platform.device.core")) {
-    if (xml_kernel.first != "kernel")
-      continue;
-
-    for (auto& xml_arg : xml_kernel.second) {
-      if (xml_arg.first != "arg")
-        continue;
-
-      auto ofs = convert(xml_arg.second.get<std::string>("<xmlattr>.offset"));
-      auto sz = convert(xml_arg.second.get<std::string>("<xmlattr>.size"));
-      maxsz = std::max(maxsz, ofs + sz);
-    }
-  }
-  return maxsz;
+  return get_xml_metadata(xml_data, xml_size)->max_cu_size;
 }
 
 std::vector<uint64_t>
@@ -568,123 +848,36 @@ get_softkernels(const axlf* top)
 size_t
 get_kernel_freq(const axlf* top)
 {
-  size_t kernel_clk_freq = 100; //default clock frequency is 100
   auto xml = get_xml_section(top);
-
-  pt::ptree xml_project;
-  std::stringstream xml_stream;
-  xml_stream.write(xml.first,xml.second);
-  pt::read_xml(xml_stream,xml_project);
-
-  auto clock_child = xml_project.get_child_optional("project.platform.device.core.kernelClocks");
-
-  if (clock_child) { // check whether kernelClocks field exists or not
-    for (auto& xml_clock : xml_project.get_child("project.platform.device.core.kernelClocks")) {
-      if (xml_clock.first != "clock")
-        continue;
-      auto port = xml_clock.second.get<std::string>("<xmlattr>.port","");
-      auto freq = convert(xml_clock.second.get<std::string>("<xmlattr>.frequency","100"));
-      if(port == "KERNEL_CLK")
-        kernel_clk_freq = freq;
-    }
-  }
-
-  return kernel_clk_freq;
+  return get_xml_metadata(xml.first, xml.second)->kernel_freq;
 }
 
 size_t
 get_kernel_range(const char* xml_data, size_t xml_size, const std::string& kname)
 {
-  size_t kernel_range = 0x10000; //default kernel range is 64KB
+  for (auto& kernel : get_xml_metadata(xml_data, xml_size)->kernels)
+    if (kernel.name == kname)
+      return kernel.range;
 
-  pt::ptree xml_project;
-  std::stringstream xml_stream;
-  xml_stream.write(xml_data,xml_size);
-  pt::read_xml(xml_stream,xml_project);
-
-  for (auto& xml_kernel : xml_project.get_child("project.platform.device.core")) {
-    if (xml_kernel.first != "kernel")
-      continue;
-    if (xml_kernel.second.get<std::string>("<xmlattr>.name") != kname)
-      continue;
-
-    for (auto& xml_port : xml_kernel.second) {
-      if (xml_port.first != "port")
-        continue;
-
-      /* one AXI slave port per kernel */
-      if (xml_port.second.get<std::string>("<xmlattr>.mode") == "slave") {
-        kernel_range = convert(xml_port.second.get<std::string>("<xmlattr>.range"));
-        break;
-      }
-    }
-  }
-
-  return kernel_range;
+  return 0x10000; //default kernel range is 64KB
 }
 
 std::vector<kernel_argument>
 get_kernel_arguments(const char* xml_data, size_t xml_size, const std::string& kname)
 {
-  std::vector<kernel_argument> args;
-
-  pt::ptree xml_project;
-  std::stringstream xml_stream;
-  xml_stream.write(xml_data,xml_size);
-  pt::read_xml(xml_stream,xml_project);
-
-  for (auto& xml_kernel : xml_project.get_child("project.platform.device.core")) {
-    if (xml_kernel.first != "kernel")
-      continue;
-    if (xml_kernel.second.get<std::string>("<xmlattr>.name") != kname)
-      continue;
-
-    for (auto& xml_arg : xml_kernel.second) {
-      if (xml_arg.first != "arg")
-        continue;
-
-      std::string id = xml_arg.second.get<std::string>("<xmlattr>.id");
-      size_t index = id.empty() ? kernel_argument::no_index : convert(id);
-
-      args.emplace_back(kernel_argument{
-          xml_arg.second.get<std::string>("<xmlattr>.name")
-         ,xml_arg.second.get<std::string>("<xmlattr>.type", "no-type")
-
-            ,xml_arg.second.get<std::string>("<xmlattr>.port", "no-port")
-         ,index
-         ,convert(xml_arg.second.get<std::string>("<xmlattr>.offset"))
-         ,convert(xml_arg.second.get<std::string>("<xmlattr>.size"))
-         ,convert(xml_arg.second.get<std::string>("<xmlattr>.hostSize"))
-         ,0  // fa_desc_offset post computed if necessary
-         ,kernel_argument::argtype(xml_arg.second.get<size_t>("<xmlattr>.addressQualifier"))
-         ,kernel_argument::direction(kernel_argument::direction::input)
-      });
-    }
+  for (auto& kernel : get_xml_metadata(xml_data, xml_size)->kernels)
+    if (kernel.name == kname)
+      return kernel.args;
 
-    // stable sort to preserve order of multi-component arguments
-    // for example global_size, local_size, etc.
-    std::stable_sort(args.begin(), args.end(), [](auto& a1, auto& a2) { return a1.index < a2.index; });
-    break;
-  }
-  return args;
+  return {};
 }
 
 std::vector<std::string>
 get_kernel_names(const char *xml_data, size_t xml_size)
 {
   std::vector<std::string> names;
-
-  pt::ptree xml_project;
-  std::stringstream xml_stream;
-  xml_stream.write(xml_data,xml_size);
-  pt::read_xml(xml_stream,xml_project);
-
-  for (auto& xml_kernel : xml_project.get_child("project.platform.device.core")) {
-    if (xml_kernel.first != "kernel")
-      continue;
-
-    names.push_back(xml_kernel.second.get<std::string>("<xmlattr>.name"));
-  }
+  for (auto& kernel : get_xml_metadata(xml_data, xml_size)->kernels)
+    names.push_back(kernel.name);
 
   return names;
 }
@@ -699,16 +892,7 @@ get_kernel_arguments(const axlf* top, const std::string& kname)
 std::vector<kernel_object>
 get_kernels(const char* xml_data, size_t xml_size)
 {
-  std::vector<kernel_object> kernels;
-
-  auto knames = get_kernel_names(xml_data, xml_size);
-  for (auto& kname : get_kernel_names(xml_data, xml_size)) {
-    kernels.emplace_back
-      (kernel_object{kname,get_kernel_arguments(xml_data, xml_size, kname),
-                     get_kernel_range(xml_data, xml_size, kname)});
-  }
-
-  return kernels;
+  return get_xml_metadata(xml_data, xml_size)->kernels;
 }
 
 std::vector<kernel_object>
@@ -66,6 +66,33 @@ kds_custat_raw_show(struct device *dev, struct device_attribute *attr, char *buf
 }
 static DEVICE_ATTR_RO(kds_custat_raw);
 
+static ssize_t
+kds_cu_load_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	struct drm_zocl_dev *zdev = dev_get_drvdata(dev);
+
+	return show_kds_cu_load(&zdev->kds, buf);
+}
+static DEVICE_ATTR_RO(kds_cu_load);
+
+static ssize_t
+kds_cu_policy_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	struct drm_zocl_dev *zdev = dev_get_drvdata(dev);
+
+	return show_kds_cu_policy(&zdev->kds, buf);
+}
+
+static ssize_t
+kds_cu_policy_store(struct device *dev, struct device_attribute *da,
+		    const char *buf, size_t count)
+{
+	struct drm_zocl_dev *zdev = dev_get_drvdata(dev);
+
+	return store_kds_cu_policy(&zdev->kds, buf, count);
+}
+static DEVICE_ATTR(kds_cu_policy, 0644, kds_cu_policy_show, kds_cu_policy_store);
+
 static ssize_t xclbinid_show(struct device *dev,
 		struct device_attribute *attr, char *buf)
 {
@@ -433,6 +460,8 @@ static struct attribute *zocl_attrs[] = {
 	&dev_attr_kds_mode.attr,
 	&dev_attr_kds_stat.attr,
 	&dev_attr_kds_custat_raw.attr,
+	&dev_attr_kds_cu_load.attr,
+	&dev_attr_kds_cu_policy.attr,
 	&dev_attr_memstat.attr,
 	&dev_attr_memstat_raw.attr,
 	&dev_attr_errors.attr,
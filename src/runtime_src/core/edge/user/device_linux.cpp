@@ -27,6 +27,7 @@
 #include <string>
 
 #include <unistd.h>
+#include <poll.h>
 
 #include <boost/format.hpp>
 #include <boost/tokenizer.hpp>
@@ -660,4 +661,25 @@ wait_ip_interrupt(xclInterruptNotifyHandle handle)
     throw error(errno, "wait_ip_interrupt failed POSIX read");
 }
 
+std::cv_status
+device_linux::
+wait_ip_interrupt(xclInterruptNotifyHandle handle, int32_t timeout_ms, xclInterruptNotifyHandle wake)
+{
+  // A negative wake fd is ignored by poll
+  struct pollfd pfd[2] = {{handle, POLLIN, 0}, {wake, POLLIN, 0}};
+  auto ret = ::poll(pfd, 2, timeout_ms);
+  if (ret == -1)
+    throw error(errno, "wait_ip_interrupt failed POSIX poll");
+
+  // Woken up or timed out, the wake fd is drained by its owner
+  if (!(pfd[0].revents & POLLIN))
+    return std::cv_status::timeout;
+
+  int pending = 0;
+  if (::read(handle, &pending, sizeof(pending)) == -1)
+    throw error(errno, "wait_ip_interrupt failed POSIX read");
+
+  return std::cv_status::no_timeout;
+}
+
 } // xrt_core
@@ -61,6 +61,9 @@ public:
 
   virtual void
   wait_ip_interrupt(xclInterruptNotifyHandle);
+
+  virtual std::cv_status
+  wait_ip_interrupt(xclInterruptNotifyHandle, int32_t timeout_ms, xclInterruptNotifyHandle wake);
   ////////////////////////////////////////////////////////////////
 
 private:
@@ -99,8 +99,17 @@ class event_queue
       execute(const event_ptr& evp)
       {
         m_held();                 // start async operation
-        auto& w = m_future.get(); // get waitable return value
-        w.set_event(evp);         // waitable must notify event
+        const ResultType* w = nullptr;
+        try {
+          w = &m_future.get();    // get waitable return value
+        }
+        catch (...) {
+          // operation threw, no waitable will notify the event, the
+          // exception is kept in the future
+          event::notify(evp.get());
+          return;
+        }
+        w->set_event(evp);        // waitable must notify event
       }
     };
 
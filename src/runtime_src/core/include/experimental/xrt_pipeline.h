@@ -23,9 +23,13 @@
 #include "experimental/xrt_enqueue.h"
 
 #ifdef __cplusplus
+# include <cstdint>
+# include <exception>
+# include <functional>
 # include <memory>
 # include <vector>
 # include <tuple>
+# include <type_traits>
 #endif
 
 #ifdef __cplusplus
@@ -52,6 +56,15 @@ namespace xrt {
  * The execution is managed by xrt::event objects.  Each stage
  * function returns an event that is used when enqueue child
  * stages.
+ *
+ * A pipeline can be constructed with a maximum number of iterations
+ * in flight.  Each call to execute() starts a new iteration, which
+ * is assigned a ring slot (iteration modulo max in-flight).  Stage
+ * functions that take an unsigned int argument are called with the
+ * slot of the iteration, this allows stages to double buffer their
+ * inputs and outputs by indexing a ring of buffers.  Once the
+ * maximum number of iterations are in flight, execute() blocks
+ * until the oldest iteration has completed.
  * 
  * A pipeline itself can be stage of another pipeline.
  */
@@ -64,34 +77,78 @@ class pipeline
   // xrt::event_queue
   class stage
   {
+    // on_start is called before the stage function and may throw to
+    // skip it, on_error is called with any exception of either
+    using start_callback = std::function<void()>;
+    using error_callback = std::function<void(std::exception_ptr)>;
+
     struct stage_holder
     {
+      virtual ~stage_holder() {}
+
       virtual xrt::event
-      enqueue(xrt::event_queue& q, const std::vector<xrt::event>& deps) = 0;
+      enqueue(xrt::event_queue& q, const std::vector<xrt::event>& deps,
+              unsigned int slot, const start_callback& on_start,
+              const error_callback& on_error) = 0;
     };
 
     template <typename Callable>
     struct stage_type : stage_holder
     {
-      Callable m_held;
+      using held_type = typename std::decay<Callable>::type;
+      held_type m_held;
+
       stage_type(Callable&& c)
-        : m_held(std::move(c))
+        : m_held(std::forward<Callable>(c))
       {}
 
+      // Stage function takes ring slot of iteration
+      template <typename Held>
+      static auto
+      invoke(Held& held, unsigned int slot, int) -> decltype(held(slot))
+      {
+        return held(slot);
+      }
+
+      // Stage function takes no arguments
+      template <typename Held>
+      static auto
+      invoke(Held& held, unsigned int, long) -> decltype(held())
+      {
+        return held();
+      }
+
       xrt::event
-      enqueue(xrt::event_queue& q, const std::vector<xrt::event>& deps)
+      enqueue(xrt::event_queue& q, const std::vector<xrt::event>& deps,
+              unsigned int slot, const start_callback& on_start,
+              const error_callback& on_error)
       {
-        return q.enqueue_with_waitlist(m_held, deps);
+        auto held = m_held;
+        return q.enqueue_with_waitlist([held, slot, on_start, on_error]() mutable {
+          try {
+            if (on_start)
+              on_start();
+            return invoke(held, slot, 0);
+          }
+          catch (...) {
+            if (on_error)
+              on_error(std::current_exception());
+            throw;
+          }
+        }, deps);
       }
     };
 
     std::unique_ptr<stage_holder> m_content;
+    unsigned int m_max_inflight = 0;
 
   public:
     stage() : m_content(nullptr)
     {}
 
-    stage(stage&& rhs) : m_content(std::move(rhs.m_content))
+    stage(stage&& rhs)
+      : m_content(std::move(rhs.m_content))
+      , m_max_inflight(rhs.m_max_inflight)
     {}
 
     template <typename Callable>
@@ -99,15 +156,57 @@ class pipeline
       : m_content(new stage_type<Callable>(std::forward<Callable>(c)))
     {}
 
+    /**
+     * set_max_inflight() - Limit concurrent iterations of this stage
+     *
+     * @max:  Maximum number of iterations of this stage that can
+     *        execute concurrently, zero uses pipeline maximum
+     *
+     * A stage function for an iteration is not started before the
+     * same stage has completed for iteration minus @max.
+     */
+    void
+    set_max_inflight(unsigned int max)
+    {
+      m_max_inflight = max;
+    }
+
+    unsigned int
+    get_max_inflight() const
+    {
+      return m_max_inflight;
+    }
+
     xrt::event
-    enqueue(xrt::event_queue& q, const std::vector<xrt::event>& deps)
+    enqueue(xrt::event_queue& q, const std::vector<xrt::event>& deps,
+            unsigned int slot = 0, const start_callback& on_start = nullptr,
+            const error_callback& on_error = nullptr)
     {
-      return m_content->enqueue(q, deps);
+      return m_content->enqueue(q, deps, slot, on_start, on_error);
     }
   };
 
 
 public:
+  /**
+   * struct stage_statistics - execution statistics of a stage
+   *
+   * @iterations:      number of completed iterations
+   * @avg_latency_us:  average time from start of stage function to
+   *                   completion of stage
+   * @max_latency_us:  maximum time from start of stage function to
+   *                   completion of stage
+   * @throughput:      completed iterations per second measured from
+   *                   first start to last completion
+   */
+  struct stage_statistics
+  {
+    uint64_t iterations = 0;
+    double avg_latency_us = 0;
+    double max_latency_us = 0;
+    double throughput = 0;
+  };
+
   /**
    * Constructor - 
    *
@@ -122,10 +221,26 @@ public:
    */
   pipeline(const xrt::event_queue& q);
 
+  /**
+   * Constructor - 
+   *
+   * @q:             Event queue on which stage functions are enqueued
+   * @max_inflight:  Maximum number of pipeline iterations in flight
+   *
+   * With zero @max_inflight, the number of iterations in flight is
+   * unbounded and all iterations use ring slot 0.
+   */
+  pipeline(const xrt::event_queue& q, unsigned int max_inflight);
+
   /**
    * execute() - Run the pipeline once
    *
    * @event:  Event that controls the start of the first stage
+   *
+   * A stage function that throws fails the pipeline.  Stage
+   * functions of any iteration that have not started are then
+   * skipped, their events complete without calling the function,
+   * and execute() rethrows the exception of the failed stage.
    */
   xrt::event
   execute(xrt::event event);
@@ -166,6 +281,35 @@ public:
     return execute();
   }
 
+  /**
+   * enable_statistics() - Collect per stage execution statistics
+   *
+   * Statistics collection adds a bookkeeping event per stage and
+   * iteration to the event queue.
+   */
+  void
+  enable_statistics(bool enable = true);
+
+  /**
+   * get_statistics() - Get execution statistics per stage
+   *
+   * Return:  Statistics in the order stages were added
+   */
+  std::vector<stage_statistics>
+  get_statistics() const;
+
+  /**
+   * get_error() - Get the exception that failed the pipeline
+   *
+   * Return:  Exception thrown by the first stage function that
+   *          failed, null if no stage function has failed
+   *
+   * Wait for the events of all iterations before checking if they
+   * all succeeded.
+   */
+  std::exception_ptr
+  get_error() const;
+
   /**
    * define the control flow graph -- todo
    */
@@ -197,7 +341,7 @@ public:
   }
 
 private:
-  const stage&
+  stage&
   add_stage(stage&& s);
 
 private:
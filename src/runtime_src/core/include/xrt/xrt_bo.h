@@ -22,6 +22,8 @@
 #include "xrt_mem.h"
 
 #ifdef __cplusplus
+# include "experimental/xrt_enqueue.h"
+# include <chrono>
 # include <memory>
 #endif
 
@@ -54,6 +56,8 @@ namespace xrt {
 using memory_group = xrtMemoryGroup;
 
 class bo_impl;
+class bo_async_impl;
+class event_impl;
 class bo
 {
 public:
@@ -307,6 +311,128 @@ public:
     sync(dir, size(), 0);
   }
 
+  /**
+   * @class async_handle
+   *
+   * @brief
+   * Waitable handle for an asynchronous buffer sync
+   *
+   * @details
+   * An async handle is returned by ``async()``.  The handle can be
+   * waited on, or returned from a function enqueued in an
+   * ``xrt::event_queue`` in which case the event completes when the
+   * sync completes and can be used as a dependency of other enqueued
+   * operations, e.g. kernel runs.
+   */
+  class async_handle
+  {
+  public:
+    async_handle()
+    {}
+
+    /**
+     * wait() - Wait for the sync to complete
+     *
+     * Throws if the sync failed.
+     */
+    XCL_DRIVER_DLLESPEC
+    void
+    wait() const;
+
+    /**
+     * wait() - Wait for the sync to complete or timeout to expire
+     *
+     * @param timeout
+     *  Timeout for wait
+     * @return
+     *  True if sync completed, false if timeout expired
+     *
+     * Throws if the sync failed.
+     */
+    XCL_DRIVER_DLLESPEC
+    bool
+    wait(const std::chrono::milliseconds& timeout) const;
+
+    /**
+     * ready() - Check if the sync has completed
+     */
+    XCL_DRIVER_DLLESPEC
+    bool
+    ready() const;
+
+    /**
+     * set_event() - Add event for enqueued operations
+     *
+     * @param event
+     *   Opaque implementation object
+     *
+     * This function is used when an async sync is enqueued in an
+     * event graph.  The event is notified upon completion of the sync.
+     */
+    XCL_DRIVER_DLLESPEC
+    void
+    set_event(const std::shared_ptr<event_impl>& event) const;
+
+    explicit
+    operator bool() const
+    {
+      return handle != nullptr;
+    }
+
+  public:
+    /// @cond
+    async_handle(std::shared_ptr<bo_async_impl> impl)
+      : handle(std::move(impl))
+    {}
+
+    const std::shared_ptr<bo_async_impl>&
+    get_handle() const
+    {
+      return handle;
+    }
+    /// @endcond
+
+  private:
+    std::shared_ptr<bo_async_impl> handle;
+  };
+
+  /**
+   * async() - Start asynchronous sync of buffer content with device side
+   *
+   * @param dir
+   *  To device or from device
+   * @param sz
+   *  Size of data to synchronize
+   * @param offset
+   *  Offset within the BO
+   * @return
+   *  Handle that can be waited on for completion of the sync
+   *
+   * The sync is performed by a pool of DMA worker threads, such that
+   * multiple syncs can overlap with each other and with kernel
+   * execution.  The buffer must not be accessed by the host until the
+   * sync has completed.  There is no ordering between outstanding
+   * syncs.  The pool size is ``Runtime.dma_channels`` in xrt.ini, or
+   * 2 if not specified.
+   */
+  XCL_DRIVER_DLLESPEC
+  async_handle
+  async(xclBOSyncDirection dir, size_t sz, size_t offset);
+
+  /**
+   * async() - Start asynchronous sync of entire buffer
+   *
+   * @param dir
+   *  To device or from device
+   * @return
+   *  Handle that can be waited on for completion of the sync
+   */
+  async_handle
+  async(xclBOSyncDirection dir)
+  {
+    return async(dir, size(), 0);
+  }
+
   /**
    * map() - Map the host side buffer into application
    *
@@ -449,6 +575,16 @@ private:
   std::shared_ptr<bo_impl> handle;
 };
 
+/// @cond
+// Specialization from xrt_enqueue.h for async buffer syncs, which
+// are asynchronous waitable objects.
+template <>
+struct callable_traits<bo::async_handle>
+{
+  enum { is_async = true };
+};
+/// @endcond
+
 } // namespace xrt
 
 /// @cond
@@ -374,7 +374,226 @@ private:
     set_arg(++argno, std::forward<Args>(args)...);
   }
 };
- 
+
+/*!
+ * @class run_batch
+ *
+ * @brief
+ * xrt::run_batch represents a group of runs started together
+ *
+ * @details
+ * A run batch submits all its runs for execution with a single call
+ * to the command scheduler and notifies waiters once when all runs
+ * have completed.  This amortizes the per run submission overhead
+ * when many short running kernel executions are launched.
+ *
+ * All runs in a batch must be associated with the same device.  The
+ * runs must have their arguments set prior to starting the batch, and
+ * a run cannot be started individually while its batch is running.
+ */
+class run_batch_impl;
+class run_batch
+{
+ public:
+  /**
+   * run_batch() - Construct empty run batch
+   */
+  XCL_DRIVER_DLLESPEC
+  run_batch();
+
+  /**
+   * run_batch() - Construct run batch from a list of runs
+   *
+   * @param runs
+   *  Run objects to add to the batch
+   */
+  XCL_DRIVER_DLLESPEC
+  explicit
+  run_batch(const std::vector<xrt::run>& runs);
+
+  /**
+   * add() - Add a run object to the batch
+   *
+   * @param run
+   *  Run object to add, must be on same device as other runs in batch
+   */
+  XCL_DRIVER_DLLESPEC
+  void
+  add(const xrt::run& run);
+
+  /**
+   * size() - Number of runs in the batch
+   */
+  XCL_DRIVER_DLLESPEC
+  size_t
+  size() const;
+
+  /**
+   * start() - Start execution of all runs in the batch
+   *
+   * This function is asynchronous, ``wait()`` must be used to wait
+   * for the batch to complete before it can be started again.
+   */
+  XCL_DRIVER_DLLESPEC
+  void
+  start();
+
+  /**
+   * wait() - Wait for all runs in the batch to complete execution
+   *
+   * @param timeout
+   *  Timeout for wait (default block till batch completes)
+   * @return
+   *  ERT_CMD_STATE_COMPLETED if all runs completed successfully,
+   *  otherwise the state of the first run that did not
+   */
+  XCL_DRIVER_DLLESPEC
+  ert_cmd_state
+  wait(const std::chrono::milliseconds& timeout = std::chrono::milliseconds{0}) const;
+
+public:
+  /// @cond
+  const std::shared_ptr<run_batch_impl>&
+  get_handle() const
+  {
+    return handle;
+  }
+  /// @endcond
+
+private:
+  std::shared_ptr<run_batch_impl> handle;
+};
+
+/*!
+ * @class run_template
+ *
+ * @brief
+ * xrt::run_template is a frozen run for repeated launches
+ *
+ * @details
+ * A run template is constructed from a run object whose arguments
+ * have been set.  The command packet of the run, including its
+ * compute units, is encoded once and copied into a fixed number of
+ * pre-allocated runs.  Starting the template starts the next of these
+ * runs, after patching only the arguments that have changed in the
+ * template since that run was last started.  This allows the same
+ * logical run to have up to depth executions in flight with minimal
+ * per launch host overhead.
+ *
+ * If all runs of the template are in flight, start() blocks until the
+ * oldest run has completed.
+ */
+class run_template_impl;
+class run_template
+{
+ public:
+  /**
+   * run_template() - Construct empty run template
+   */
+  run_template()
+  {}
+
+  /**
+   * run_template() - Construct run template from a run object
+   *
+   * @param run
+   *  Run object with arguments set that is used as template
+   * @param depth
+   *  Max number of executions of the template that can be in flight
+   */
+  XCL_DRIVER_DLLESPEC
+  run_template(const xrt::run& run, size_t depth);
+
+  /**
+   * depth() - Max number of executions that can be in flight
+   */
+  XCL_DRIVER_DLLESPEC
+  size_t
+  depth() const;
+
+  /**
+   * set_arg() - Change a scalar argument of the template
+   *
+   * @param index
+   *  Index of kernel argument to change
+   * @param arg
+   *  The scalar argument value to set.
+   *
+   * The new value is used by subsequent starts of the template.
+   */
+  template <typename ArgType>
+  void
+  set_arg(int index, ArgType&& arg)
+  {
+    set_arg_at_index(index, &arg, sizeof(arg));
+  }
+
+  /**
+   * set_arg() - Change a global buffer argument of the template
+   *
+   * @param index
+   *  Index of kernel argument to change
+   * @param boh
+   *  The global buffer argument value to set (lvalue).
+   */
+  void
+  set_arg(int index, xrt::bo& boh)
+  {
+    set_arg_at_index(index, boh);
+  }
+
+  /**
+   * set_arg - xrt::bo variant for const lvalue
+   */
+  void
+  set_arg(int index, const xrt::bo& boh)
+  {
+    set_arg_at_index(index, boh);
+  }
+
+  /**
+   * set_arg - xrt::bo variant for rvalue
+   */
+  void
+  set_arg(int index, xrt::bo&& boh)
+  {
+    set_arg_at_index(index, boh);
+  }
+
+  /**
+   * start() - Start an execution of the template
+   *
+   * @return
+   *  Run object for the started execution, which can be used
+   *  to wait for the execution to complete
+   *
+   * The returned run object is reused by the template after depth
+   * subsequent starts.
+   */
+  XCL_DRIVER_DLLESPEC
+  xrt::run
+  start();
+
+public:
+  /// @cond
+  const std::shared_ptr<run_template_impl>&
+  get_handle() const
+  {
+    return handle;
+  }
+  /// @endcond
+
+private:
+  std::shared_ptr<run_template_impl> handle;
+
+  XCL_DRIVER_DLLESPEC
+  void
+  set_arg_at_index(int index, const void* value, size_t bytes);
+
+  XCL_DRIVER_DLLESPEC
+  void
+  set_arg_at_index(int index, const xrt::bo&);
+};
 
 /*!
  * @class kernel
@@ -255,6 +255,15 @@ kds_custat_raw_show(struct device *dev, struct device_attribute *attr, char *buf
 }
 static DEVICE_ATTR_RO(kds_custat_raw);
 
+static ssize_t
+kds_cu_load_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	struct xocl_dev *xdev = dev_get_drvdata(dev);
+
+	return show_kds_cu_load(&XDEV(xdev)->kds, buf);
+}
+static DEVICE_ATTR_RO(kds_cu_load);
+
 static ssize_t
 kds_scustat_raw_show(struct device *dev, struct device_attribute *attr, char *buf)
 {
@@ -327,6 +336,24 @@ done:
 }
 static DEVICE_ATTR(kds_interrupt, 0644, kds_interrupt_show, kds_interrupt_store);
 
+static ssize_t
+kds_cu_policy_show(struct device *dev, struct device_attribute *attr, char *buf)
+{
+	struct xocl_dev *xdev = dev_get_drvdata(dev);
+
+	return show_kds_cu_policy(&XDEV(xdev)->kds, buf);
+}
+
+static ssize_t
+kds_cu_policy_store(struct device *dev, struct device_attribute *da,
+		    const char *buf, size_t count)
+{
+	struct xocl_dev *xdev = dev_get_drvdata(dev);
+
+	return store_kds_cu_policy(&XDEV(xdev)->kds, buf, count);
+}
+static DEVICE_ATTR(kds_cu_policy, 0644, kds_cu_policy_show, kds_cu_policy_store);
+
 static ssize_t
 ert_disable_show(struct device *dev, struct device_attribute *attr, char *buf)
 {
@@ -680,8 +707,10 @@ static struct attribute *xocl_attrs[] = {
 	&dev_attr_kds_numcdma.attr,
 	&dev_attr_kds_stat.attr,
 	&dev_attr_kds_custat_raw.attr,
+	&dev_attr_kds_cu_load.attr,
 	&dev_attr_kds_scustat_raw.attr,
 	&dev_attr_kds_interrupt.attr,
+	&dev_attr_kds_cu_policy.attr,
 	&dev_attr_ert_disable.attr,
 	&dev_attr_dev_offline.attr,
 	&dev_attr_mig_calibration.attr,
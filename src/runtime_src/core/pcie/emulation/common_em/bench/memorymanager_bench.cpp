@@ -0,0 +1,204 @@
+/**
+ * Copyright (C) 2021 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Allocation and free rate of the emulation device memory manager
+// under a stress of many live buffers.
+//
+// Keeps a number of buffers of random sizes live, and replaces a
+// random live buffer with a new one for the given number of
+// operations.  Runs the workload with the free and busy lists that
+// MemoryManager used before it indexed blocks by address and size,
+// and with MemoryManager.  Both must satisfy every allocation, and
+// after all buffers are freed both must have coalesced back to a
+// single block that a full size allocation succeeds from.
+//
+// Usage: memorymanager_bench [live buffers] [operations]
+
+#include "memorymanager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t alignment = 4096;
+constexpr uint64_t mem_size = 64ull << 30;
+
+// MemoryManager before blocks were indexed, first fit from a free
+// list coalesced by sorting once it exceeds the threshold
+class list_manager
+{
+  using pair_list = std::list<std::pair<uint64_t, uint64_t>>;
+
+  std::mutex mutex;
+  pair_list free_list;
+  pair_list busy_list;
+  const unsigned coalesce_threshold = 4;
+
+  void
+  coalesce()
+  {
+    free_list.sort();
+    auto curr = free_list.begin();
+    auto next = std::next(curr);
+    while (next != free_list.end()) {
+      if (curr->first + curr->second != next->first) {
+        curr = next++;
+        continue;
+      }
+      curr->second += next->second;
+      free_list.erase(next);
+      next = std::next(curr);
+    }
+  }
+
+public:
+  static constexpr uint64_t null = xclemulation::MemoryManager::mNull;
+
+  list_manager(uint64_t size, uint64_t start)
+  {
+    free_list.emplace_back(start, size);
+  }
+
+  uint64_t
+  alloc(size_t& size)
+  {
+    size = (size + alignment - 1) / alignment * alignment;
+    std::lock_guard<std::mutex> lk(mutex);
+    for (auto i = free_list.begin(); i != free_list.end(); ++i) {
+      if (i->second < size)
+        continue;
+      auto result = i->first;
+      if (i->second > size) {
+        i->first += size;
+        i->second -= size;
+      }
+      else {
+        free_list.erase(i);
+      }
+      busy_list.emplace_back(result, size);
+      return result;
+    }
+    return null;
+  }
+
+  void
+  free(uint64_t buf)
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    auto i = std::find_if(busy_list.begin(), busy_list.end(),
+                          [buf](const pair_list::value_type& b) { return b.first == buf; });
+    if (i == busy_list.end())
+      return;
+    free_list.push_back(*i);
+    busy_list.erase(i);
+    if (free_list.size() > coalesce_threshold)
+      coalesce();
+  }
+};
+
+size_t
+random_size(std::mt19937_64& rng)
+{
+  static const size_t sizes[] = {4096, 8192, 16384, 65536, 1 << 20};
+  return sizes[rng() % 5] - rng() % 4096;
+}
+
+// Run the workload, returns elapsed ns or a negative value if an
+// allocation failed or freeing all buffers did not restore one block
+template <typename Manager>
+double
+run(Manager& mgr, size_t live, size_t ops)
+{
+  std::mt19937_64 rng(42);
+  std::vector<uint64_t> bufs(live);
+
+  auto start = std::chrono::steady_clock::now();
+  for (auto& buf : bufs) {
+    auto size = random_size(rng);
+    buf = mgr.alloc(size);
+    if (buf == Manager::null)
+      return -1;
+  }
+  for (size_t op = 0; op < ops; ++op) {
+    auto& buf = bufs[rng() % live];
+    mgr.free(buf);
+    auto size = random_size(rng);
+    buf = mgr.alloc(size);
+    if (buf == Manager::null)
+      return -1;
+  }
+  for (auto buf : bufs)
+    mgr.free(buf);
+  auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  size_t full = mem_size;
+  auto buf = mgr.alloc(full);
+  if (buf == Manager::null)
+    return -1;
+  mgr.free(buf);
+  return elapsed;
+}
+
+// Adapter giving MemoryManager the interface of list_manager
+struct tree_manager
+{
+  static constexpr uint64_t null = xclemulation::MemoryManager::mNull;
+  xclemulation::MemoryManager mgr;
+
+  tree_manager(uint64_t size, uint64_t start)
+    : mgr(size, start, alignment)
+  {}
+
+  uint64_t alloc(size_t& size) { return mgr.alloc(size); }
+  void free(uint64_t buf) { mgr.free(buf); }
+};
+
+}
+
+int
+main(int argc, char* argv[])
+{
+  size_t live = (argc > 1) ? std::strtoul(argv[1], nullptr, 0) : 10000;
+  size_t ops = (argc > 2) ? std::strtoul(argv[2], nullptr, 0) : 30000;
+  if (live == 0) {
+    std::cerr << "Usage: " << argv[0] << " [live buffers] [operations]\n";
+    return 1;
+  }
+
+  list_manager lists(mem_size, 0);
+  auto list_ns = run(lists, live, ops);
+  tree_manager trees(mem_size, 0);
+  auto tree_ns = run(trees, live, ops);
+
+  if (list_ns < 0 || tree_ns < 0) {
+    std::cerr << "allocation failed or memory did not coalesce\n";
+    return 1;
+  }
+
+  auto total = 2 * (live + ops);
+  std::cout << live << " live buffers, " << ops << " operations\n"
+            << "free and busy lists " << list_ns / 1e6 << " ms, " << list_ns / total << " ns/op\n"
+            << "MemoryManager       " << tree_ns / 1e6 << " ms, " << tree_ns / total << " ns/op\n";
+  return 0;
+}
@@ -79,6 +79,7 @@ namespace xclemulation{
     mLegacyErt = ERTMODE::NONE;
     mCuBaseAddrForce=-1;
     mIsSharedFmodel=true;
+    mZeroCopyBO=false;
     mTimeOutScale=TIMEOUT_SCALE::NA;
     mIsPlatformDataAvailable = false;
   }
@@ -207,6 +208,10 @@ namespace xclemulation{
       {
         mIsSharedFmodel=getBoolValue(value,true);
       }
+      else if(name == "zero_copy_bo")
+      {
+        mZeroCopyBO=getBoolValue(value,false);
+      }
       else if(name == "keep_run_dir")
       {
         setKeepRunDir(getBoolValue(value,true));
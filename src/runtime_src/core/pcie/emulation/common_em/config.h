@@ -214,6 +214,7 @@ namespace xclemulation{
       inline ERTMODE getLegacyErt() const         { return mLegacyErt;              }
       inline long long getCuBaseAddrForce() const         { return mCuBaseAddrForce;              }
       inline bool isSharedFmodel() const         {return mIsSharedFmodel; } 
+      inline bool isZeroCopyBO() const           {return mZeroCopyBO; }
       inline TIMEOUT_SCALE getTimeOutScale() const    {return mTimeOutScale;}
 
       inline void setIsPlatformEnabled(bool isPlatformDataAvailable) {mIsPlatformDataAvailable = isPlatformDataAvailable; }
@@ -250,6 +251,7 @@ namespace xclemulation{
       ERTMODE mLegacyErt;
       long long mCuBaseAddrForce;
       bool      mIsSharedFmodel;
+      bool      mZeroCopyBO;      // sw_emu buffers backed by files shared with device process
       bool mIsPlatformDataAvailable;
       TIMEOUT_SCALE mTimeOutScale;
       config();
@@ -20,6 +20,7 @@
 #include <mutex>
 #include <list>
 #include <map>
+#include <set>
 #include <cassert>
 #include <algorithm>
 
@@ -30,20 +31,22 @@ namespace xclemulation
 {
 static std::map<uint64_t,uint64_t> DEFAULT_MAP;
 static std::string DEFAULT_TAG("");
+    // Free blocks are indexed both by address, for coalescing with
+    // neighbors when a buffer is freed, and by size, for best fit
+    // allocation.  Busy buffers are indexed by address.  Allocation,
+    // free, and lookup are all O(log n) in the number of blocks.
     class MemoryManager 
     {
         std::mutex mMemManagerMutex;
-        std::list<std::pair<uint64_t, uint64_t> > mFreeBufferList;
-        std::list<std::pair<uint64_t, uint64_t> > mBusyBufferList;
+        std::map<uint64_t, uint64_t> mFreeByAddr;             // start -> size
+        std::set<std::pair<uint64_t, uint64_t> > mFreeBySize; // (size, start)
+        std::map<uint64_t, uint64_t> mBusyBuffers;            // start -> size
         uint64_t mSize;
         uint64_t mStart;
         uint64_t mAlignment;
 	std::string mTag;
-        const unsigned mCoalesceThreshold;
         uint64_t mFreeSize;
 
-        typedef std::list<std::pair<uint64_t, uint64_t> > PairList;
-
     public:
 	static const uint64_t mNull = 0xffffffffffffffffull;
 	std::list<MemoryManager*> mChildMemories;
@@ -64,8 +67,8 @@ static std::string DEFAULT_TAG("");
         std::pair<uint64_t, uint64_t>lookup(uint64_t buf);
 
     private:
-        void coalesce();
-        PairList::iterator find(uint64_t buf);
+        void addFreeBlock(uint64_t start, uint64_t size);
+        void removeFreeBlock(std::map<uint64_t, uint64_t>::iterator block);
     };
 }
 
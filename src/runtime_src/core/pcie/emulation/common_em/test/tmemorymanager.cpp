@@ -0,0 +1,276 @@
+/**
+ * Copyright (C) 2021 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing of the emulation device memory manager in
+// core/pcie/emulation/common_em/memorymanager.cxx
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "memorymanager.h"
+
+#include <map>
+#include <random>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE ( test_memorymanager )
+
+namespace {
+
+using xclemulation::MemoryManager;
+
+constexpr uint64_t page = 4096;
+constexpr uint64_t base = 0x100000;
+constexpr uint64_t null = MemoryManager::mNull;
+
+uint64_t
+alloc(MemoryManager& mgr, size_t size)
+{
+  return mgr.alloc(size);
+}
+
+// Allocate count buffers of one page each, they are contiguous from
+// the start of an unused memory
+std::vector<uint64_t>
+alloc_pages(MemoryManager& mgr, size_t count)
+{
+  std::vector<uint64_t> bufs;
+  for (size_t idx = 0; idx < count; ++idx) {
+    bufs.push_back(alloc(mgr, page));
+    BOOST_REQUIRE_EQUAL(bufs.back(), mgr.start() + idx * page);
+  }
+  return bufs;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE( test_alignment )
+{
+  MemoryManager mgr(16 * page, base, page);
+
+  size_t size = 1;
+  auto buf = mgr.alloc(size);
+  BOOST_CHECK_EQUAL(buf, base);
+  BOOST_CHECK_EQUAL(size, page);
+
+  // Zero size allocates one alignment unit
+  size = 0;
+  buf = mgr.alloc(size);
+  BOOST_CHECK_EQUAL(buf, base + page);
+  BOOST_CHECK_EQUAL(size, page);
+
+  // Padding adds paddingFactor times the aligned size on each side
+  size = page + 1;
+  buf = mgr.alloc(size, 1);
+  BOOST_CHECK_EQUAL(buf, base + 2 * page);
+  BOOST_CHECK_EQUAL(size, 2 * page);
+  BOOST_CHECK_EQUAL(mgr.lookup(buf).second, 6 * page);
+  BOOST_CHECK_EQUAL(mgr.freeSize(), 8 * page);
+}
+
+BOOST_AUTO_TEST_CASE( test_exhausted )
+{
+  MemoryManager mgr(4 * page, base, page);
+  BOOST_CHECK_EQUAL(alloc(mgr, 5 * page), null);
+  BOOST_CHECK_EQUAL(alloc(mgr, 4 * page), base);
+  BOOST_CHECK_EQUAL(alloc(mgr, 1), null);
+  BOOST_CHECK_EQUAL(mgr.freeSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE( test_best_fit )
+{
+  MemoryManager mgr(16 * page, base, page);
+  auto bufs = alloc_pages(mgr, 10);
+
+  // Free holes of 3, 1, and 2 pages, separated by busy pages, plus the
+  // 6 page tail
+  mgr.free(bufs[1]);
+  mgr.free(bufs[2]);
+  mgr.free(bufs[3]);
+  mgr.free(bufs[5]);
+  mgr.free(bufs[7]);
+  mgr.free(bufs[8]);
+
+  // Smallest hole that fits, not the first one
+  BOOST_CHECK_EQUAL(alloc(mgr, page), bufs[5]);
+  BOOST_CHECK_EQUAL(alloc(mgr, 2 * page), bufs[7]);
+
+  // Remainder of a split hole stays allocatable
+  BOOST_CHECK_EQUAL(alloc(mgr, 2 * page), bufs[1]);
+  BOOST_CHECK_EQUAL(alloc(mgr, page), bufs[3]);
+
+  // Ties go to the lowest address
+  mgr.free(bufs[4]);
+  mgr.free(bufs[0]);
+  BOOST_CHECK_EQUAL(alloc(mgr, page), bufs[0]);
+  BOOST_CHECK_EQUAL(alloc(mgr, page), bufs[4]);
+}
+
+BOOST_AUTO_TEST_CASE( test_coalesce )
+{
+  MemoryManager mgr(8 * page, base, page);
+  auto bufs = alloc_pages(mgr, 8);
+
+  // With the previous free block
+  mgr.free(bufs[0]);
+  mgr.free(bufs[1]);
+  BOOST_CHECK_EQUAL(alloc(mgr, 2 * page), bufs[0]);
+
+  // With the next free block
+  mgr.free(bufs[3]);
+  mgr.free(bufs[2]);
+  BOOST_CHECK_EQUAL(alloc(mgr, 2 * page), bufs[2]);
+
+  // With both, bridging the two blocks
+  mgr.free(bufs[4]);
+  mgr.free(bufs[6]);
+  mgr.free(bufs[5]);
+  BOOST_CHECK_EQUAL(alloc(mgr, 3 * page), bufs[4]);
+
+  BOOST_CHECK_EQUAL(mgr.freeSize(), 0);
+}
+
+BOOST_AUTO_TEST_CASE( test_fragmentation )
+{
+  const size_t count = 64;
+  MemoryManager mgr(count * page, base, page);
+  auto bufs = alloc_pages(mgr, count);
+
+  // Every other page free, half the memory is free but no two free
+  // pages are adjacent
+  for (size_t idx = 0; idx < count; idx += 2)
+    mgr.free(bufs[idx]);
+  BOOST_CHECK_EQUAL(mgr.freeSize(), count / 2 * page);
+  BOOST_CHECK_EQUAL(alloc(mgr, 2 * page), null);
+
+  // Freeing one busy page joins it with both free neighbors
+  mgr.free(bufs[9]);
+  BOOST_CHECK_EQUAL(alloc(mgr, 4 * page), null);
+  BOOST_CHECK_EQUAL(alloc(mgr, 3 * page), bufs[8]);
+
+  // Freeing the rest coalesces to one block of the whole memory
+  for (size_t idx = 1; idx < count; idx += 2)
+    mgr.free(bufs[idx]);
+  mgr.free(bufs[8]);
+  BOOST_CHECK_EQUAL(mgr.freeSize(), count * page);
+  BOOST_CHECK_EQUAL(alloc(mgr, count * page), base);
+}
+
+BOOST_AUTO_TEST_CASE( test_lookup_free_unknown )
+{
+  MemoryManager mgr(8 * page, base, page);
+  auto buf = alloc(mgr, 2 * page);
+
+  auto found = mgr.lookup(buf);
+  BOOST_CHECK_EQUAL(found.first, buf);
+  BOOST_CHECK_EQUAL(found.second, 2 * page);
+  BOOST_CHECK(MemoryManager::isNullAlloc(mgr.lookup(buf + page)));
+
+  // Freeing an address that is not the start of a busy buffer, or
+  // freeing twice, is ignored
+  mgr.free(buf + page);
+  BOOST_CHECK_EQUAL(mgr.freeSize(), 6 * page);
+  mgr.free(buf);
+  mgr.free(buf);
+  BOOST_CHECK_EQUAL(mgr.freeSize(), 8 * page);
+  BOOST_CHECK(MemoryManager::isNullAlloc(mgr.lookup(buf)));
+  BOOST_CHECK_EQUAL(alloc(mgr, 8 * page), base);
+}
+
+BOOST_AUTO_TEST_CASE( test_reset )
+{
+  MemoryManager mgr(8 * page, base, page);
+  auto bufs = alloc_pages(mgr, 8);
+  mgr.free(bufs[3]);
+
+  mgr.reset();
+  BOOST_CHECK_EQUAL(mgr.freeSize(), 8 * page);
+  BOOST_CHECK(MemoryManager::isNullAlloc(mgr.lookup(bufs[0])));
+  BOOST_CHECK_EQUAL(alloc(mgr, 8 * page), base);
+}
+
+BOOST_AUTO_TEST_CASE( test_child_memories )
+{
+  MemoryManager parent(8 * page, base, page);
+  MemoryManager child0(4 * page, base, page);
+  MemoryManager child1(4 * page, base + 4 * page, page);
+  parent.mChildMemories.push_back(&child0);
+  parent.mChildMemories.push_back(&child1);
+
+  // Spans both children, split into one chunk per child
+  std::map<uint64_t, uint64_t> chunks;
+  size_t size = 6 * page;
+  BOOST_CHECK_EQUAL(parent.alloc(size, 0, chunks), base);
+  BOOST_REQUIRE_EQUAL(chunks.size(), 2);
+  BOOST_CHECK_EQUAL(chunks[base], 4 * page);
+  BOOST_CHECK_EQUAL(chunks[base + 4 * page], 2 * page);
+  BOOST_CHECK_EQUAL(child0.freeSize(), 0);
+  BOOST_CHECK_EQUAL(child1.freeSize(), 2 * page);
+
+  // Not enough left in the children, nothing is allocated
+  std::map<uint64_t, uint64_t> none;
+  size = 3 * page;
+  BOOST_CHECK_EQUAL(parent.alloc(size, 0, none), null);
+  BOOST_CHECK(none.empty());
+  BOOST_CHECK_EQUAL(child1.freeSize(), 2 * page);
+}
+
+BOOST_AUTO_TEST_CASE( test_random )
+{
+  // Random allocations and frees, live buffers must stay in range and
+  // disjoint, and freeSize must account for exactly the live buffers
+  const uint64_t size = 1024 * page;
+  MemoryManager mgr(size, base, page);
+  std::mt19937_64 rng(7);
+  std::map<uint64_t, uint64_t> live;
+
+  auto check = [&] {
+    uint64_t used = 0;
+    uint64_t end = base;
+    for (auto& buf : live) {
+      if (buf.first < end || buf.first + buf.second > base + size)
+        return false;
+      end = buf.first + buf.second;
+      used += buf.second;
+    }
+    return mgr.freeSize() == size - used;
+  };
+
+  for (size_t op = 0; op < 20000; ++op) {
+    if (!live.empty() && rng() % 2) {
+      auto it = live.begin();
+      std::advance(it, rng() % live.size());
+      mgr.free(it->first);
+      live.erase(it);
+    }
+    else {
+      size_t bytes = 1 + rng() % (16 * page);
+      auto buf = mgr.alloc(bytes);
+      if (buf != null)
+        live.emplace(buf, bytes);
+    }
+    if (op % 100 == 0)
+      BOOST_REQUIRE(check());
+  }
+  BOOST_REQUIRE(check());
+
+  for (auto& buf : live)
+    mgr.free(buf.first);
+  BOOST_CHECK_EQUAL(mgr.freeSize(), size);
+  BOOST_CHECK_EQUAL(alloc(mgr, size), base);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
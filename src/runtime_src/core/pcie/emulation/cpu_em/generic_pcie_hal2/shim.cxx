@@ -1040,6 +1040,9 @@ namespace xclcpuemhal2 {
       close(fd);
     }
     mFdToFileNameMap.clear();
+    for (auto& it: mSharedBOFdMap)
+      it.first->buf = nullptr;
+    mSharedBOFdMap.clear();
 
     if (mLogStream.is_open()) {
       mLogStream << __func__ << ", " << std::this_thread::get_id() << std::endl;
@@ -1102,6 +1105,9 @@ namespace xclcpuemhal2 {
       close(fd);
     }
       mFdToFileNameMap.clear();
+    for (auto& it: mSharedBOFdMap)
+      it.first->buf = nullptr;
+    mSharedBOFdMap.clear();
     mCloseAll = true;
     std::string socketName = sock->get_name();
     if(socketName.empty() == false)// device is active if socketName is non-empty
@@ -1234,7 +1240,9 @@ uint64_t CpuemShim::xoclCreateBo(xclemulation::xocl_create_bo* info)
   auto xobj = std::make_unique<xclemulation::drm_xocl_bo>();
   xobj->flags=info->flags;
   /* check whether buffer is p2p or not*/
-  bool noHostMemory = xclemulation::no_host_memory(xobj.get()) || xclemulation::xocl_bo_host_only(xobj.get());
+  /* with zero copy all buffers are backed by a file shared with the device process */
+  bool zeroCopy = xclemulation::config::getInstance()->isZeroCopyBO();
+  bool noHostMemory = zeroCopy || xclemulation::no_host_memory(xobj.get()) || xclemulation::xocl_bo_host_only(xobj.get());
   std::string sFileName("");
   xobj->base = xclAllocDeviceBuffer2(size,XCL_MEM_DEVICE_RAM,ddr,noHostMemory,sFileName);
   xobj->filename = sFileName;
@@ -1248,6 +1256,11 @@ uint64_t CpuemShim::xoclCreateBo(xclemulation::xocl_create_bo* info)
     return xclemulation::MemoryManager::mNull;
   }
 
+  // Map the shared file up front, if mapping fails the buffer falls
+  // back to transfers over the socket
+  if (zeroCopy && !xobj->filename.empty())
+    mapSharedBO(xobj.get());
+
   info->handle = mBufferCount;
   mXoclObjMap[mBufferCount++] = xobj.release();
   return 0;
@@ -1391,8 +1404,12 @@ int CpuemShim::xclCopyBO(unsigned int dst_boHandle, unsigned int src_boHandle, s
     return -1;
   }
 
+  // both buffers are backed by shared files
+  if (isSharedBO(sBO) && isSharedBO(dBO)) {
+    std::memcpy((unsigned char*)(dBO->buf) + dst_offset, (unsigned char*)(sBO->buf) + src_offset, size);
+  }
   // source buffer is host_only and destination buffer is device_only
-  if (xclemulation::xocl_bo_host_only(sBO) && !xclemulation::xocl_bo_p2p(sBO) && xclemulation::xocl_bo_dev_only(dBO)) {
+  else if (xclemulation::xocl_bo_host_only(sBO) && !xclemulation::xocl_bo_p2p(sBO) && xclemulation::xocl_bo_dev_only(dBO)) {
     unsigned char* host_only_buffer = (unsigned char*)(sBO->buf) + src_offset;
     if (xclCopyBufferHost2Device(dBO->base, (void*) host_only_buffer, size, dst_offset) != size) {
       return -1;
@@ -1451,29 +1468,9 @@ void *CpuemShim::xclMapBO(unsigned int boHandle, bool write)
     return nullptr;
   }
 
-  std::string sFileName = bo->filename;
-  if(!sFileName.empty() )
+  if(!bo->filename.empty() )
   {
-    int fd = open(sFileName.c_str(), (O_CREAT | O_RDWR), 0666);
-    if (fd == -1)
-    {
-      printf("Error opening exported BO file.\n");
-      return nullptr;
-    };
-
-    char* data = (char*) mmap(0, bo->size , PROT_READ |PROT_WRITE |PROT_EXEC ,  MAP_SHARED, fd, 0);
-    if(!data)
-      return nullptr;
-
-    int fR = ftruncate(fd, bo->size);
-    if(fR == -1)
-    {
-      close(fd);
-      munmap(data,bo->size);
-      return nullptr;
-    }
-    mFdToFileNameMap [fd] = std::make_tuple(sFileName,bo->size,(void*)data);
-    bo->buf = data;
+    void* data = mapSharedBO(bo);
     PRINTENDFUNC;
     return data;
   }
@@ -1489,11 +1486,74 @@ void *CpuemShim::xclMapBO(unsigned int boHandle, bool write)
   return pBuf;
 }
 
+// Map the file that backs the device side of a buffer.  The mapping
+// is created once per buffer and released when the buffer is freed.
+void* CpuemShim::mapSharedBO(xclemulation::drm_xocl_bo* bo)
+{
+  if (bo->buf)
+    return bo->buf;
+
+  int fd = open(bo->filename.c_str(), (O_CREAT | O_RDWR), 0666);
+  if (fd == -1)
+  {
+    printf("Error opening exported BO file.\n");
+    return nullptr;
+  };
+
+  if (ftruncate(fd, bo->size) == -1)
+  {
+    close(fd);
+    return nullptr;
+  }
+
+  void* data = mmap(0, bo->size , PROT_READ |PROT_WRITE |PROT_EXEC ,  MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED)
+  {
+    close(fd);
+    return nullptr;
+  }
+
+  mFdToFileNameMap [fd] = std::make_tuple(bo->filename,bo->size,data);
+  mSharedBOFdMap[bo] = fd;
+  bo->buf = data;
+  return data;
+}
+
+// Release the shared mapping of a buffer, if any
+void CpuemShim::unmapSharedBO(xclemulation::drm_xocl_bo* bo)
+{
+  auto itr = mSharedBOFdMap.find(bo);
+  if (itr == mSharedBOFdMap.end())
+    return;
+
+  int fd = (*itr).second;
+  munmap(bo->buf, bo->size);
+  close(fd);
+  mFdToFileNameMap.erase(fd);
+  mSharedBOFdMap.erase(itr);
+  bo->buf = nullptr;
+}
+
+// A shared buffer has its device side in a mapped file, data is
+// transferred with memcpy rather than over the socket
+bool CpuemShim::isSharedBO(const xclemulation::drm_xocl_bo* bo) const
+{
+  return xclemulation::config::getInstance()->isZeroCopyBO() && bo->buf && !bo->filename.empty();
+}
+
 int CpuemShim::xclUnmapBO(unsigned int boHandle, void* addr)
 {
   std::lock_guard<std::mutex> lk(mApiMtx);
   auto bo = xclGetBoByHandle(boHandle);
-  return bo ? munmap(addr,bo->size) : -1;
+  if (!bo)
+    return -1;
+
+  // The shared mapping is owned by the buffer and released when the
+  // buffer is freed
+  if (addr == bo->buf && mSharedBOFdMap.count(bo))
+    return 0;
+
+  return munmap(addr,bo->size);
 }
 
 /**************************************************************************************/
@@ -1513,6 +1573,23 @@ int CpuemShim::xclSyncBO(unsigned int boHandle, xclBOSyncDirection dir, size_t s
     return -1;
   }
 
+  if (isSharedBO(bo))
+  {
+    // Device memory is the shared mapping, only a user pointer
+    // needs to be copied
+    if (bo->userptr)
+    {
+      unsigned char* shared = (unsigned char*)(bo->buf) + offset;
+      unsigned char* user = (unsigned char*)(bo->userptr) + offset;
+      if (dir == XCL_BO_SYNC_BO_TO_DEVICE)
+        std::memcpy(shared, user, size);
+      else
+        std::memcpy(user, shared, size);
+    }
+    PRINTENDFUNC;
+    return 0;
+  }
+
   int returnVal = 0;
   if(dir == XCL_BO_SYNC_BO_TO_DEVICE)
   {
@@ -1550,6 +1627,7 @@ void CpuemShim::xclFreeBO(unsigned int boHandle)
   xclemulation::drm_xocl_bo* bo = (*it).second;;
   if(bo)
   {
+    unmapSharedBO(bo);
     xclFreeDeviceBuffer(bo->base);
     mXoclObjMap.erase(it);
   }
@@ -1571,6 +1649,12 @@ size_t CpuemShim::xclWriteBO(unsigned int boHandle, const void *src, size_t size
     PRINTENDFUNC;
     return -1;
   }
+  if (isSharedBO(bo))
+  {
+    std::memcpy((unsigned char*)(bo->buf) + seek, src, size);
+    PRINTENDFUNC;
+    return 0;
+  }
   size_t returnVal = 0;
   if (xclCopyBufferHost2Device(bo->base, src, size, seek) != size) {
     returnVal = EIO;
@@ -1594,6 +1678,12 @@ size_t CpuemShim::xclReadBO(unsigned int boHandle, void *dst, size_t size, size_
     PRINTENDFUNC;
     return -1;
   }
+  if (isSharedBO(bo))
+  {
+    std::memcpy(dst, (unsigned char*)(bo->buf) + skip, size);
+    PRINTENDFUNC;
+    return 0;
+  }
   size_t returnVal = 0;
   if (xclCopyBufferDevice2Host(dst, bo->base, size, skip) != size) {
     returnVal = EIO;
@@ -83,6 +83,10 @@ namespace xclcpuemhal2 {
       int xclExportBO(unsigned int boHandle);
       unsigned int xclImportBO(int boGlobalHandle, unsigned flags);
       int xclCopyBO(unsigned int dst_boHandle, unsigned int src_boHandle, size_t size, size_t dst_offset, size_t src_offset);
+      //Zero copy buffer support, device buffer backed by file shared with device process
+      void* mapSharedBO(xclemulation::drm_xocl_bo* bo);
+      void unmapSharedBO(xclemulation::drm_xocl_bo* bo);
+      bool isSharedBO(const xclemulation::drm_xocl_bo* bo) const;
       static int xclLogMsg(xclDeviceHandle handle, xrtLogMsgLevel level, const char* tag, const char* format, va_list args1);
 
 
@@ -329,6 +333,8 @@ namespace xclcpuemhal2 {
       std::map<int, xclemulation::drm_xocl_bo*> mXoclObjMap;
       static unsigned int mBufferCount;
       static std::map<int, std::tuple<std::string,int,void*> > mFdToFileNameMap;
+      // fd of the shared mapping of each zero copy buffer
+      std::map<xclemulation::drm_xocl_bo*, int> mSharedBOFdMap;
       // HAL2 RELATED member variables end
       std::list<std::tuple<uint64_t ,void*, std::map<uint64_t , uint64_t> > > mReqList;
       uint64_t mReqCounter;
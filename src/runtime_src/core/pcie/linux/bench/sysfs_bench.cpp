@@ -0,0 +1,210 @@
+/**
+ * Copyright (C) 2021 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Cost of device enumeration and of sampling sensors from sysfs.
+//
+// Builds a synthetic sysfs tree with the given number of xocl user
+// cards and points Runtime.sysfs_root at it.  Measures the time to
+// scan the tree, and the time per sensor read when reading a set of
+// xmc sensors one entry at a time with sysfs_get and with a single
+// sysfs_get_batch call.  The values read both ways must match.
+//
+// Usage: sysfs_bench [-c cards] [-n samples] [-p]
+//   -p enables Runtime.sysfs_persistent_fd for the per entry reads
+//
+// The batch reads keep one fd open per card and sensor, so ulimit -n
+// must be above cards * 12.
+
+#include "scan.h"
+
+#include <boost/filesystem.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+namespace bfs = boost::filesystem;
+
+namespace {
+
+const std::vector<std::string> sensors = {
+  "xmc_12v_pex_vol", "xmc_12v_pex_curr", "xmc_12v_aux_vol", "xmc_12v_aux_curr",
+  "xmc_vccint_vol", "xmc_vccint_curr", "xmc_fpga_temp", "xmc_se98_temp0",
+  "xmc_se98_temp1", "xmc_se98_temp2", "xmc_fan_rpm", "xmc_power"
+};
+
+void
+write_file(const bfs::path& path, const std::string& value)
+{
+  std::ofstream ofs(path.string());
+  ofs << value << "\n";
+}
+
+std::string
+card_name(unsigned int card)
+{
+  char name[32];
+  std::snprintf(name, sizeof(name), "0000:%02x:%02x.1", card / 32, card % 32);
+  return name;
+}
+
+// Layout of a ready xocl user function as seen by scan.cpp
+void
+make_tree(const bfs::path& root, unsigned int cards)
+{
+  auto devices = root / "bus/pci/devices";
+  auto driver = root / "bus/pci/drivers/xocl";
+  bfs::create_directories(driver);
+
+  for (unsigned int card = 0; card < cards; ++card) {
+    auto name = card_name(card);
+    auto dev = devices / name;
+    bfs::create_directories(dev / "drm" / ("renderD" + std::to_string(128 + card)));
+    write_file(dev / "vendor", "0x10ee");
+    write_file(dev / "device", "0x5001");
+    write_file(dev / "ready", "0x1");
+    write_file(dev / "userbar", "0");
+
+    auto xmc = dev / ("xmc." + std::to_string(card));
+    bfs::create_directories(xmc);
+    for (size_t idx = 0; idx < sensors.size(); ++idx)
+      write_file(xmc / sensors[idx], std::to_string(1000 * card + idx));
+
+    bfs::create_directory_symlink(dev, driver / name);
+  }
+}
+
+double
+elapsed_ns(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+int
+main(int argc, char* argv[])
+{
+  unsigned int cards = 256;
+  unsigned int samples = 100;
+  bool persistent_fd = false;
+
+  int opt;
+  while ((opt = getopt(argc, argv, "c:n:p")) != -1) {
+    switch (opt) {
+    case 'c': cards = std::strtoul(optarg, nullptr, 0); break;
+    case 'n': samples = std::strtoul(optarg, nullptr, 0); break;
+    case 'p': persistent_fd = true; break;
+    default:
+      std::cerr << "Usage: " << argv[0] << " [-c cards] [-n samples] [-p]\n";
+      return 1;
+    }
+  }
+  if (cards == 0 || cards > 256 * 32 || samples == 0) {
+    std::cerr << "cards must be 1.." << 256 * 32 << ", samples must be > 0\n";
+    return 1;
+  }
+
+  auto root = bfs::temp_directory_path() / bfs::unique_path("xrt_sysfs_%%%%%%%%");
+  make_tree(root, cards);
+
+  // Must be in place before the first config access
+  auto ini = root / "xrt.ini";
+  {
+    std::ofstream ofs(ini.string());
+    ofs << "[Runtime]\n"
+        << "sysfs_root=" << root.string() << "\n"
+        << "sysfs_persistent_fd=" << (persistent_fd ? "true" : "false") << "\n";
+  }
+  setenv("XRT_INI_PATH", ini.c_str(), 1);
+
+  int ret = 0;
+  try {
+    // First access constructs the scanner and scans the tree
+    auto start = std::chrono::steady_clock::now();
+    auto total = pcidev::get_dev_total(true);
+    auto first_ns = elapsed_ns(start);
+
+    start = std::chrono::steady_clock::now();
+    pcidev::rescan();
+    auto rescan_ns = elapsed_ns(start);
+
+    if (total != cards || pcidev::get_dev_ready(true) != cards) {
+      std::cerr << "scanned " << total << " cards, expected " << cards << "\n";
+      throw std::runtime_error("scan mismatch");
+    }
+
+    // Ready devices are listed in reverse scan order, index by card
+    std::vector<std::shared_ptr<pcidev::pci_device>> devs(cards);
+    for (unsigned int idx = 0; idx < cards; ++idx) {
+      auto dev = pcidev::get_dev(idx, true);
+      devs[dev->bus * 32 + dev->dev] = dev;
+    }
+
+    std::vector<pcidev::pci_device::sysfs_entry> entries;
+    for (auto& sensor : sensors)
+      entries.emplace_back("xmc", sensor);
+
+    // One entry at a time, as the sensor queries do
+    std::vector<uint32_t> single(cards * sensors.size());
+    start = std::chrono::steady_clock::now();
+    for (unsigned int sample = 0; sample < samples; ++sample)
+      for (unsigned int card = 0; card < cards; ++card)
+        for (size_t idx = 0; idx < sensors.size(); ++idx)
+          devs[card]->sysfs_get_sensor("xmc", sensors[idx], single[card * sensors.size() + idx]);
+    auto single_ns = elapsed_ns(start);
+
+    // All entries of a card in one call
+    std::vector<std::string> values;
+    std::vector<uint32_t> batch(cards * sensors.size());
+    std::string err;
+    start = std::chrono::steady_clock::now();
+    for (unsigned int sample = 0; sample < samples; ++sample)
+      for (unsigned int card = 0; card < cards; ++card) {
+        devs[card]->sysfs_get_batch(entries, err, values);
+        for (size_t idx = 0; idx < sensors.size(); ++idx)
+          batch[card * sensors.size() + idx] = std::strtoul(values[idx].c_str(), nullptr, 0);
+      }
+    auto batch_ns = elapsed_ns(start);
+
+    if (!err.empty())
+      throw std::runtime_error(err);
+    for (size_t idx = 0; idx < single.size(); ++idx) {
+      auto expected = 1000 * (idx / sensors.size()) + idx % sensors.size();
+      if (single[idx] != expected || batch[idx] != expected)
+        throw std::runtime_error("sensor value mismatch at " + std::to_string(idx));
+    }
+
+    double reads = double(samples) * cards * sensors.size();
+    std::printf("%u cards, %zu sensors per card, %u samples, persistent fd %s\n",
+                cards, sensors.size(), samples, persistent_fd ? "on" : "off");
+    std::printf("first scan        %10.3f ms\n", first_ns / 1e6);
+    std::printf("rescan            %10.3f ms\n", rescan_ns / 1e6);
+    std::printf("sysfs_get         %10.0f ns/read\n", single_ns / reads);
+    std::printf("sysfs_get_batch   %10.0f ns/read\n", batch_ns / reads);
+  }
+  catch (const std::exception& ex) {
+    std::cerr << "sysfs_bench: " << ex.what() << "\n";
+    ret = 1;
+  }
+
+  bfs::remove_all(root);
+  return ret;
+}
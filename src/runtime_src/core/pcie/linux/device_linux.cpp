@@ -221,12 +221,13 @@ struct mac_addr_list
     auto pdev = get_pcidev(device);
 
     //legacy code exposes only 4 mac addr sysfs nodes (0-3)
-    for (int i=0; i < LEGACY_COUNT; i++) {
-      std::string addr, errmsg;
-      pdev->sysfs_get("xmc", "mac_addr"+std::to_string(i), errmsg, addr);
-      list.push_back(addr);
-    }
+    std::vector<pcidev::pci_device::sysfs_entry> entries;
+    for (int i=0; i < LEGACY_COUNT; i++)
+      entries.emplace_back("xmc", "mac_addr"+std::to_string(i));
 
+    // A missing node reads as empty address
+    std::string errmsg;
+    pdev->sysfs_get_batch(entries, errmsg, list);
     return list;
   }
 };
@@ -640,6 +641,7 @@ reset(query::reset_type& key) const
 {
   std::string err;
   pcidev::get_dev(get_device_id(), false)->sysfs_put(key.get_subdev(), key.get_entry(), err, key.get_value());
+  clear_query_cache();
   if (!err.empty())
     throw error("reset failed");
 }
@@ -676,6 +678,7 @@ xclmgmt_load_xclbin(const char* buffer) const {
     xrt_core::send_exception_message(e.what(), "Failed to open device");
   }
 
+  clear_query_cache();
   if(ret == -errno) {
     throw error(ret, "Failed to download xclbin");
   }
@@ -35,6 +35,7 @@
 #include <boost/filesystem/fstream.hpp>
 #include "xclbin.h"
 #include "scan.h"
+#include "core/common/config_reader.h"
 #include "core/common/utils.h"
 
 #define RENDER_NM       "renderD"
@@ -173,17 +174,43 @@ namespace pcidev {
 
 namespace sysfs {
 
-static const std::string dev_root = "/sys/bus/pci/devices/";
-static const std::string drv_root = "/sys/bus/pci/drivers/";
+static const std::string&
+root()
+{
+  static std::string value = xrt_core::config::get_sysfs_root();
+  return value;
+}
+
+static const std::string&
+dev_root()
+{
+  static std::string value = root() + "/bus/pci/devices/";
+  return value;
+}
+
+static const std::string&
+drv_root()
+{
+  static std::string value = root() + "/bus/pci/drivers/";
+  return value;
+}
+
+// True when scanning a synthetic sysfs tree with no matching devfs
+static bool
+is_synthetic()
+{
+  static bool value = (root() != "/sys");
+  return value;
+}
 
 static std::string
 get_path(const std::string& name, const std::string& subdev, const std::string& entry)
 {
   std::string subdir;
-  if (get_subdev_dir_name(dev_root + name, subdev, subdir) != 0)
+  if (get_subdev_dir_name(dev_root() + name, subdev, subdir) != 0)
     return "";
 
-  auto path = dev_root;
+  auto path = dev_root();
   path += name;
   path += "/";
   path += subdir;
@@ -225,7 +252,7 @@ open(const std::string& name,
   if (path.empty()) {
     std::stringstream ss;
     ss << "Failed to find subdirectory for " << subdev
-       << " under " << dev_root + name << std::endl;
+       << " under " << dev_root() + name << std::endl;
     err = ss.str();
   } else {
     fs = open_path(path, err, write, binary);
@@ -249,18 +276,49 @@ get(const std::string& name,
     sv.push_back(line);
 }
 
-static void
-get(const std::string& name,
-    const std::string& subdev, const std::string& entry,
-    std::string& err, std::vector<uint64_t>& iv)
+// Read full content of an open sysfs entry.  Reading from offset
+// zero makes sysfs regenerate the value, so the fd can be kept open
+// and re-read.
+static int
+pread_all(int fd, std::string& s)
 {
-  iv.clear();
+  s.clear();
+  char buf[4096];
+  off_t off = 0;
+  while (true) {
+    auto n = ::pread(fd, buf, sizeof(buf), off);
+    if (n < 0)
+      return -errno;
+    if (n == 0)
+      return 0;
+    s.append(buf, n);
+    off += n;
+  }
+}
 
-  std::vector<std::string> sv;
-  get(name, subdev, entry, err, sv);
-  if (!err.empty())
-    return;
+// Split content into lines same as std::getline would
+static void
+split_lines(const std::string& s, std::vector<std::string>& sv)
+{
+  sv.clear();
+  size_t pos = 0;
+  while (pos < s.size()) {
+    auto nl = s.find('\n', pos);
+    if (nl == std::string::npos) {
+      sv.push_back(s.substr(pos));
+      break;
+    }
+    sv.push_back(s.substr(pos, nl - pos));
+    pos = nl + 1;
+  }
+}
 
+static void
+to_uint64(const std::string& name,
+          const std::string& subdev, const std::string& entry,
+          std::string& err, const std::vector<std::string>& sv,
+          std::vector<uint64_t>& iv)
+{
   for (auto& s : sv) {
     if (s.empty()) {
       std::stringstream ss;
@@ -282,6 +340,21 @@ get(const std::string& name,
   }
 }
 
+static void
+get(const std::string& name,
+    const std::string& subdev, const std::string& entry,
+    std::string& err, std::vector<uint64_t>& iv)
+{
+  iv.clear();
+
+  std::vector<std::string> sv;
+  get(name, subdev, entry, err, sv);
+  if (!err.empty())
+    return;
+
+  to_uint64(name, subdev, entry, err, sv, iv);
+}
+
 static void
 get(const std::string& name,
     const std::string& subdev, const std::string& entry,
@@ -384,12 +457,91 @@ static bool is_drv_mgmt(const std::string& driver)
   return ((driver.compare(MGMT_DRV_V1) == 0) || (driver.compare(MGMT_DRV_V2) == 0));
 }
 
+void
+pci_device::
+sysfs_read_nolock(const std::string& subdev, const std::string& entry,
+                  std::string& err, std::string& s)
+{
+  auto key = subdev + "/" + entry;
+
+  // A cached fd can go stale if the subdevice is reloaded, in which
+  // case it is dropped and the entry is reopened once
+  for (int attempt = 0; attempt < 2; ++attempt) {
+    err.clear();
+    s.clear();
+    auto itr = sysfs_fds.find(key);
+    if (itr == sysfs_fds.end()) {
+      auto path = sysfs::get_path(sysfs_name, subdev, entry);
+      if (path.empty()) {
+        std::stringstream ss;
+        ss << "Failed to find subdirectory for " << subdev
+           << " under " << sysfs::dev_root() + sysfs_name << std::endl;
+        err = ss.str();
+        return;
+      }
+      int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0) {
+        std::stringstream ss;
+        ss << "Failed to open " << path << " for reading: "
+           << strerror(errno) << std::endl;
+        err = ss.str();
+        return;
+      }
+      itr = sysfs_fds.emplace(key, fd).first;
+    }
+
+    auto ret = sysfs::pread_all((*itr).second, s);
+    if (!ret)
+      return;
+
+    ::close((*itr).second);
+    sysfs_fds.erase(itr);
+
+    std::stringstream ss;
+    ss << "Failed to read " << key << ": " << strerror(-ret) << std::endl;
+    err = ss.str();
+  }
+}
+
+void
+pci_device::
+sysfs_get_batch(const std::vector<sysfs_entry>& entries,
+                std::string& err, std::vector<std::string>& values)
+{
+  err.clear();
+  values.clear();
+  values.reserve(entries.size());
+
+  std::lock_guard<std::mutex> l(sysfs_lock);
+  for (auto& e : entries) {
+    std::string s;
+    std::string e_err;
+    sysfs_read_nolock(e.first, e.second, e_err, s);
+    if (!e_err.empty() && err.empty())
+      err = e_err;
+    if (!s.empty() && s.back() == '\n')
+      s.pop_back();
+    values.push_back(std::move(s));
+  }
+}
+
 void
 pci_device::
 sysfs_get(const std::string& subdev, const std::string& entry,
           std::string& err, std::vector<std::string>& ret)
 {
-  sysfs::get(sysfs_name, subdev, entry, err, ret);
+  if (!xrt_core::config::get_sysfs_persistent_fd()) {
+    sysfs::get(sysfs_name, subdev, entry, err, ret);
+    return;
+  }
+
+  std::string s;
+  {
+    std::lock_guard<std::mutex> l(sysfs_lock);
+    sysfs_read_nolock(subdev, entry, err, s);
+  }
+  if (err.empty())
+    sysfs::split_lines(s, ret);
 }
 
 void
@@ -397,7 +549,16 @@ pci_device::
 sysfs_get(const std::string& subdev, const std::string& entry,
           std::string& err, std::vector<uint64_t>& ret)
 {
-  sysfs::get(sysfs_name, subdev, entry, err, ret);
+  if (!xrt_core::config::get_sysfs_persistent_fd()) {
+    sysfs::get(sysfs_name, subdev, entry, err, ret);
+    return;
+  }
+
+  ret.clear();
+  std::vector<std::string> sv;
+  sysfs_get(subdev, entry, err, sv);
+  if (err.empty())
+    sysfs::to_uint64(sysfs_name, subdev, entry, err, sv, ret);
 }
 
 void
@@ -413,7 +574,14 @@ pci_device::
 sysfs_get(const std::string& subdev, const std::string& entry,
           std::string& err, std::string& s)
 {
-  sysfs::get(sysfs_name, subdev, entry, err, s);
+  if (!xrt_core::config::get_sysfs_persistent_fd()) {
+    sysfs::get(sysfs_name, subdev, entry, err, s);
+    return;
+  }
+
+  std::vector<std::string> sv;
+  sysfs_get(subdev, entry, err, sv);
+  s = sv.empty() ? "" : sv[0];
 }
 
 
@@ -520,10 +688,10 @@ pci_device(const std::string& drv_name, const std::string& sysfs) : sysfs_name(s
   if (is_mgmt())
     sysfs_get("", "instance", err, instance, static_cast<uint32_t>(INVALID_ID));
   else
-    instance = get_render_value(sysfs::dev_root + sysfs + "/drm");
+    instance = get_render_value(sysfs::dev_root() + sysfs + "/drm");
 
   sysfs_get<int>("", "userbar", err, user_bar, 0);
-  user_bar_size = bar_size(sysfs::dev_root + sysfs, user_bar);
+  user_bar_size = bar_size(sysfs::dev_root() + sysfs, user_bar);
   sysfs_get<bool>("", "ready", err, is_ready, false);
 }
 
@@ -532,6 +700,9 @@ pci_device::
 {
   if (user_bar_map != MAP_FAILED)
     ::munmap(user_bar_map, user_bar_size);
+
+  for (auto& fd : sysfs_fds)
+    ::close(fd.second);
 }
 
 int
@@ -948,6 +1119,8 @@ public:
 
     user_list.clear();
     mgmt_list.clear();
+    num_user_ready = 0;
+    num_mgmt_ready = 0;
 
     rescan_nolock(MGMT_DRV_V1);
     rescan_nolock(USER_DRV_V1);
@@ -982,7 +1155,7 @@ public:
 private:
   void rescan_nolock(const std::string driver)
   {
-    const std::string drvpath = sysfs::drv_root + driver;
+    const std::string drvpath = sysfs::drv_root() + driver;
     if(!bfs::exists(drvpath))
       return;
 
@@ -1002,7 +1175,9 @@ private:
       // In docker, all host sysfs nodes are available. So, we need to check
       // devnode to make sure the device is really assigned to docker. For
       // xoclv2 driver, we only have flash devnode when running golden image.
-      if (!bfs::exists(pf->get_subdev_path("", -1)) &&
+      // A synthetic sysfs tree has no devnodes.
+      if (!sysfs::is_synthetic() &&
+        !bfs::exists(pf->get_subdev_path("", -1)) &&
         !bfs::exists(pf->get_subdev_path("flash", -1)))
         continue;
 
@@ -1030,14 +1205,14 @@ private:
   // ready-for-use boards since xclProbe returns num_user_ready, not the size
   // of the full list.
   std::vector<std::shared_ptr<pci_device>> user_list;
-  size_t num_user_ready;
+  size_t num_user_ready = 0;
 
   // Full list of discovered mgmt devices. Index 0 ~ (num_mgmt_ready - 1) are
   // boards ready for use. The rest, if any, are not ready, according to what
   // is indicated by driver's "ready" sysfs entry. Application does not see
   // mgmt devices.
   std::vector<std::shared_ptr<pci_device>> mgmt_list;
-  size_t num_mgmt_ready;
+  size_t num_mgmt_ready = 0;
 
 };
 
@@ -17,6 +17,7 @@
 #ifndef _XCL_SCAN_H_
 #define _XCL_SCAN_H_
 
+#include <map>
 #include <string>
 #include <vector>
 #include <memory>
@@ -120,6 +121,17 @@ public:
       i = static_cast<T>(default_val); // default value
   }
 
+  // Subdevice and entry name of a sysfs node
+  using sysfs_entry = std::pair<std::string, std::string>;
+
+  // Read a list of sysfs entries in one call.  The entries are kept
+  // open and re-read with pread on subsequent calls.  Values are
+  // returned in order of entries with trailing newline removed, a
+  // failed entry reads as empty string and err holds first error.
+  void
+  sysfs_get_batch(const std::vector<sysfs_entry>& entries,
+                  std::string& err, std::vector<std::string>& values);
+
   void
   sysfs_get_sensor(const std::string& subdev, const std::string& entry, uint32_t& i)
   {
@@ -159,7 +171,11 @@ public:
 
 private:
   int map_usr_bar(void);
+  void sysfs_read_nolock(const std::string& subdev, const std::string& entry,
+                         std::string& err, std::string& s);
   std::mutex lock;
+  std::mutex sysfs_lock;
+  std::map<std::string, int> sysfs_fds; // open sysfs entries by subdev/entry
   char *user_bar_map = reinterpret_cast<char *>(MAP_FAILED);
   bool mgmt = false;
 };
@@ -0,0 +1,204 @@
+/**
+ * Copyright (C) 2021 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing of persistent sysfs fds in core/pcie/linux/scan.cpp
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "scan.h"
+
+#include <boost/filesystem.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+BOOST_AUTO_TEST_SUITE ( test_sysfs_fd )
+
+namespace {
+
+namespace bfs = boost::filesystem;
+
+void
+write_file(const bfs::path& path, const std::string& value)
+{
+  std::ofstream ofs(path.string());
+  ofs << value << "\n";
+}
+
+// Synthetic sysfs tree with one ready xocl user card and persistent
+// sysfs fds enabled.  Must be in place before the first config access.
+struct sysfs_tree
+{
+  bfs::path root;
+  bfs::path xmc;
+
+  sysfs_tree()
+    : root(bfs::temp_directory_path() / bfs::unique_path("xrt_sysfs_%%%%%%%%"))
+  {
+    const std::string name = "0000:01:00.1";
+    auto dev = root / "bus/pci/devices" / name;
+    auto driver = root / "bus/pci/drivers/xocl";
+    bfs::create_directories(driver);
+    bfs::create_directories(dev / "drm/renderD128");
+    write_file(dev / "vendor", "0x10ee");
+    write_file(dev / "device", "0x5001");
+    write_file(dev / "ready", "0x1");
+    write_file(dev / "userbar", "0");
+    xmc = dev / "xmc.0";
+    bfs::create_directories(xmc);
+    write_file(xmc / "xmc_power", "1000");
+    write_file(xmc / "xmc_fan_rpm", "2000");
+    bfs::create_directory_symlink(dev, driver / name);
+
+    auto ini = root / "xrt.ini";
+    {
+      std::ofstream ofs(ini.string());
+      ofs << "[Runtime]\n"
+          << "sysfs_root=" << root.string() << "\n"
+          << "sysfs_persistent_fd=true\n";
+    }
+    setenv("XRT_INI_PATH", ini.c_str(), 1);
+  }
+
+  ~sysfs_tree()
+  {
+    bfs::remove_all(root);
+  }
+};
+
+sysfs_tree&
+get_tree()
+{
+  static sysfs_tree tree;
+  return tree;
+}
+
+std::shared_ptr<pcidev::pci_device>
+get_card()
+{
+  get_tree();
+  BOOST_REQUIRE_EQUAL(pcidev::get_dev_ready(true), 1);
+  return pcidev::get_dev(0, true);
+}
+
+// Find the fd this process has open on path
+int
+find_fd(const bfs::path& path)
+{
+  for (auto& entry : bfs::directory_iterator("/proc/self/fd")) {
+    boost::system::error_code ec;
+    auto target = bfs::read_symlink(entry.path(), ec);
+    if (!ec && target == path)
+      return std::stoi(entry.path().filename().string());
+  }
+  return -1;
+}
+
+// Make the cached fd of path fail reads, as a fd of a sysfs entry does
+// once its subdevice is reloaded
+void
+make_stale(const bfs::path& path)
+{
+  auto fd = find_fd(path);
+  BOOST_REQUIRE(fd >= 0);
+  auto dirfd = ::open(path.parent_path().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  BOOST_REQUIRE(dirfd >= 0);
+  BOOST_REQUIRE_EQUAL(::dup2(dirfd, fd), fd);
+  ::close(dirfd);
+}
+
+}
+
+BOOST_AUTO_TEST_CASE( test_cached_fd )
+{
+  auto dev = get_card();
+  std::string err;
+  std::vector<std::string> lines;
+
+  dev->sysfs_get("xmc", "xmc_power", err, lines);
+  BOOST_CHECK_EQUAL(err, "");
+  BOOST_REQUIRE_EQUAL(lines.size(), 1);
+  BOOST_CHECK_EQUAL(lines[0], "1000");
+  BOOST_CHECK(find_fd(get_tree().xmc / "xmc_power") >= 0);
+
+  // Rewriting in place is seen through the cached fd
+  {
+    std::ofstream ofs((get_tree().xmc / "xmc_power").string(), std::ios::in | std::ios::out);
+    ofs << "1001";
+  }
+  dev->sysfs_get("xmc", "xmc_power", err, lines);
+  BOOST_CHECK_EQUAL(err, "");
+  BOOST_REQUIRE_EQUAL(lines.size(), 1);
+  BOOST_CHECK_EQUAL(lines[0], "1001");
+}
+
+BOOST_AUTO_TEST_CASE( test_stale_fd_reopened )
+{
+  auto dev = get_card();
+  auto path = get_tree().xmc / "xmc_fan_rpm";
+  std::string err;
+  std::vector<std::string> lines;
+
+  dev->sysfs_get("xmc", "xmc_fan_rpm", err, lines);
+  BOOST_CHECK_EQUAL(err, "");
+
+  // Subdevice reloaded, the entry is a new file behind a stale fd
+  make_stale(path);
+  bfs::remove(path);
+  write_file(path, "2500");
+
+  dev->sysfs_get("xmc", "xmc_fan_rpm", err, lines);
+  BOOST_CHECK_EQUAL(err, "");
+  BOOST_REQUIRE_EQUAL(lines.size(), 1);
+  BOOST_CHECK_EQUAL(lines[0], "2500");
+
+  // Same through the batch reader, which shares the stale fd handling
+  make_stale(path);
+  std::vector<std::string> values;
+  dev->sysfs_get_batch({{"xmc", "xmc_fan_rpm"}, {"xmc", "xmc_power"}}, err, values);
+  BOOST_CHECK_EQUAL(err, "");
+  BOOST_REQUIRE_EQUAL(values.size(), 2);
+  BOOST_CHECK_EQUAL(values[0], "2500");
+}
+
+BOOST_AUTO_TEST_CASE( test_stale_fd_removed_entry )
+{
+  auto dev = get_card();
+  auto path = get_tree().xmc / "xmc_fan_rpm";
+  std::string err;
+  std::vector<std::string> lines;
+
+  dev->sysfs_get("xmc", "xmc_fan_rpm", err, lines);
+  BOOST_CHECK_EQUAL(err, "");
+
+  // Entry gone for good, the reopen fails and the error is reported
+  make_stale(path);
+  bfs::remove(path);
+  dev->sysfs_get("xmc", "xmc_fan_rpm", err, lines);
+  BOOST_CHECK(!err.empty());
+
+  write_file(path, "3000");
+  dev->sysfs_get("xmc", "xmc_fan_rpm", err, lines);
+  BOOST_CHECK_EQUAL(err, "");
+  BOOST_REQUIRE_EQUAL(lines.size(), 1);
+  BOOST_CHECK_EQUAL(lines[0], "3000");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
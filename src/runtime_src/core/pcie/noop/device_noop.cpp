@@ -31,4 +31,13 @@ device(handle_type device_handle, id_type device_id, bool user)
 {
 }
 
+void
+device::
+exec_buf_batch(const xclBufferHandle* bos, size_t count)
+{
+  if (auto ret = userpf::exec_buf_batch(get_device_handle(), bos, count))
+    // The noop shim launches all or none of the batch
+    throw system_error(ret, "failed to launch execution buffers");
+}
+
 }} // noop,xrt_core
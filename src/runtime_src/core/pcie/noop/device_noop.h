@@ -29,6 +29,9 @@ class device : public shim<device_pcie>
 public:
   device(handle_type device_handle, id_type device_id, bool user);
 
+  virtual void
+  exec_buf_batch(const xclBufferHandle* bos, size_t count);
+
 private:
   // Private look up function for concrete query::request
   virtual const query::request&
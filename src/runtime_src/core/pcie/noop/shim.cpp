@@ -24,10 +24,13 @@
 #include "core/common/task.h"
 #include "core/common/thread.h"
 
+#include <chrono>
 #include <cstdio>
 #include <mutex>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace { // private implementation details
 
@@ -152,13 +155,31 @@ wait()
   --completion_count;
 }
 
+// A batch of commands submitted together completes together and
+// counts as one completion, e.g. one exec_wait covers all commands
+// in the batch.
+struct batch_type
+{
+  std::vector<xclBufferHandle> handles;
+  unsigned long queue_time;
+  batch_type(const xclBufferHandle* bos, size_t count)
+    : handles(bos, bos + count), queue_time(xrt_core::time_ns())
+  {}
+};
+
 static void
-mark_cmd_handle_complete(xclBufferHandle handle)
+set_cmd_handle_complete(xclBufferHandle handle)
 {
   //XRT_PRINTF("handle(%d) is complete\n", handle);
   auto hbuf = buffer::map(handle);
   auto cmd = reinterpret_cast<ert_packet*>(hbuf);
   cmd->state = ERT_CMD_STATE_COMPLETED;
+}
+
+static void
+mark_cmd_handle_complete(xclBufferHandle handle)
+{
+  set_cmd_handle_complete(handle);
   ++completion_count;
 }
 
@@ -169,6 +190,15 @@ mark_cmd_complete(cmd_type ct)
   mark_cmd_handle_complete(ct.handle);
 }
 
+static void
+mark_batch_complete(batch_type bt)
+{
+  while (xrt_core::time_ns() - bt.queue_time < completion_delay_us * 1000);
+  for (auto handle : bt.handles)
+    set_cmd_handle_complete(handle);
+  ++completion_count;
+}
+
 static void
 add(xclBufferHandle handle)
 {
@@ -178,6 +208,18 @@ add(xclBufferHandle handle)
     mark_cmd_handle_complete(handle);
 }
 
+static void
+add(const xclBufferHandle* bos, size_t count)
+{
+  if (!count)
+    return;
+
+  if (completion_delay_us)
+    xrt_core::task::createF(running_queue, mark_batch_complete, batch_type(bos, count));
+  else
+    mark_batch_complete(batch_type(bos, count));
+}
+
 struct X
 {
   X() { init(); }
@@ -235,9 +277,12 @@ struct shim
     buffer::free(handle);
   }
 
+  // Simulate DMA by blocking the calling thread
   int
   sync_bo(buffer_handle_type, xclBOSyncDirection, size_t, size_t)
   {
+    if (auto delay_us = xrt_core::config::get_noop_dma_delay_us())
+      std::this_thread::sleep_for(std::chrono::microseconds(delay_us));
     return 0;
   }
 
@@ -260,6 +305,13 @@ struct shim
     return 0;
   }
 
+  int
+  exec_buf(const buffer_handle_type* bos, size_t count)
+  {
+    cmd::add(bos, count);
+    return 0;
+  }
+
   int
   exec_wait(int msec)
   {
@@ -683,3 +735,19 @@ xclInternalResetDevice(xclDeviceHandle handle, xclResetKind kind)
 {
   return 1; // -ENOSYS;
 }
+
+////////////////////////////////////////////////////////////////
+// Noop specific extensions used by xrt_core::noop::device
+////////////////////////////////////////////////////////////////
+namespace userpf {
+
+int
+exec_buf_batch(xclDeviceHandle handle, const xclBufferHandle* bos, size_t count)
+{
+  xrt_core::message::
+    send(xrt_core::message::severity_level::debug, "XRT", "exec_buf_batch()");
+  auto shim = get_shim_object(handle);
+  return shim->exec_buf(bos, count);
+}
+
+} // userpf
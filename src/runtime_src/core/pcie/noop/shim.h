@@ -22,6 +22,12 @@
 
 namespace userpf {
 
+// exec_buf_batch() - Submit multiple command buffers in one call
+//
+// All commands in the batch are marked complete together and
+// account for one completion as seen by xclExecWait.
+int
+exec_buf_batch(xclDeviceHandle handle, const xclBufferHandle* bos, size_t count);
 
 } // userpf
 
@@ -30,9 +30,14 @@ namespace XBU = XBUtilities;
 namespace po = boost::program_options;
 
 // System - Include Files
+#include <atomic>
+#include <chrono>
+#include <exception>
 #include <iostream>
+#include <iterator>
 #include <algorithm>
 #include <numeric>
+#include <thread>
 
 // ------ N A M E S P A C E ---------------------------------------------------
 using namespace XBUtilities;
@@ -615,6 +620,106 @@ XBUtilities::collect_and_validate_reports( const ReportCollection &allReportsAva
 }
 
 
+// One report to generate, for one device or for the system
+struct report_job {
+  const Report * report;
+  const xrt_core::device * device;
+  boost::any output;
+  std::exception_ptr error;
+  std::chrono::microseconds elapsed;
+};
+
+// Generate the reports of one device, or the system reports, in order.
+// Reports are not thread safe with respect to each other on the same
+// device, e.g. the CU report updates the scheduler status.
+static void
+run_report_group( std::vector<report_job>::iterator _begin,
+                  std::vector<report_job>::iterator _end,
+                  Report::SchemaVersion _schemaVersion,
+                  const std::vector<std::string> & _elementFilter)
+{
+  for (auto job = _begin; job != _end; ++job) {
+    auto start = std::chrono::steady_clock::now();
+    try {
+      job->output = job->report->getFormattedReport(job->device, _schemaVersion, _elementFilter);
+    } catch (...) {
+      job->error = std::current_exception();
+    }
+    job->elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+  }
+}
+
+// Generate the reports, fanning out across devices only.  The system
+// reports run first, then one job per device runs that device's
+// reports in order on a pool of threads.  Each report records its
+// output or exception so that results can be merged in job order.
+static void
+run_report_jobs( std::vector<report_job> & _jobs,
+                 Report::SchemaVersion _schemaVersion,
+                 const std::vector<std::string> & _elementFilter)
+{
+  // Group consecutive jobs by device
+  std::vector<std::vector<report_job>::iterator> groups;
+  for (auto job = _jobs.begin(); job != _jobs.end(); ++job) {
+    if (job == _jobs.begin() || job->device != std::prev(job)->device)
+      groups.push_back(job);
+  }
+  groups.push_back(_jobs.end());
+
+  size_t group = 0;
+  if (!_jobs.empty() && _jobs.front().device == nullptr) {
+    run_report_group(groups[0], groups[1], _schemaVersion, _elementFilter);
+    ++group;
+  }
+
+  std::atomic<size_t> next(group);
+  size_t numGroups = groups.size() - 1;
+  auto worker = [&]() {
+    for (size_t idx = next++; idx < numGroups; idx = next++)
+      run_report_group(groups[idx], groups[idx + 1], _schemaVersion, _elementFilter);
+  };
+
+  size_t numThreads = std::min<size_t>(std::max<size_t>(std::thread::hardware_concurrency(), 1), numGroups - group);
+  std::vector<std::thread> threads;
+  for (size_t idx = 1; idx < numThreads; ++idx)
+    threads.emplace_back(worker);
+  worker();
+  for (auto & thread : threads)
+    thread.join();
+}
+
+// Write the output of a report job to the stream or property tree
+static void
+merge_report_job( const report_job & _job,
+                  Report::SchemaVersion _schemaVersion,
+                  std::ostream & _ostream,
+                  boost::property_tree::ptree & _pt)
+{
+  if (_job.error)
+    std::rethrow_exception(_job.error);
+
+  const boost::any & output = _job.output;
+
+  // Simple string output
+  if (output.type() == typeid(std::string)) 
+    _ostream << boost::any_cast<std::string>(output);
+
+  if (output.type() == typeid(boost::property_tree::ptree)) {
+    const boost::property_tree::ptree & ptReport = boost::any_cast<const boost::property_tree::ptree &>(output);
+
+    // Only support 1 node on the root
+    if (ptReport.size() > 1)
+      throw xrt_core::error((boost::format("Invalid JSON - The report '%s' has too many root nodes.") % Report::getSchemaDescription(_schemaVersion).optionName).str());
+
+    // We have 1 node, copy the child to the root property tree
+    if (ptReport.size() == 1) {
+      for (const auto & ptChild : ptReport) {
+        _pt.add_child(ptChild.first, ptChild.second);
+      }
+    }
+  }
+}
+
 void 
 XBUtilities::produce_reports( xrt_core::device_collection _devices, 
                               const ReportCollection & _reportsToProcess, 
@@ -645,37 +750,6 @@ XBUtilities::produce_reports( xrt_core::device_collection _devices,
     ptRoot.add_child("schema_version", ptSchemaVersion);
   }
 
-
-  // -- Process the reports that don't require a device
-  boost::property_tree::ptree ptSystem;
-  for (const auto & report : _reportsToProcess) {
-    if (report->isDeviceRequired() == true)
-      continue;
-
-    boost::any output = report->getFormattedReport(nullptr, _schemaVersion, _elementFilter);
-
-    // Simple string output
-    if (output.type() == typeid(std::string)) 
-      _ostream << boost::any_cast<std::string>(output);
-
-    if (output.type() == typeid(boost::property_tree::ptree)) {
-      boost::property_tree::ptree ptReport = boost::any_cast< boost::property_tree::ptree>(output);
-
-      // Only support 1 node on the root
-      if (ptReport.size() > 1)
-        throw xrt_core::error((boost::format("Invalid JSON - The report '%s' has too many root nodes.") % Report::getSchemaDescription(_schemaVersion).optionName).str());
-
-      // We have 1 node, copy the child to the root property tree
-      if (ptReport.size() == 1) {
-        for (const auto & ptChild : ptReport) {
-          ptSystem.add_child(ptChild.first, ptChild.second);
-        }
-      }
-    }
-  }
-  if (!ptSystem.empty()) 
-    ptRoot.add_child("system", ptSystem);
-
   // -- Check if any device sepcific report is requested
   auto dev_report = [_reportsToProcess]() {
     for (auto &report : _reportsToProcess) {
@@ -685,6 +759,33 @@ XBUtilities::produce_reports( xrt_core::device_collection _devices,
     return false;
   };
 
+  // -- Generate all reports up front, fanning out across devices.  The
+  //    system reports come first followed by the device reports in
+  //    device order, which is also the merge order.
+  std::vector<report_job> jobs;
+  for (const auto & report : _reportsToProcess) {
+    if (report->isDeviceRequired() == false)
+      jobs.push_back({report.get(), nullptr, {}, nullptr, {}});
+  }
+  if (dev_report()) {
+    for (const auto & device : _devices) {
+      for (const auto & report : _reportsToProcess) {
+        if (report->isDeviceRequired() == true)
+          jobs.push_back({report.get(), device.get(), {}, nullptr, {}});
+      }
+    }
+  }
+  run_report_jobs(jobs, _schemaVersion, _elementFilter);
+  auto job = jobs.cbegin();
+
+  // -- Process the reports that don't require a device
+  boost::property_tree::ptree ptSystem;
+  for (; job != jobs.cend() && job->device == nullptr; ++job)
+    merge_report_job(*job, _schemaVersion, _ostream, ptSystem);
+
+  if (!ptSystem.empty()) 
+    ptRoot.add_child("system", ptSystem);
+
   if(dev_report()) {
     // -- Process reports that work on a device
     boost::property_tree::ptree ptDevices;
@@ -717,31 +818,9 @@ XBUtilities::produce_reports( xrt_core::device_collection _devices,
         _ostream << dev_desc;
         _ostream << std::string(dev_desc.length(), '-') << std::endl;
       }
-      for (auto &report : _reportsToProcess) {
-        if (report->isDeviceRequired() == false)
-          continue;
-
-        boost::any output = report->getFormattedReport(device.get(), _schemaVersion, _elementFilter);
-
-        // Simple string output
-        if (output.type() == typeid(std::string)) 
-          _ostream << boost::any_cast<std::string>(output);
+      for (; job != jobs.cend() && job->device == device.get(); ++job)
+        merge_report_job(*job, _schemaVersion, _ostream, ptDevice);
 
-        if (output.type() == typeid(boost::property_tree::ptree)) {
-          boost::property_tree::ptree ptReport = boost::any_cast< boost::property_tree::ptree>(output);
-
-          // Only support 1 node on the root
-          if (ptReport.size() > 1)
-            throw xrt_core::error((boost::format("Invalid JSON - The report '%s' has too many root nodes.") % Report::getSchemaDescription(_schemaVersion).optionName).str());
-
-          // We have 1 node, copy the child to the root property tree
-          if (ptReport.size() == 1) {
-            for (const auto & ptChild : ptReport) {
-              ptDevice.add_child(ptChild.first, ptChild.second);
-            }
-          }
-        }
-      }
       if (!ptDevice.empty()) 
         ptDevices.push_back(std::make_pair("", ptDevice));   // Used to make an array of objects
     }
@@ -749,7 +828,6 @@ XBUtilities::produce_reports( xrt_core::device_collection _devices,
       ptRoot.add_child("devices", ptDevices);
   }
 
-
   // Did we add anything to the property tree.  If so, then write it out.
   if ((_schemaVersion != Report::SchemaVersion::text) &&
       (_schemaVersion != Report::SchemaVersion::unknown)) {
@@ -758,5 +836,15 @@ XBUtilities::produce_reports( xrt_core::device_collection _devices,
     boost::property_tree::write_json(outputBuffer, ptRoot, true /*Pretty print*/);
     _ostream << outputBuffer.str() << std::endl;
   }
+
+  // -- Report generation time, to help find slow queries
+  for (const auto & timedJob : jobs) {
+    if (!XBU::getVerbose())
+      break;
+    std::string deviceId = "system";
+    if (timedJob.device != nullptr)
+      deviceId = xrt_core::query::pcie_bdf::to_string(xrt_core::device_query<xrt_core::query::pcie_bdf>(timedJob.device));
+    XBU::verbose((boost::format("Report '%s' for %s generated in %.3f ms") % timedJob.report->getReportName() % deviceId % (timedJob.elapsed.count() / 1000.0)).str());
+  }
 }
 
@@ -22,12 +22,148 @@
 
 #include "core/common/time.h"
 
+#include <algorithm>
 #include <iostream>
 
 namespace xdp {
-  
+
+  // Append only list of events with a single producer and a single
+  //  consumer.  Events are stored in fixed size chunks, the producer
+  //  publishes each event by bumping the produced count and the
+  //  consumer frees a chunk once it has read past its end.
+  class EventLog
+  {
+  private:
+    struct Chunk
+    {
+      static constexpr size_t capacity = 1024 ;
+      VTFEvent* events[capacity] ;
+      std::atomic<Chunk*> next{nullptr} ;
+    } ;
+
+    // Producer side
+    Chunk* tail ;
+    size_t tailIdx = 0 ;
+    std::atomic<uint64_t> produced{0} ;
+
+    // Consumer side
+    Chunk* head ;
+    size_t headIdx = 0 ;
+    std::atomic<uint64_t> consumed{0} ;
+
+  public:
+    EventLog() : tail(new Chunk), head(tail) {}
+
+    ~EventLog()
+    {
+      while (head) {
+        auto next = head->next.load(std::memory_order_relaxed) ;
+        delete head ;
+        head = next ;
+      }
+    }
+
+    EventLog(const EventLog&) = delete ;
+    EventLog& operator=(const EventLog&) = delete ;
+
+    void push(VTFEvent* event)
+    {
+      if (tailIdx == Chunk::capacity) {
+        auto chunk = new Chunk ;
+        tail->next.store(chunk, std::memory_order_release) ;
+        tail = chunk ;
+        tailIdx = 0 ;
+      }
+      tail->events[tailIdx++] = event ;
+      produced.store(produced.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_release) ;
+    }
+
+    template <typename Function>
+    void drain(Function&& fcn)
+    {
+      auto count = produced.load(std::memory_order_acquire) ;
+      auto idx = consumed.load(std::memory_order_relaxed) ;
+      for ( ; idx < count ; ++idx) {
+        if (headIdx == Chunk::capacity) {
+          auto next = head->next.load(std::memory_order_acquire) ;
+          delete head ;
+          head = next ;
+          headIdx = 0 ;
+        }
+        fcn(head->events[headIdx++]) ;
+      }
+      consumed.store(idx, std::memory_order_relaxed) ;
+    }
+
+    bool empty() const
+    {
+      return consumed.load(std::memory_order_relaxed) ==
+        produced.load(std::memory_order_acquire) ;
+    }
+  } ;
+
+  // Host events logged by one thread
+  class ThreadEventBuffer
+  {
+  public:
+    EventLog hostEvents ;
+    EventLog unsortedEvents ;
+
+    // Set when the thread exits, the buffer is dropped once drained
+    std::atomic<bool> retired{false} ;
+  } ;
+
+  namespace {
+
+    // Each database gets a distinct id so a thread never logs into
+    //  the buffer of a database that has been replaced
+    std::atomic<uint64_t> nextInstanceId{1} ;
+
+    struct ThreadBufferHandle
+    {
+      uint64_t owner = 0 ;
+      std::shared_ptr<ThreadEventBuffer> buffer ;
+
+      ~ThreadBufferHandle()
+      {
+        if (buffer)
+          buffer->retired.store(true, std::memory_order_release) ;
+        // Events logged from later static destructors get a new buffer
+        owner = 0 ;
+        buffer.reset() ;
+      }
+    } ;
+
+    thread_local ThreadBufferHandle threadBuffer ;
+
+    // Direct mapped cache from static string pointers to string ids.
+    //  Trivially destructible so access needs no thread_local guard.
+    struct StaticStringCache
+    {
+      static constexpr unsigned int bits = 8 ;
+      struct Entry
+      {
+        const char* key ;
+        uint64_t id ;
+      } ;
+
+      uint64_t owner ;
+      Entry entries[1 << bits] ;
+
+      static size_t index(const char* key)
+      {
+        auto hash = reinterpret_cast<uintptr_t>(key) * 0x9E3779B97F4A7C15ULL ;
+        return static_cast<size_t>(static_cast<uint64_t>(hash) >> (64 - bits)) ;
+      }
+    } ;
+
+    thread_local StaticStringCache staticStringCache ;
+
+  } // end anonymous namespace
+
   VPDynamicDatabase::VPDynamicDatabase(VPDatabase* d) :
-    db(d), eventId(1), stringId(1)
+    db(d), instanceId(nextInstanceId++), eventId(1), stringId(1)
   {
     // For low overhead profiling, we will reserve space for 
     //  a set number of events.  This won't change HAL or OpenCL 
@@ -50,11 +186,20 @@ namespace xdp {
 
     {
       std::lock_guard<std::mutex> lock(hostEventsLock) ;
+      collectHostEvents() ;
       for (auto event : hostEvents) {
       delete event.second;
       }
     }
 
+    {
+      std::lock_guard<std::mutex> lock(unsortedEventsLock) ;
+      collectUnsortedEvents() ;
+      for (auto event : unsortedHostEvents) {
+        delete event ;
+      }
+    }
+
     {
       std::lock_guard<std::mutex> lock(deviceEventsLock) ;
       for (auto device : deviceEvents) {
@@ -71,21 +216,73 @@ namespace xdp {
     addDeviceEvent(deviceId, new XclbinEnd(0, (double)(xrt_core::time_ns())/1e6, 0, 0)) ;
   }
 
-  void VPDynamicDatabase::addHostEvent(VTFEvent* event)
+  ThreadEventBuffer* VPDynamicDatabase::getThreadBuffer()
   {
-    std::lock_guard<std::mutex> lock(hostEventsLock) ;
+    if (threadBuffer.owner == instanceId)
+      return threadBuffer.buffer.get() ;
+
+    // First event from this thread
+    auto buffer = std::make_shared<ThreadEventBuffer>() ;
+    {
+      std::lock_guard<std::mutex> lock(threadBuffersLock) ;
+      threadBuffers.push_back(buffer) ;
+    }
+    if (threadBuffer.buffer)
+      threadBuffer.buffer->retired.store(true, std::memory_order_release) ;
+    threadBuffer.owner = instanceId ;
+    threadBuffer.buffer = buffer ;
+    return buffer.get() ;
+  }
+
+  std::vector<std::shared_ptr<ThreadEventBuffer>>
+  VPDynamicDatabase::getThreadBuffers()
+  {
+    std::lock_guard<std::mutex> lock(threadBuffersLock) ;
 
+    // Drop buffers of exited threads that have nothing left to collect.
+    //  Check retired first so no event is pushed after empty() is seen.
+    auto drained = [](const std::shared_ptr<ThreadEventBuffer>& buffer)
+      {
+        return buffer->retired.load(std::memory_order_acquire) &&
+               buffer->hostEvents.empty() && buffer->unsortedEvents.empty() ;
+      } ;
+    threadBuffers.erase(std::remove_if(threadBuffers.begin(),
+                                       threadBuffers.end(), drained),
+                        threadBuffers.end()) ;
+    return threadBuffers ;
+  }
+
+  void VPDynamicDatabase::collectHostEvents()
+  {
+    std::vector<VTFEvent*> collected ;
+    for (auto& buffer : getThreadBuffers())
+      buffer->hostEvents.drain([&collected](VTFEvent* e)
+                               { collected.push_back(e) ; }) ;
+
+    // Events from each thread are already close to timestamp order, so
+    //  after sorting most of them are inserted at the end of the multimap
+    std::stable_sort(collected.begin(), collected.end(), VTFEventSorter()) ;
+    for (auto e : collected)
+      hostEvents.emplace_hint(hostEvents.end(), e->getTimestamp(), e) ;
+  }
+
+  void VPDynamicDatabase::collectUnsortedEvents()
+  {
+    for (auto& buffer : getThreadBuffers())
+      buffer->unsortedEvents.drain([this](VTFEvent* e)
+                                   { unsortedHostEvents.push_back(e) ; }) ;
+  }
+
+  void VPDynamicDatabase::addHostEvent(VTFEvent* event)
+  {
     event->setEventId(eventId++) ;
-    hostEvents.emplace(event->getTimestamp(), event) ;
-    //hostEvents.push_back(event) ;
+    getThreadBuffer()->hostEvents.push(event) ;
   }
 
   void VPDynamicDatabase::addUnsortedEvent(VTFEvent* event)
   {
-    std::lock_guard<std::mutex> lock(unsortedEventsLock) ;
     event->setEventId(eventId++) ;
-
-    unsortedHostEvents.push_back(event) ;
+    getThreadBuffer()->unsortedEvents.push(event) ;
   }
 
   void VPDynamicDatabase::addDeviceEvent(uint64_t deviceId, VTFEvent* event)
@@ -212,11 +409,32 @@ namespace xdp {
 
   uint64_t VPDynamicDatabase::addString(const std::string& value)
   {
-    if (stringTable.find(value) == stringTable.end())
+    std::lock_guard<std::mutex> lock(stringLock) ;
+    auto entry = stringTable.find(value) ;
+    if (entry == stringTable.end())
     {
-      stringTable[value] = stringId++ ;
+      entry = stringTable.emplace(value, stringId++).first ;
     }
-    return stringTable[value] ;
+    return entry->second ;
+  }
+
+  uint64_t VPDynamicDatabase::addStaticString(const char* value)
+  {
+    auto& cache = staticStringCache ;
+    if (cache.owner != instanceId) {
+      std::fill(std::begin(cache.entries), std::end(cache.entries),
+                StaticStringCache::Entry{nullptr, 0}) ;
+      cache.owner = instanceId ;
+    }
+
+    // String ids never change, so a cached id stays valid for the
+    //  lifetime of the database
+    auto& entry = cache.entries[StaticStringCache::index(value)] ;
+    if (entry.key != value) {
+      entry.id = addString(value) ;
+      entry.key = value ;
+    }
+    return entry.id ;
   }
 
   // This needs to be sped up significantly.
@@ -227,6 +445,7 @@ namespace xdp {
     // For now, go through both host events and device events.
     {
       std::lock_guard<std::mutex> lock(hostEventsLock) ;
+      collectHostEvents() ;
       for (auto e : hostEvents) {
         if (filter(e.second)) collected.push_back(e.second) ;
       }
@@ -247,6 +466,7 @@ namespace xdp {
   std::vector<VTFEvent*> VPDynamicDatabase::filterHostEvents(std::function<bool(VTFEvent*)> filter)
   {
     std::lock_guard<std::mutex> lock(hostEventsLock) ;
+    collectHostEvents() ;
     std::vector<VTFEvent*> collected ;
 
     for (auto e : hostEvents)
@@ -259,6 +479,7 @@ namespace xdp {
   std::vector<std::unique_ptr<VTFEvent>> VPDynamicDatabase::filterEraseHostEvents(std::function<bool(VTFEvent*)> filter)
   {
     std::lock_guard<std::mutex> lock(hostEventsLock) ;
+    collectHostEvents() ;
     std::vector<std::unique_ptr<VTFEvent>> collected ;
 
     for (auto it=hostEvents.begin(); it!=hostEvents.end();) {
@@ -277,22 +498,25 @@ namespace xdp {
   filterEraseUnsortedHostEvents(std::function<bool(VTFEvent*)> filter)
   {
     std::lock_guard<std::mutex> lock(unsortedEventsLock);
+    collectUnsortedEvents() ;
     std::vector<VTFEvent*> collected ;
 
-    for (auto it=unsortedHostEvents.begin(); it!=unsortedHostEvents.end();){
-      if (filter(*it)) {
-        collected.emplace_back(*it);
-        it = unsortedHostEvents.erase(it);
-      } else {
-        ++it ;
-      }
+    // Compact the kept events in place instead of erasing one by one
+    auto kept = unsortedHostEvents.begin() ;
+    for (auto e : unsortedHostEvents) {
+      if (filter(e))
+        collected.emplace_back(e) ;
+      else
+        *kept++ = e ;
     }
+    unsortedHostEvents.erase(kept, unsortedHostEvents.end()) ;
     return collected ;
   }
 
   std::vector<VTFEvent*> VPDynamicDatabase::getHostEvents()
   {
     std::lock_guard<std::mutex> lock(hostEventsLock) ;
+    collectHostEvents() ;
     std::vector<VTFEvent*> events;
     for(auto e : hostEvents) {
       events.push_back(e.second);
@@ -303,6 +527,7 @@ namespace xdp {
   bool VPDynamicDatabase::hostEventsExist(std::function<bool(VTFEvent*)> filter)
   {
     std::lock_guard<std::mutex> lock(hostEventsLock) ;
+    collectHostEvents() ;
     for (auto it=hostEvents.begin(); it!=hostEvents.end(); it++) {
       if (filter(it->second))
         return true;
@@ -345,6 +570,7 @@ namespace xdp {
 
   void VPDynamicDatabase::dumpStringTable(std::ofstream& fout)
   {
+    std::lock_guard<std::mutex> lock(stringLock) ;
     // Windows compilation fails unless c_str() is used
     for (auto s : stringTable)
     {
@@ -37,6 +37,7 @@ namespace xdp {
 
   // Forward declarations
   class VPDatabase ;
+  class ThreadEventBuffer ;
 
   // AIE Trace data type
 #if 0
@@ -66,6 +67,12 @@ namespace xdp {
     typedef std::map<double, std::string> CounterNames ;
 
   private:
+    // Host events are first appended to a buffer owned by the thread
+    //  that logs them, without taking any lock.  They are moved to the
+    //  containers below only when a writer asks for host events.
+    std::vector<std::shared_ptr<ThreadEventBuffer>> threadBuffers ;
+    uint64_t instanceId ;
+
     // For sorted host events, we need a multimap because multithreaded
     //  applications can create unsorted events
     std::multimap<double, VTFEvent*> hostEvents ;
@@ -121,6 +128,7 @@ namespace xdp {
     //  instance of that string
     std::map<std::string, uint64_t> stringTable ;
     uint64_t stringId ;
+    std::mutex stringLock ;
 
     // Since events can be logged from multiple threads simultaneously,
     //  we have to maintain exclusivity
@@ -133,6 +141,7 @@ namespace xdp {
     std::mutex deviceEventsLock ;
     std::mutex hostEventsLock ;
     std::mutex unsortedEventsLock ;
+    std::mutex threadBuffersLock ;
 
     // Trace parser states and other metadata data structures
     std::mutex deviceLock ;
@@ -143,6 +152,14 @@ namespace xdp {
     void addHostEvent(VTFEvent* event) ;
     void addDeviceEvent(uint64_t deviceId, VTFEvent* event) ;
 
+    // Thread buffers
+    ThreadEventBuffer* getThreadBuffer() ;
+    std::vector<std::shared_ptr<ThreadEventBuffer>> getThreadBuffers() ;
+    // Move events from the thread buffers, called with the matching
+    //  hostEventsLock or unsortedEventsLock held
+    void collectHostEvents() ;
+    void collectUnsortedEvents() ;
+
   public:
     XDP_EXPORT VPDynamicDatabase(VPDatabase* d) ;
     XDP_EXPORT ~VPDynamicDatabase() ;
@@ -179,6 +196,11 @@ namespace xdp {
     // A lookup into the string table
     XDP_EXPORT uint64_t addString(const std::string& value) ;
 
+    // A lookup into the string table for strings with static storage
+    //  duration, such as API function names.  Repeated lookups of the
+    //  same pointer are answered from a per thread cache without locking.
+    XDP_EXPORT uint64_t addStaticString(const char* value) ;
+
     // A function that iterates on the dynamic events and returns
     //  events based upon the filter passed in
     XDP_EXPORT std::vector<VTFEvent*> filterEvents(std::function<bool(VTFEvent*)> filter);
@@ -0,0 +1,248 @@
+/**
+ * Copyright (C) 2021 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+////////////////////////////////////////////////////////////////
+// Unit testing of host event logging in VPDynamicDatabase
+////////////////////////////////////////////////////////////////
+#include <boost/test/unit_test.hpp>
+
+#include "xdp/profile/database/database.h"
+#include "xdp/profile/database/dynamic_event_database.h"
+#include "xdp/profile/database/events/native_events.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE ( test_dynamic_event_database )
+
+namespace {
+
+using xdp::VPDynamicDatabase;
+using xdp::VTFEvent;
+
+// Event i of thread t of n threads has timestamp i * n + t, so all
+// timestamps are distinct and identify the thread and the index
+VTFEvent*
+make_event(size_t thread, size_t idx, size_t threads)
+{
+  return new xdp::NativeAPICall(0, static_cast<double>(idx * threads + thread), 1);
+}
+
+// Collects host events from the database and checks that each event
+// is seen exactly once, and that the unsorted events of each thread
+// come in the order the thread logged them
+struct collector
+{
+  size_t threads;
+  size_t per_thread;
+  std::vector<bool> sorted_seen;
+  std::vector<bool> unsorted_seen;
+  std::vector<size_t> unsorted_next;
+  size_t sorted = 0;
+  size_t unsorted = 0;
+  bool ok = true;
+
+  collector(size_t t, size_t n)
+    : threads(t), per_thread(n)
+    , sorted_seen(t * n), unsorted_seen(t * n), unsorted_next(t)
+  {}
+
+  void
+  record(std::vector<bool>& seen, size_t ts)
+  {
+    if (ts >= seen.size() || seen[ts])
+      ok = false;
+    else
+      seen[ts] = true;
+  }
+
+  void
+  drain(VPDynamicDatabase& db)
+  {
+    for (auto e : db.filterEraseUnsortedHostEvents([](VTFEvent*) { return true; })) {
+      auto ts = static_cast<size_t>(e->getTimestamp());
+      record(unsorted_seen, ts);
+      auto& next = unsorted_next[ts % threads];
+      if (ts / threads != next)
+        ok = false;
+      next = ts / threads + 1;
+      ++unsorted;
+      delete e;
+    }
+
+    auto events = db.filterEraseHostEvents([](VTFEvent*) { return true; });
+    for (size_t idx = 0; idx < events.size(); ++idx) {
+      record(sorted_seen, static_cast<size_t>(events[idx]->getTimestamp()));
+      if (idx && events[idx - 1]->getTimestamp() > events[idx]->getTimestamp())
+        ok = false;
+      ++sorted;
+    }
+  }
+
+  bool
+  complete() const
+  {
+    return ok && sorted == threads * per_thread && unsorted == threads * per_thread;
+  }
+};
+
+void
+log_events(VPDynamicDatabase& db, size_t thread, size_t count, size_t threads)
+{
+  for (size_t idx = 0; idx < count; ++idx) {
+    db.addEvent(make_event(thread, idx, threads));
+    db.addUnsortedEvent(make_event(thread, idx, threads));
+  }
+}
+
+}
+
+BOOST_AUTO_TEST_CASE( test_single_thread )
+{
+  // More events than fit in one chunk of the thread log
+  const size_t count = 3000;
+  VPDynamicDatabase db(nullptr);
+  for (size_t idx = 0; idx < count; ++idx)
+    db.addEvent(make_event(0, count - 1 - idx, 1));
+
+  BOOST_CHECK(db.hostEventsExist([](VTFEvent*) { return true; }));
+  auto events = db.getHostEvents();
+  BOOST_CHECK_EQUAL(events.size(), count);
+  BOOST_CHECK(std::is_sorted(events.begin(), events.end(), xdp::VTFEventSorter()));
+
+  // Events are moved out of the thread log only once
+  BOOST_CHECK_EQUAL(db.getHostEvents().size(), count);
+
+  for (size_t idx = 0; idx < count; ++idx)
+    db.addUnsortedEvent(make_event(0, idx, 1));
+  collector c(1, count);
+  c.drain(db);
+  BOOST_CHECK(c.complete());
+  BOOST_CHECK(!db.hostEventsExist([](VTFEvent*) { return true; }));
+}
+
+BOOST_AUTO_TEST_CASE( test_concurrent_drain )
+{
+  // Producers log while the consumer drains, so chunks are handed
+  // over and freed while the producers keep appending
+  const size_t threads = 4;
+  const size_t count = 20000;
+  VPDynamicDatabase db(nullptr);
+  collector c(threads, count);
+
+  std::atomic<size_t> running{threads};
+  std::vector<std::thread> producers;
+  for (size_t t = 0; t < threads; ++t)
+    producers.emplace_back([&, t] {
+      log_events(db, t, count, threads);
+      --running;
+    });
+
+  while (running) {
+    c.drain(db);
+    std::this_thread::yield();
+  }
+  for (auto& th : producers)
+    th.join();
+  c.drain(db);
+
+  BOOST_CHECK(c.complete());
+}
+
+BOOST_AUTO_TEST_CASE( test_exited_threads )
+{
+  // Threads exit while the consumer drains, events logged just before
+  // a thread exits must not be lost when its buffer is dropped
+  const size_t threads = 200;
+  const size_t count = 10;
+  VPDynamicDatabase db(nullptr);
+  collector c(threads, count);
+
+  std::atomic<bool> done{false};
+  std::thread consumer([&] {
+    while (!done) {
+      c.drain(db);
+      std::this_thread::yield();
+    }
+  });
+
+  for (size_t t = 0; t < threads; t += 4) {
+    std::vector<std::thread> producers;
+    for (size_t k = t; k < t + 4; ++k)
+      producers.emplace_back(log_events, std::ref(db), k, count, threads);
+    for (auto& th : producers)
+      th.join();
+  }
+  done = true;
+  consumer.join();
+  c.drain(db);
+
+  BOOST_CHECK(c.complete());
+}
+
+BOOST_AUTO_TEST_CASE( test_retired_buffer_kept )
+{
+  // Nothing is drained until all threads have exited
+  const size_t threads = 8;
+  const size_t count = 1500;
+  VPDynamicDatabase db(nullptr);
+  for (size_t t = 0; t < threads; ++t)
+    std::thread(log_events, std::ref(db), t, count, threads).join();
+
+  collector c(threads, count);
+  c.drain(db);
+  BOOST_CHECK(c.complete());
+
+  // Buffers of exited threads are gone, new threads still log
+  collector c2(1, count);
+  std::thread(log_events, std::ref(db), 0, count, 1).join();
+  c2.drain(db);
+  BOOST_CHECK(c2.complete());
+}
+
+BOOST_AUTO_TEST_CASE( test_replaced_database )
+{
+  // A thread that logs into a new database retires its buffer in the
+  // old one, events must land in the database they were logged to
+  const size_t count = 100;
+  collector c1(1, 2 * count), c2(1, count);
+  {
+    VPDynamicDatabase db1(nullptr);
+    {
+      VPDynamicDatabase db2(nullptr);
+      log_events(db1, 0, count, 1);
+      log_events(db2, 0, count, 1);
+      for (size_t idx = count; idx < 2 * count; ++idx) {
+        db1.addEvent(make_event(0, idx, 1));
+        db1.addUnsortedEvent(make_event(0, idx, 1));
+      }
+      c2.drain(db2);
+      BOOST_CHECK(c2.complete());
+    }
+    c1.drain(db1);
+    BOOST_CHECK(c1.complete());
+  }
+
+  // Events never drained are freed by the database destructor, the
+  // address sanitizer reports a leak otherwise
+  VPDynamicDatabase db(nullptr);
+  std::thread(log_events, std::ref(db), 0, count, 1).join();
+  log_events(db, 0, count, 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,217 @@
+/**
+ * Copyright (C) 2021 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+// Throughput of PL trace clock training seek and decoding over
+// synthetic trace buffers.
+//
+// Compares the seek and decode that TraceS2MM::parseTraceBuf used to
+// have with the ones based on TraceDecoder, and checks that both give
+// the same results.
+//
+// Usage: trace_decoder_bench [MB] [garbage packets]
+
+#include "xdp/profile/device/trace_decoder.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using xdp::TraceDecoder;
+
+namespace {
+
+constexpr uint64_t tsmask = TraceDecoder::timestampMask;
+constexpr uint64_t clock_training_bit = 1ULL << 63;
+
+// Trace format 1: garbage, 8 clock training packets, then events with
+// a group of 4 clock training packets every 10000 packets.
+std::vector<uint64_t>
+make_trace(size_t count, size_t garbage)
+{
+  std::mt19937_64 rng(42);
+  std::vector<uint64_t> trace(count);
+  uint64_t ts = 1000;
+  for (size_t i = 0; i < count; ++i) {
+    ts += rng() % 64;
+    if (i < garbage) {
+      // Runs of at most 7 clock training packets
+      trace[i] = (ts & tsmask) | ((i % 8 != 7) ? clock_training_bit : 0);
+      continue;
+    }
+    auto j = i - garbage;
+    if (j < 8 || j % 10000 < 4) {
+      trace[i] = clock_training_bit | ((rng() & 0xFFFF) << 45) | (ts & tsmask);
+      continue;
+    }
+    uint64_t flags = (rng() % 2) ? (1ULL << (45 + rng() % 4)) : 0;
+    uint64_t id = (rng() % 512) << 49;
+    uint64_t pulse = (rng() % 100 == 0) ? (1ULL << 61) : 0;
+    trace[i] = pulse | id | flags | (ts & tsmask);
+  }
+  return trace;
+}
+
+// The seek and decode TraceS2MM used before TraceDecoder
+uint64_t
+ref_seek(const uint64_t* arr, uint64_t count)
+{
+  uint64_t n = 8;
+  if (count < n)
+    return count;
+
+  count -= n;
+  for (uint64_t i=0; i <= count; i++) {
+    for (uint64_t j=i; j < i + n; j++) {
+      if (!((arr[j] >> 63) & 0x1))
+        break;
+      if (j == i+n-1)
+        return i;
+    }
+  }
+  return count;
+}
+
+void
+ref_decode(const uint64_t* pos, uint64_t count, uint64_t first, std::vector<xclTraceResults>& out)
+{
+  out.clear();
+  for (uint64_t i = 0; i < count; i++) {
+    auto packet = pos[i];
+    if (!packet)
+      break;
+    if ((packet >> 63) & 0x1)
+      continue;
+    xclTraceResults result = {};
+    result.Timestamp = (packet & 0x1FFFFFFFFFFF) - first;
+    result.EventType = ((packet >> 45) & 0xF) ? XCL_PERF_MON_END_EVENT :
+        XCL_PERF_MON_START_EVENT;
+    result.TraceID = (packet >> 49) & 0xFFF;
+    result.Reserved = (packet >> 61) & 0x1;
+    result.Overflow = (packet >> 62) & 0x1;
+    result.EventID = XCL_PERF_MON_HW_EVENT;
+    result.EventFlags = ((packet >> 45) & 0xF) | ((packet >> 57) & 0x10);
+    out.push_back(result);
+  }
+}
+
+// TraceS2MM::parseTraceBuf with TraceDecoder
+void
+new_decode(const uint64_t* pos, uint64_t count, uint64_t first, std::vector<xclTraceResults>& out)
+{
+  out.clear();
+  for (uint64_t i = 0; i < count; i++) {
+    auto packet = pos[i];
+    if (!packet)
+      break;
+    if (TraceDecoder::isClockTraining(packet))
+      continue;
+    xclTraceResults result = {};
+    TraceDecoder::decode(packet, first, result);
+    out.push_back(result);
+  }
+}
+
+template <typename Function>
+double
+measure(Function&& fcn, int iterations)
+{
+  // Warm up, so allocation and page faults are not measured
+  fcn();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i)
+    fcn();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / iterations;
+}
+
+void
+report(const std::string& name, double seconds, size_t bytes)
+{
+  std::cout << "  " << name << ": " << seconds * 1e3 << " ms, "
+            << bytes / seconds / (1 << 20) << " MB/s\n";
+}
+
+bool
+same(const xclTraceResults& a, const xclTraceResults& b)
+{
+  return a.Timestamp == b.Timestamp && a.EventType == b.EventType
+    && a.TraceID == b.TraceID && a.Reserved == b.Reserved
+    && a.Overflow == b.Overflow && a.EventID == b.EventID
+    && a.EventFlags == b.EventFlags && a.isClockTrain == b.isClockTrain;
+}
+
+} // namespace
+
+int
+main(int argc, char* argv[])
+{
+  size_t mb = (argc > 1) ? std::strtoul(argv[1], nullptr, 0) : 256;
+  size_t garbage = (argc > 2) ? std::strtoul(argv[2], nullptr, 0) : 100000;
+  size_t count = mb * (1 << 20) / sizeof(uint64_t);
+  if (garbage + 16 > count) {
+    std::cerr << "Too many garbage packets\n";
+    return 1;
+  }
+
+  auto trace = make_trace(count, garbage);
+  auto bytes = count * sizeof(uint64_t);
+  std::cout << "Trace " << mb << " MB, " << count << " packets, "
+            << garbage << " garbage packets\n";
+
+  // Clock training seek
+  uint64_t ref_idx = 0;
+  size_t new_idx = 0;
+  auto t_ref_seek = measure([&] { ref_idx = ref_seek(trace.data(), count); }, 5);
+  auto t_new_seek = measure([&] { new_idx = TraceDecoder::findClockTraining(trace.data(), count); }, 5);
+  std::cout << "Clock training seek (found at " << new_idx << ")\n";
+  report("per packet", t_ref_seek, garbage * sizeof(uint64_t));
+  report("TraceDecoder", t_new_seek, garbage * sizeof(uint64_t));
+  if (ref_idx != new_idx) {
+    std::cerr << "Seek mismatch " << ref_idx << " != " << new_idx << "\n";
+    return 1;
+  }
+
+  auto pos = trace.data() + new_idx;
+  auto num = count - new_idx;
+  auto first = pos[0] & tsmask;
+  bytes = num * sizeof(uint64_t);
+
+  std::vector<xclTraceResults> ref_results;
+  std::vector<xclTraceResults> new_results;
+
+  std::cout << "Decode\n";
+  auto t_ref = measure([&] { ref_decode(pos, num, first, ref_results); }, 3);
+  report("per packet to xclTraceResults", t_ref, bytes);
+  auto t_new = measure([&] { new_decode(pos, num, first, new_results); }, 3);
+  report("TraceDecoder to xclTraceResults", t_new, bytes);
+
+  if (ref_results.size() != new_results.size()) {
+    std::cerr << "Result count mismatch " << ref_results.size() << " != " << new_results.size() << "\n";
+    return 1;
+  }
+  for (size_t i = 0; i < ref_results.size(); ++i) {
+    if (!same(ref_results[i], new_results[i])) {
+      std::cerr << "Result mismatch at " << i << "\n";
+      return 1;
+    }
+  }
+  std::cout << "Results match (" << new_results.size() << " events)\n";
+  return 0;
+}
@@ -174,16 +174,7 @@ void TraceS2MM::parsePacket(uint64_t packet, uint64_t firstTimestamp, xclTraceRe
     if(out_stream)
         (*out_stream) << " TraceS2MM::parsePacket " << std::endl;
 
-    result.Timestamp = (packet & 0x1FFFFFFFFFFF) - firstTimestamp;
-    result.EventType = ((packet >> 45) & 0xF) ? XCL_PERF_MON_END_EVENT :
-        XCL_PERF_MON_START_EVENT;
-    result.TraceID = (packet >> 49) & 0xFFF;
-    result.Reserved = (packet >> 61) & 0x1;
-    result.Overflow = (packet >> 62) & 0x1;
-    result.EventID = XCL_PERF_MON_HW_EVENT;
-    result.EventFlags = ((packet >> 45) & 0xF) | ((packet >> 57) & 0x10);
-    //result.isClockTrain = false;
-    result.isClockTrain = 0 ;
+    TraceDecoder::decode(packet, firstTimestamp, result);
     if (out_stream) {
       static uint64_t previousTimestamp = 0;
       auto packet_dec = std::bitset<64>(packet).to_string();
@@ -207,22 +198,15 @@ uint64_t TraceS2MM::seekClockTraining(uint64_t* arr, uint64_t count)
   if(out_stream)
       (*out_stream) << " TraceS2MM::seekClockTraining " << std::endl;
 
-  uint64_t n = 8;
+  uint64_t n = TraceDecoder::clockTrainingLength;
   if (mTraceFormat < 1  || mclockTrainingdone)
     return 0;
   if (count < n)
     return count;
 
-  count -= n;
-  for (uint64_t i=0; i <= count; i++) {
-    for (uint64_t j=i; j < i + n; j++) {
-      if (!((arr[j] >> 63) & 0x1))
-        break;
-      if (j == i+n-1)
-        return i;
-    }
-  }
-  return count;
+  // Without clock training packets the last n packets are parsed
+  auto idx = TraceDecoder::findClockTraining(arr, count);
+  return (idx == count) ? count - n : idx;
 }
 
 void TraceS2MM::parseTraceBuf(void* buf, uint64_t size, std::vector<xclTraceResults>& traceVector)
@@ -253,11 +237,11 @@ void TraceS2MM::parseTraceBuf(void* buf, uint64_t size, std::vector<xclTraceResu
         break;
       // Poor man's reset
       if (i == 0 && !mPacketFirstTs)
-        mPacketFirstTs = currentPacket & 0x1FFFFFFFFFFF;
+        mPacketFirstTs = currentPacket & TraceDecoder::timestampMask;
 
       bool isClockTrain = false;
       if (mTraceFormat == 1) {
-        isClockTrain = ((currentPacket >> 63) & 0x1);
+        isClockTrain = TraceDecoder::isClockTraining(currentPacket);
       } else {
         isClockTrain = (i < 8 && !mclockTrainingdone);
       }
@@ -21,6 +21,7 @@
 #include <stdexcept>
 #include "profile_ip_access.h"
 #include "xdp/profile/device/device_trace_logger.h"
+#include "xdp/profile/device/trace_decoder.h"
 
 namespace xdp {
 
@@ -0,0 +1,39 @@
+/**
+ * Copyright (C) 2021 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "trace_decoder.h"
+
+namespace xdp {
+
+size_t
+TraceDecoder::findClockTraining(const uint64_t* packets, size_t count)
+{
+  const size_t n = clockTrainingLength;
+  size_t start = 0;
+  while (start + n <= count) {
+    // Walk back from the end of the window, a regular packet at idx
+    // means no run can start at or before it
+    size_t idx = start + n;
+    while (idx > start && isClockTraining(packets[idx - 1]))
+      --idx;
+    if (idx == start)
+      return start;
+    start = idx;
+  }
+  return count;
+}
+
+} // xdp
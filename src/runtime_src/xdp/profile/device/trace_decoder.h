@@ -0,0 +1,89 @@
+/**
+ * Copyright (C) 2021 Xilinx, Inc
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"). You may
+ * not use this file except in compliance with the License. A copy of the
+ * License is located at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS, WITHOUT
+ * WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied. See the
+ * License for the specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef XDP_PROFILE_DEVICE_TRACE_DECODER_H
+#define XDP_PROFILE_DEVICE_TRACE_DECODER_H
+
+#include "core/include/xclperf.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace xdp {
+
+/**
+ * Decoder for 64 bit PL trace packets
+ *
+ * Packet format:
+ *   [44:0]  timestamp
+ *   [48:45] event flags, any set means end event
+ *   [60:49] trace ID
+ *   [61]    pulse (reserved)
+ *   [62]    overflow
+ *   [63]    clock training (trace format 1)
+ *
+ * Packets are decoded one at a time straight into xclTraceResults,
+ * which is what every trace logger consumes.  Decoding into columns
+ * first only pays off for a consumer that reads columns, converting
+ * them back to xclTraceResults measured slower than this.
+ */
+class TraceDecoder {
+public:
+  static constexpr uint64_t timestampMask = 0x1FFFFFFFFFFF;
+  static constexpr unsigned int clockTrainingLength = 8;
+
+  // EventFlags: [3:0] event flags, [4] pulse
+  static constexpr uint8_t eventFlagsMask = 0xF;
+  static constexpr uint8_t pulseFlag = 0x10;
+
+  static bool isClockTraining(uint64_t packet)
+  {
+    return (packet >> 63) & 0x1;
+  }
+
+  /**
+   * findClockTraining() - Index of the first run of clockTrainingLength
+   *   clock training packets, or count if there is none
+   *
+   * Candidate windows are checked from their last packet backwards, so
+   * a window ending with a regular packet is skipped at once and the
+   * search over regular packets takes count/clockTrainingLength steps.
+   */
+  static size_t
+  findClockTraining(const uint64_t* packets, size_t count);
+
+  /**
+   * decode() - Decode one packet into a trace result
+   *
+   * Only the fields of a regular packet are set.
+   */
+  static void
+  decode(uint64_t packet, uint64_t firstTimestamp, xclTraceResults& result)
+  {
+    auto flags = (packet >> 45) & eventFlagsMask;
+    result.Timestamp = (packet & timestampMask) - firstTimestamp;
+    result.EventType = flags ? XCL_PERF_MON_END_EVENT : XCL_PERF_MON_START_EVENT;
+    result.TraceID = (packet >> 49) & 0xFFF;
+    result.Reserved = (packet >> 61) & 0x1;
+    result.Overflow = (packet >> 62) & 0x1;
+    result.EventID = XCL_PERF_MON_HW_EVENT;
+    result.EventFlags = flags | ((packet >> 57) & pulseFlag);
+    result.isClockTrain = 0;
+  }
+};
+
+} // xdp
+
+#endif
@@ -46,7 +46,7 @@ namespace xdp {
     // Update trace
     VTFEvent* event = new HALAPICall(0,
                           timestamp,
-                          (db->getDynamicInfo()).addString(functionName));
+                          (db->getDynamicInfo()).addStaticString(functionName));
     (db->getDynamicInfo()).addEvent(event) ;
     (db->getDynamicInfo()).markStart(decoded->idcode, event->getEventId()) ;
     return;
@@ -65,7 +65,7 @@ namespace xdp {
     // Update trace
     VTFEvent* event = new HALAPICall((db->getDynamicInfo()).matchingStart(decoded->idcode),
 				                  timestamp,
-				                  (db->getDynamicInfo()).addString(functionName));
+				                  (db->getDynamicInfo()).addStaticString(functionName));
     (db->getDynamicInfo()).addEvent(event) ;
     return;
   }
@@ -41,7 +41,7 @@ namespace xdp {
     VTFEvent* event = new OpenCLAPICall(0,
 					timestamp,
 					functionID,
-					(db->getDynamicInfo()).addString(functionName),
+					(db->getDynamicInfo()).addStaticString(functionName),
 					queueAddress
 					) ;
     (db->getDynamicInfo()).addEvent(event) ;
@@ -60,7 +60,7 @@ namespace xdp {
     VTFEvent* event = new OpenCLAPICall(start,
 					timestamp,
 					functionID,
-					(db->getDynamicInfo()).addString(functionName),
+					(db->getDynamicInfo()).addStaticString(functionName),
 					queueAddress) ;
     (db->getDynamicInfo()).addEvent(event) ;
   }
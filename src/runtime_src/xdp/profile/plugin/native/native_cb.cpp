@@ -37,7 +37,7 @@ void native_function_start(const char* functionName, unsigned long long int func
   xdp::VTFEvent* event =
     new xdp::NativeAPICall(0,
                            0,
-                           (db->getDynamicInfo()).addString(functionName)) ;
+                           (db->getDynamicInfo()).addStaticString(functionName)) ;
   (db->getDynamicInfo()).addUnsortedEvent(event);
   (db->getDynamicInfo()).markStart(static_cast<uint64_t>(functionID), event->getEventId()) ;
 
@@ -55,6 +55,6 @@ void native_function_end(const char* functionName, unsigned long long int functi
   xdp::VTFEvent* event =
     new xdp::NativeAPICall(start,
                            static_cast<double>(timestamp),
-                           (db->getDynamicInfo()).addString(functionName)) ;
+                           (db->getDynamicInfo()).addStaticString(functionName)) ;
   (db->getDynamicInfo()).addUnsortedEvent(event) ;
 }
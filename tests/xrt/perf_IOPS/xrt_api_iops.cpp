@@ -2,6 +2,9 @@
 #include <iomanip>
 #include <vector>
 #include <chrono>
+#include <thread>
+#include <atomic>
+#include <memory>
 
 #include "xrt/xrt_device.h"
 #include "xrt/xrt_bo.h"
@@ -9,7 +12,7 @@
 
 void usage()
 {
-  std::cout  << "Usage: test -k <xclbin>\n";
+  std::cout  << "Usage: test -k <xclbin> [-b <batch size> | -t <max threads> | -p <template depth> | -s <syncs in flight> | -a <live buffers> | -e <max handlers>]\n";
 }
 
 double runTest(std::vector<xrt::run>& cmds, unsigned int total)
@@ -68,6 +71,309 @@ int testSingleThread(const xrt::device& device, const xrt::uuid& uuid)
   return 0;
 }
 
+double runBatchTest(std::vector<xrt::run_batch>& batches, unsigned int total)
+{
+  unsigned int issued = 0, completed = 0;
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for (auto& batch : batches) {
+    if (issued >= total)
+      break;
+    batch.start();
+    issued += batch.size();
+  }
+
+  size_t i = 0;
+  while (completed < issued) {
+    batches[i].wait();
+
+    completed += batches[i].size();
+    if (issued < total) {
+      batches[i].start();
+      issued += batches[i].size();
+    }
+
+    if (++i == batches.size())
+      i = 0;
+  }
+
+  auto end = std::chrono::high_resolution_clock::now();
+  return (std::chrono::duration_cast<std::chrono::microseconds>(end - start)).count();
+}
+
+int testBatch(const xrt::device& device, const xrt::uuid& uuid, unsigned int batch_size)
+{
+  std::vector<unsigned int> cmds_per_run = { 1000,5000,10000,50000,100000,500000,1000000 };
+  int expected_cmds = 10000;
+
+  auto hello = xrt::kernel(device, uuid.get(), "hello");
+
+  /* Group 'expected_cmds' commands into batches of 'batch_size' */
+  std::vector<xrt::run_batch> batches;
+  for (int i = 0; i < expected_cmds; i += batch_size) {
+    xrt::run_batch batch;
+    for (unsigned int j = 0; j < batch_size; j++) {
+      auto run = xrt::run(hello);
+      run.set_arg(0, xrt::bo(device, 20, hello.group_id(0)));
+      batch.add(run);
+    }
+    batches.push_back(std::move(batch));
+  }
+  std::cout << "Allocated " << batches.size() << " batches of " << batch_size << " commands" << std::endl;
+
+  for (auto num_cmds : cmds_per_run) {
+    double duration = runBatchTest(batches, num_cmds);
+    std::cout << "Commands: " << std::setw(7) << num_cmds
+              << " iops: " << (num_cmds * 1000.0 * 1000.0 / duration)
+              << std::endl;
+  }
+
+  return 0;
+}
+
+int testTemplate(const xrt::device& device, const xrt::uuid& uuid, unsigned int depth)
+{
+  std::vector<unsigned int> cmds_per_run = { 1000,5000,10000,50000,100000,500000,1000000 };
+
+  auto hello = xrt::kernel(device, uuid.get(), "hello");
+  auto run = xrt::run(hello);
+  run.set_arg(0, xrt::bo(device, 20, hello.group_id(0)));
+  auto tmpl = xrt::run_template(run, depth);
+  std::cout << "Allocated run template of depth " << tmpl.depth() << std::endl;
+
+  for (auto num_cmds : cmds_per_run) {
+    /* Starting the template waits for the oldest run when all are in flight */
+    std::vector<xrt::run> inflight(depth);
+    double start_ns = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (unsigned int i = 0; i < num_cmds; i++) {
+      auto s = std::chrono::high_resolution_clock::now();
+      inflight[i % depth] = tmpl.start();
+      auto e = std::chrono::high_resolution_clock::now();
+      start_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(e - s).count();
+    }
+    for (auto& r : inflight)
+      if (r)
+        r.wait();
+    auto end = std::chrono::high_resolution_clock::now();
+    double duration = (std::chrono::duration_cast<std::chrono::microseconds>(end - start)).count();
+
+    std::cout << "Commands: " << std::setw(7) << num_cmds
+              << " iops: " << (num_cmds * 1000.0 * 1000.0 / duration)
+              << " ns/start: " << (start_ns / num_cmds)
+              << std::endl;
+  }
+
+  return 0;
+}
+
+int testAsyncSync(const xrt::device& device, const xrt::uuid& uuid, unsigned int inflight)
+{
+  const unsigned int num_syncs = 1000;
+  auto hello = xrt::kernel(device, uuid.get(), "hello");
+
+  std::vector<xrt::bo> bos;
+  for (unsigned int i = 0; i < inflight; i++)
+    bos.push_back(xrt::bo(device, 4096, hello.group_id(0)));
+
+  /* Synchronous syncs, one at a time */
+  auto start = std::chrono::high_resolution_clock::now();
+  for (unsigned int i = 0; i < num_syncs; i++)
+    bos[i % inflight].sync(XCL_BO_SYNC_BO_TO_DEVICE);
+  auto end = std::chrono::high_resolution_clock::now();
+  double sync_us = (std::chrono::duration_cast<std::chrono::microseconds>(end - start)).count();
+
+  /* Asynchronous syncs, up to 'inflight' outstanding */
+  std::vector<xrt::bo::async_handle> handles(inflight);
+  start = std::chrono::high_resolution_clock::now();
+  for (unsigned int i = 0; i < num_syncs; i++) {
+    auto& h = handles[i % inflight];
+    if (h)
+      h.wait();
+    h = bos[i % inflight].async(XCL_BO_SYNC_BO_TO_DEVICE);
+  }
+  for (auto& h : handles)
+    if (h)
+      h.wait();
+  end = std::chrono::high_resolution_clock::now();
+  double async_us = (std::chrono::duration_cast<std::chrono::microseconds>(end - start)).count();
+
+  std::cout << "Syncs: " << num_syncs
+            << " sync/s: " << (num_syncs * 1000.0 * 1000.0 / sync_us)
+            << " async/s: " << (num_syncs * 1000.0 * 1000.0 / async_us)
+            << std::endl;
+
+  /* Async sync as dependency of a kernel run in an event queue */
+  xrt::event_queue queue;
+  xrt::event_handler handler(queue);
+  auto sync_event = queue.enqueue([&bos] { return bos[0].async(XCL_BO_SYNC_BO_TO_DEVICE); });
+  auto run_event = queue.enqueue_with_waitlist(hello, {sync_event}, bos[0]);
+  run_event.wait();
+
+  return 0;
+}
+
+int testAllocRate(const xrt::device& device, const xrt::uuid& uuid, unsigned int live)
+{
+  const unsigned int num_allocs = 100000;
+  const size_t sizes[] = {4096, 8192, 16384, 65536};
+  auto hello = xrt::kernel(device, uuid.get(), "hello");
+  auto grp = hello.group_id(0);
+
+  /* Keep up to 'live' buffers alive, replacing the oldest on each allocation */
+  std::vector<xrt::bo> bos(live);
+  auto start = std::chrono::high_resolution_clock::now();
+  for (unsigned int i = 0; i < num_allocs; i++)
+    bos[i % live] = xrt::bo(device, sizes[i % 4], grp);
+  auto end = std::chrono::high_resolution_clock::now();
+  double alloc_us = (std::chrono::duration_cast<std::chrono::microseconds>(end - start)).count();
+
+  for (auto& bo : bos) {
+    if (reinterpret_cast<uintptr_t>(bo.map()) % 4096)
+      throw std::runtime_error("buffer host pointer is not aligned");
+    if (bo.address() % 4096)
+      throw std::runtime_error("buffer device address is not aligned");
+  }
+
+  std::cout << "Allocations: " << num_allocs
+            << " allocs/s: " << (num_allocs * 1000.0 * 1000.0 / alloc_us)
+            << std::endl;
+
+  return 0;
+}
+
+int testEventGraph(const xrt::device& device, const xrt::uuid& uuid, unsigned int max_handlers)
+{
+  const unsigned int iterations = 10000;
+  const unsigned int inflight = 64;
+  auto hello = xrt::kernel(device, uuid.get(), "hello");
+
+  std::vector<xrt::bo> bos;
+  for (unsigned int i = 0; i < inflight; i++)
+    bos.push_back(xrt::bo(device, 20, hello.group_id(0)));
+
+  for (unsigned int num_handlers = 1; num_handlers <= max_handlers; num_handlers *= 2) {
+    xrt::event_queue queue;
+    std::vector<std::unique_ptr<xrt::event_handler>> handlers;
+    for (unsigned int h = 0; h < num_handlers; h++)
+      handlers.emplace_back(new xrt::event_handler(queue));
+
+    /* Each iteration is a sync -> kernel -> sync chain, up to 'inflight' chains outstanding */
+    std::vector<xrt::event> done(inflight);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (unsigned int i = 0; i < iterations; i++) {
+      auto& bo = bos[i % inflight];
+      done[i % inflight].wait();
+      auto to_dev = queue.enqueue([&bo] { bo.sync(XCL_BO_SYNC_BO_TO_DEVICE); });
+      auto run = queue.enqueue_with_waitlist(hello, {to_dev}, bo);
+      done[i % inflight] = queue.enqueue_with_waitlist([&bo] { bo.sync(XCL_BO_SYNC_BO_FROM_DEVICE); }, {run});
+    }
+    for (auto& ev : done)
+      ev.wait();
+    auto end = std::chrono::high_resolution_clock::now();
+    double duration = (std::chrono::duration_cast<std::chrono::microseconds>(end - start)).count();
+
+    std::cout << "Handlers: " << num_handlers
+              << " iterations/s: " << (iterations * 1000.0 * 1000.0 / duration)
+              << std::endl;
+  }
+
+  return 0;
+}
+
+struct thread_result
+{
+  double submit_us = 0;   // time spent in run::start
+  unsigned int cmds = 0;  // commands completed
+  std::atomic<unsigned int> callbacks{0};  // completion callbacks, managed mode
+};
+
+void countCallback(const void*, ert_cmd_state, void* data)
+{
+  ++static_cast<thread_result*>(data)->callbacks;
+}
+
+void runThread(const xrt::device& device, const xrt::kernel& hello, unsigned int total, bool managed, thread_result* result)
+{
+  /* Each thread owns its commands, runs with a callback are managed by the command monitor */
+  std::vector<xrt::run> cmds;
+  for (int i = 0; i < 128; i++) {
+    auto run = xrt::run(hello);
+    run.set_arg(0, xrt::bo(device, 20, hello.group_id(0)));
+    if (managed)
+      run.add_callback(ERT_CMD_STATE_COMPLETED, countCallback, result);
+    cmds.push_back(std::move(run));
+  }
+
+  unsigned int issued = 0, completed = 0;
+  size_t i = 0;
+  auto submit = [&](xrt::run& cmd) {
+    auto start = std::chrono::high_resolution_clock::now();
+    cmd.start();
+    auto end = std::chrono::high_resolution_clock::now();
+    result->submit_us += std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / 1000.0;
+    ++issued;
+  };
+
+  for (auto& cmd : cmds) {
+    if (issued == total)
+      break;
+    submit(cmd);
+  }
+
+  while (completed < total) {
+    cmds[i].wait();
+    completed++;
+    if (issued < total)
+      submit(cmds[i]);
+    if (++i == cmds.size() || i == issued)
+      i = 0;
+  }
+  result->cmds = completed;
+}
+
+int testMultiThread(const xrt::device& device, const xrt::uuid& uuid, unsigned int max_threads)
+{
+  const unsigned int cmds_per_thread = 100000;
+  auto hello = xrt::kernel(device, uuid.get(), "hello");
+
+  /* Unmanaged runs are waited on directly, managed runs go through the command monitor */
+  for (bool managed : {false, true}) {
+    std::cout << (managed ? "Managed" : "Unmanaged") << " runs" << std::endl;
+    for (unsigned int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+      std::vector<std::thread> threads;
+      std::vector<thread_result> results(num_threads);
+
+      auto start = std::chrono::high_resolution_clock::now();
+      for (unsigned int t = 0; t < num_threads; t++)
+        threads.emplace_back(runThread, std::cref(device), std::cref(hello), cmds_per_thread, managed, &results[t]);
+      for (auto& t : threads)
+        t.join();
+      auto end = std::chrono::high_resolution_clock::now();
+      double duration = (std::chrono::duration_cast<std::chrono::microseconds>(end - start)).count();
+
+      double submit_us = 0;
+      unsigned int total = 0;
+      unsigned int callbacks = 0;
+      for (auto& r : results) {
+        submit_us += r.submit_us;
+        total += r.cmds;
+        callbacks += r.callbacks;
+      }
+      if (managed && callbacks != total)
+        throw std::runtime_error("missing completion callbacks");
+
+      std::cout << "Threads: " << std::setw(3) << num_threads
+                << " commands: " << std::setw(8) << total
+                << " submit/s: " << (total * 1000.0 * 1000.0 / (submit_us / num_threads))
+                << " complete/s: " << (total * 1000.0 * 1000.0 / duration)
+                << std::endl;
+    }
+  }
+
+  return 0;
+}
+
 int _main(int argc, char* argv[])
 {
   if (argc < 3 || argv[1] != std::string("-k")) {
@@ -76,11 +382,42 @@ int _main(int argc, char* argv[])
   }
 
   std::string xclbin_fn = argv[2];
+  unsigned int batch_size = 0;
+  unsigned int max_threads = 0;
+  unsigned int depth = 0;
+  unsigned int inflight = 0;
+  unsigned int live = 0;
+  unsigned int max_handlers = 0;
+  if (argc == 5 && argv[3] == std::string("-b"))
+    batch_size = std::stoi(argv[4]);
+  if (argc == 5 && argv[3] == std::string("-t"))
+    max_threads = std::stoi(argv[4]);
+  if (argc == 5 && argv[3] == std::string("-p"))
+    depth = std::stoi(argv[4]);
+  if (argc == 5 && argv[3] == std::string("-s"))
+    inflight = std::stoi(argv[4]);
+  if (argc == 5 && argv[3] == std::string("-a"))
+    live = std::stoi(argv[4]);
+  if (argc == 5 && argv[3] == std::string("-e"))
+    max_handlers = std::stoi(argv[4]);
 
   auto device = xrt::device(0);
   auto uuid = device.load_xclbin(xclbin_fn);
 
-  testSingleThread(device, uuid);
+  if (batch_size)
+    testBatch(device, uuid, batch_size);
+  else if (max_threads)
+    testMultiThread(device, uuid, max_threads);
+  else if (depth)
+    testTemplate(device, uuid, depth);
+  else if (inflight)
+    testAsyncSync(device, uuid, inflight);
+  else if (live)
+    testAllocRate(device, uuid, live);
+  else if (max_handlers)
+    testEventGraph(device, uuid, max_handlers);
+  else
+    testSingleThread(device, uuid);
 
   return 0;
 }